@@ -0,0 +1,116 @@
+#include <setjmp.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "crash_recovery.h"
+#include "event_bus.h"
+
+#define BENCH_PLUGIN 1
+#define BENCH_DEFAULT_EVENTS 1000000
+#define BENCH_BATCH 32
+
+static atomic_size_t g_delivered = 0;
+
+static void bench_callback(const void *data, size_t len, void *user)
+{
+    (void)data;
+    (void)len;
+    (void)user;
+    atomic_fetch_add_explicit(&g_delivered, 1, memory_order_relaxed);
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void wait_delivered(size_t expected)
+{
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = 100000L };
+    while (atomic_load(&g_delivered) < expected) nanosleep(&ts, NULL);
+}
+
+static void report(const char *name, size_t events, double elapsed)
+{
+    printf("%-18s %10zu events %8.3f s %12.0f ev/s %8.1f ns/ev\n",
+        name, events, elapsed, (double)events / elapsed, elapsed * 1e9 / (double)events);
+}
+
+static void bench_single(const char *name, event_id_t topic, size_t events)
+{
+    atomic_store(&g_delivered, 0);
+    uint64_t value = 0;
+
+    double start = now_sec();
+    for (size_t i = 0; i < events; i++) {
+        value = i;
+        bus_publish_id(BENCH_PLUGIN, topic, &value, sizeof(value));
+    }
+    wait_delivered(events);
+    report(name, events, now_sec() - start);
+}
+
+static void bench_batch(event_id_t topic, size_t events)
+{
+    atomic_store(&g_delivered, 0);
+    uint64_t values[BENCH_BATCH];
+    bus_msg_t msgs[BENCH_BATCH];
+
+    for (size_t i = 0; i < BENCH_BATCH; i++) {
+        msgs[i] = (bus_msg_t){ .event = NULL, .topic = topic, .data = &values[i], .len = sizeof(values[i]) };
+    }
+
+    double start = now_sec();
+    for (size_t i = 0; i < events; i += BENCH_BATCH) {
+        size_t n = events - i < BENCH_BATCH ? events - i : BENCH_BATCH;
+        for (size_t j = 0; j < n; j++) values[j] = i + j;
+        bus_publish_batch(BENCH_PLUGIN, msgs, n);
+    }
+    wait_delivered(events);
+    report("publish_batch(32)", events, now_sec() - start);
+}
+
+static sigjmp_buf g_bench_env;
+
+// What arming the crash guard costs per callback, with the old mask save and without
+static void bench_guard(size_t events)
+{
+    volatile size_t armed = 0;
+
+    double start = now_sec();
+    for (size_t i = 0; i < events; i++) {
+        if (sigsetjmp(g_bench_env, 1) == 0) armed++;
+    }
+    report("sigsetjmp(mask)", events, now_sec() - start);
+
+    start = now_sec();
+    for (size_t i = 0; i < events; i++) {
+        if (CRASH_GUARD_SETJMP(g_bench_env) == 0) armed++;
+    }
+    report("crash guard", events, now_sec() - start);
+}
+
+int main(int argc, char **argv)
+{
+    size_t events = argc > 1 ? strtoull(argv[1], NULL, 10) : BENCH_DEFAULT_EVENTS;
+
+    if (bus_init() != 0) return 1;
+    if (bus_subscribe(BENCH_PLUGIN, "BENCH_EVENT", bench_callback, NULL) != 0) return 1;
+
+    bus_sub_opts_t direct = { .direct = 1 };
+    if (bus_subscribe_ex(BENCH_PLUGIN, "BENCH_DIRECT", bench_callback, NULL, &direct) != 0) return 1;
+
+    event_id_t topic = bus_topic_id("BENCH_EVENT");
+
+    bench_single("publish_id", topic, events);
+    bench_batch(topic, events);
+    bench_single("publish_id direct", bus_topic_id("BENCH_DIRECT"), events);
+    bench_guard(events);
+
+    bus_shutdown();
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "scheduler_queue.h"
+
+#define BENCH_START_NS  1000000000ULL
+#define BENCH_SPREAD_NS 10000000000ULL  // deadlines within 10 s
+#define BENCH_ROUNDS    5
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t bench_rand(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static void report(const char *backend, const char *op, size_t timers, double elapsed)
+{
+    const double ops = (double)timers * BENCH_ROUNDS;
+    printf("%-6s %-7s %8zu timers %8.3f s %8.1f ns/op\n", backend, op, timers, elapsed, elapsed * 1e9 / ops);
+}
+
+static void fill(sched_queue_t *q, scheduler_timer_t *timers, size_t count)
+{
+    for (size_t i = 0; i < count; i++) sched_queue_insert(q, &timers[i]);
+}
+
+static void bench_backend(scheduler_backend_t backend, const char *name, size_t count)
+{
+    scheduler_timer_t *timers = calloc(count, sizeof(scheduler_timer_t));
+    if (!timers) return;
+
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < count; i++) {
+        timers[i].id = (int)i;
+        timers[i].due_ns = BENCH_START_NS + bench_rand(&state) % BENCH_SPREAD_NS;
+    }
+
+    double insert = 0;
+    double cancel = 0;
+    double expire = 0;
+
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        sched_queue_t q;
+        if (sched_queue_init(&q, backend, BENCH_START_NS) != 0) break;
+
+        double start = now_sec();
+        fill(&q, timers, count);
+        insert += now_sec() - start;
+
+        start = now_sec();
+        for (size_t i = 0; i < count; i++) sched_queue_remove(&q, &timers[i]);
+        cancel += now_sec() - start;
+
+        // Expiry the way the scheduler thread drives it: sleep to the next deadline, drain what is due
+        fill(&q, timers, count);
+        start = now_sec();
+        while (q.count) {
+            const uint64_t now = sched_queue_next_due(&q);
+            while (sched_queue_pop(&q, now)) {}
+        }
+        expire += now_sec() - start;
+
+        sched_queue_destroy(&q);
+    }
+
+    report(name, "insert", count, insert);
+    report(name, "cancel", count, cancel);
+    report(name, "expire", count, expire);
+    free(timers);
+}
+
+int main(int argc, char **argv)
+{
+    size_t max = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000;
+
+    for (size_t count = 1000; count <= max; count *= 10) {
+        bench_backend(SCHEDULER_BACKEND_WHEEL, "wheel", count);
+        bench_backend(SCHEDULER_BACKEND_HEAP, "heap", count);
+    }
+    return 0;
+}
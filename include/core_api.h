@@ -1,6 +1,7 @@
 #ifndef CORE_API_H
 #define CORE_API_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <core_utils.h>
 #include <pthread.h>
@@ -43,8 +44,36 @@ typedef struct core_api_s
     int (*timer_every_ms)(uint64_t ms, core_timer_cb cb, void *user);
     int (*timer_cancel)(int timer_id);
 
+    // Appended after the baseline slots, plugins built against them keep their offsets
+    event_id_t (*topic_id)(const char *event);
+    int (*publish_id)(plugin_id_t plugin_id, event_id_t topic, const void *data, size_t len);
+
+    // Zero-copy publish: write into loan(size), then hand it over with publish_loaned
+    void *(*loan)(size_t size);
+    int (*publish_loaned)(plugin_id_t plugin_id, const char *event, void *buf, size_t len);
+    void (*loan_discard)(void *buf);
+
+    int (*publish_batch)(plugin_id_t plugin_id, const bus_msg_t *msgs, size_t n);
+    int (*subscribe_ex)(const char *event, core_event_cb cb, void *user, const bus_sub_opts_t *opts);
+    int (*publish_ex)(const char *event, const void *data, size_t len, const bus_pub_opts_t *opts);
+    int (*topic_backpressure)(const char *event, bus_backpressure_t policy, uint32_t block_timeout_ms);
+    int (*topic_conflate)(const char *event, int conflated);
+    int (*topic_journal)(const char *event, int journaled);
+    int64_t (*replay)(const char *event, uint64_t from_seq, bus_replay_cb_t cb, void *user);
+    int (*unsubscribe)(const char *event, core_event_cb cb, void *user);
+
+    // Sub-millisecond variants on the monotonic clock
+    int (*timer_after_us)(uint64_t us, core_timer_cb cb, void *user);
+    int (*timer_every_ns)(uint64_t ns, core_timer_cb cb, void *user);
+    int (*timer_ex)(uint64_t delay_ns, uint64_t interval_ns, core_timer_cb cb, void *user,
+                    const sched_timer_opts_t *opts);
+
 } core_api_t;
 
+// The baseline slots must keep their offsets, new entries only ever go at the end
+_Static_assert(offsetof(core_api_t, timer_cancel) == 8 * sizeof(void *),
+               "core_api_t baseline slots moved");
+
 // Log Internal
 typedef void (*plugin_log_internal_func_t)(size_t level, const char *plugin_name, const char *fmt, ...);
 
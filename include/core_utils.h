@@ -1,10 +1,12 @@
 #ifndef CORECDTL_UTILS_H
 #define CORECDTL_UTILS_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
 #define PLUGIN_ID_INVALID 0
+#define EVENT_ID_INVALID 0
 
 typedef uint32_t plugin_id_t; // 32 bit for register store
 typedef uint16_t event_id_t;
@@ -22,17 +24,114 @@ typedef struct plugin_param_s {
     const char *value;
 } plugin_param_t;
 
+typedef enum {
+    BUS_PRIORITY_INHERIT = 0,   /**< Publish: keep each subscription's class, subscribe: normal */
+    BUS_PRIORITY_REALTIME,
+    BUS_PRIORITY_NORMAL,
+    BUS_PRIORITY_BULK
+} bus_priority_t;
+
+typedef enum {
+    BUS_FILTER_EQ = 0,
+    BUS_FILTER_NE,
+    BUS_FILTER_LT,              /**< Orderings compare unsigned */
+    BUS_FILTER_LE,
+    BUS_FILTER_GT,
+    BUS_FILTER_GE
+} bus_filter_cmp_t;
+
+// Passes when (field & mask) <cmp> value, the field is width bytes at offset in host byte order
+typedef struct bus_filter_clause_s {
+    uint32_t offset;
+    uint8_t width;              /**< 1, 2, 4 or 8 */
+    uint8_t cmp;                /**< bus_filter_cmp_t */
+    uint64_t mask;              /**< 0 = every bit of the field */
+    uint64_t value;
+} bus_filter_clause_t;
+
+typedef struct bus_sub_opts_s {
+    bus_priority_t priority;
+    int ordered;                /**< Serialize deliveries per publish key, in publish order */
+    int direct;                 /**< Run the callback on the publisher's thread, for tiny non-blocking callbacks */
+    int last_value;             /**< Conflated topics: get the cached value of every key right after subscribing */
+    const bus_filter_clause_t *filter;  /**< All clauses must pass, checked before anything is queued */
+    size_t filter_len;          /**< Payloads shorter than a clause needs are rejected */
+} bus_sub_opts_t;
+
+// What a publish does when a subscriber's lane is full
+typedef enum {
+    BUS_BACKPRESSURE_INHERIT = 0,   /**< Publish: the topic's policy, topic: block */
+    BUS_BACKPRESSURE_BLOCK,         /**< Wait for room, at most block_timeout_ms when set */
+    BUS_BACKPRESSURE_FAIL,          /**< Return BUS_PUBLISH_ERR_QUEUE_FULL right away */
+    BUS_BACKPRESSURE_DROP_OLDEST,   /**< Evict the oldest queued delivery of the lane, never waits */
+    BUS_BACKPRESSURE_DROP_NEWEST,   /**< Skip this delivery, the publish still succeeds */
+    BUS_BACKPRESSURE_COALESCE       /**< One pending delivery per subscriber and key, latest wins */
+} bus_backpressure_t;
+
+// What a publish over its plugin's (or topic's) rate quota does
+typedef enum {
+    BUS_QUOTA_REJECT = 0,       /**< Return BUS_PUBLISH_ERR_RATE_LIMITED */
+    BUS_QUOTA_DROP,             /**< Discard it, the publish still succeeds */
+    BUS_QUOTA_DELAY             /**< Sleep the publisher until a token frees up, at most max_delay_ms */
+} bus_quota_action_t;
+
+// Token bucket: rate tokens per second refill up to burst, one publish takes one
+typedef struct bus_quota_s {
+    uint32_t rate;              /**< 0 = unlimited */
+    uint32_t burst;             /**< 0 = rate, i.e. one second worth */
+    bus_quota_action_t action;
+    uint32_t max_delay_ms;      /**< BUS_QUOTA_DELAY: longer waits are rejected, 0 = BUS_QUOTA_DEFAULT_DELAY_MS */
+} bus_quota_t;
+
+typedef struct bus_pub_opts_s {
+    bus_priority_t priority;    /**< Overrides the subscriptions' class for this publish */
+    bus_backpressure_t backpressure;
+    uint32_t block_timeout_ms;
+    uint64_t key;               /**< Coalescing / ordering key */
+} bus_pub_opts_t;
+
+// Journal replay, return non-zero to stop early. data points into the journal mapping
+typedef int (*bus_replay_cb_t)(uint64_t seq, const void *data, size_t len, void *user);
+
+// One entry of a batch publish, topic wins over event when both are set
+typedef struct bus_msg_s {
+    const char *event;
+    event_id_t topic;
+    const void *data;
+    size_t len;
+} bus_msg_t;
+
+// What a periodic timer does about the periods that passed while it was late
+typedef enum {
+    SCHED_OVERRUN_SKIP = 0,     /**< Drop them, resume at the next period still ahead */
+    SCHED_OVERRUN_FIRE_ALL,     /**< Run once per missed period, back to back until caught up */
+    SCHED_OVERRUN_COALESCE      /**< Run once now, data points to a uint64_t count of the periods folded in */
+} sched_overrun_t;
+
+// Per timer options of timer_ex
+typedef struct sched_timer_opts_s {
+    int run_inline;             /**< Run on the scheduler thread instead of the callback pool, for short latency-critical work */
+    sched_overrun_t overrun;
+} sched_timer_opts_t;
+
 
 #define BUS_PUBLISH_ERR_INVALID_PLUGIN_ID    1
 #define BUS_PUBLISH_ERR_INVALID_DATA         2
 #define BUS_PUBLISH_ERR_INVALID_LENGTH       3
 #define BUS_PUBLISH_ERR_EVENT_NOT_FOUND      4
 #define BUS_PUBLISH_ERR_MALLOC_FAILED        5
+#define BUS_PUBLISH_ERR_INVALID_LOAN         6
+#define BUS_PUBLISH_ERR_QUEUE_FULL           7
+#define BUS_PUBLISH_ERR_RATE_LIMITED         8
 
 #define BUS_SUB_ERR_INVALID_PLUGIN   1
 #define BUS_SUB_ERR_INVALID_EVENT    2
 #define BUS_SUB_ERR_INVALID_CB       3
 #define BUS_SUB_ERR_ALLOC_FAILED     4
 #define BUS_SUB_ERR_STRDUP_FAILED    5
+#define BUS_SUB_ERR_NOT_FOUND        6
+#define BUS_SUB_ERR_INVALID_FILTER   7
+#define BUS_SUB_ERR_NOT_OWNER        8
+#define BUS_SUB_ERR_DUPLICATE        9
 
 #endif //CORECDTL_UTILS_H
\ No newline at end of file
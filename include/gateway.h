@@ -35,6 +35,7 @@ typedef int (*gateway_pm_get_list_fn)(char *out_buf, size_t buf_len);
 typedef int (*gateway_pm_action_reboot_fn)(uint32_t plugin_id, uint8_t action);
 
 typedef int (*gateway_eb_get_list_fn)(char *out_buf, size_t buf_len);
+typedef int (*gateway_eb_get_stats_fn)(char *out_buf, size_t buf_len);
 typedef int (*gateway_sc_get_list_fn)(char *out_buf, size_t buf_len);
 
 int gateway_hk_get_type(uint32_t plugin_id, const char *type_name, char *out_buf, size_t buf_len);
@@ -46,6 +47,7 @@ int gateway_pm_get_list( char *out_buf, size_t buf_len);
 int gateway_pm_action_reboot(uint32_t plugin_id, uint8_t action);
 
 int gateway_eb_get_list(char *out_buf, size_t buf_len);
+int gateway_eb_get_stats(char *out_buf, size_t buf_len);
 
 int gateway_sc_get_list(char *out_buf, size_t buf_len);
 
@@ -60,6 +62,9 @@ typedef struct {
 
     gateway_eb_get_list_fn eb_get_list;
     gateway_sc_get_list_fn sc_get_list;
+
+    // Appended so gateways built against the older table keep working
+    gateway_eb_get_stats_fn eb_get_stats;
 } gateway_entry_t;
 
 typedef void (*gateway_init_fn)(gateway_entry_t *gateway_entry);
@@ -9,14 +9,33 @@ extern "C" {
 #endif
 
     // Event Bus
+    struct bus_sub_opts_s;
+    struct bus_pub_opts_s;
+
     typedef void (*bus_cb_t)(const void* data, size_t len, void* user);
     typedef int (*bus_subscribe_t)(uint32_t plugin_id, const char* event, bus_cb_t cb, void* user);
+    typedef int (*bus_subscribe_ex_t)(uint32_t plugin_id, const char* event, bus_cb_t cb, void* user,
+                                      const struct bus_sub_opts_s* opts);
+    typedef int (*bus_publish_ex_t)(uint32_t plugin_id, const char* event, const void* data, size_t len,
+                                    const struct bus_pub_opts_s* opts);
+    // policy is a bus_backpressure_t
+    typedef int (*bus_topic_backpressure_t)(uint32_t plugin_id, const char* event, uint32_t policy,
+                                            uint32_t block_timeout_ms);
+    // Same shape for conflate and journal
+    typedef int (*bus_topic_flag_t)(uint32_t plugin_id, const char* event, int enabled);
+    // Same layout as bus_replay_cb_t
+    typedef int (*jit_replay_cb_t)(uint64_t seq, const void* data, size_t len, void* user);
+    typedef int64_t (*bus_replay_t)(uint32_t plugin_id, const char* event, uint64_t from_seq, jit_replay_cb_t cb,
+                                    void* user);
 
     // Scheduler
     typedef void (*sched_cb_t)(const void* data, size_t len, void* user);
     typedef int (*scheduler_after_ms_t)(uint32_t plugin_id, uint64_t ms, sched_cb_t cb, void* user);
     typedef int (*scheduler_every_ms_t)(uint32_t plugin_id, uint64_t ms, sched_cb_t cb, void* user);
     typedef int (*scheduler_cancel_t)(uint32_t plugin_id, int id);
+    struct sched_timer_opts_s;
+    typedef int (*scheduler_timer_ex_t)(uint32_t plugin_id, uint64_t delay_ns, uint64_t interval_ns, sched_cb_t cb,
+                                        void* user, const struct sched_timer_opts_s* opts);
 
     // Heapkit
     typedef int (*hk_get_field_t)(uint32_t plugin_id, const char* type_name, const char* field_name, void* out_value);
@@ -26,9 +45,15 @@ extern "C" {
     typedef struct JITStub JITStub;
 
     JITStub* create_api_subscribe_stub(uint32_t plugin_id, bus_subscribe_t real_fn);
+    JITStub* create_api_subscribe_ex_stub(uint32_t plugin_id, bus_subscribe_ex_t real_fn);
+    JITStub* create_api_publish_ex_stub(uint32_t plugin_id, bus_publish_ex_t real_fn);
+    JITStub* create_api_topic_backpressure_stub(uint32_t plugin_id, bus_topic_backpressure_t real_fn);
+    JITStub* create_api_topic_flag_stub(uint32_t plugin_id, bus_topic_flag_t real_fn);
+    JITStub* create_api_replay_stub(uint32_t plugin_id, bus_replay_t real_fn);
     JITStub* create_api_scheduler_after_stub(uint32_t plugin_id, scheduler_after_ms_t real_fn);
     JITStub* create_api_scheduler_every_ms_stub(uint32_t plugin_id, scheduler_every_ms_t real_fn);
     JITStub* create_api_scheduler_cancel_stub(uint32_t plugin_id, scheduler_cancel_t real_fn);
+    JITStub* create_api_scheduler_timer_ex_stub(uint32_t plugin_id, scheduler_timer_ex_t real_fn);
 
     // HK Api
     JITStub* create_api_hk_getter_stub(uint32_t plugin_id, hk_get_field_t real_fn);
@@ -78,8 +78,8 @@ typedef struct __attribute__((aligned(64))) {
     char __padding[16];
 } plugin_handle_t;
 
-_Static_assert(sizeof(plugin_handle_t) == 256,
-               "Plugin handle should be 256 bytes, got " TOSTRING(sizeof(plugin_handle_t)));
+_Static_assert(sizeof(plugin_handle_t) == 384,
+               "Plugin handle should be 384 bytes, got " TOSTRING(sizeof(plugin_handle_t)));
 _Static_assert(alignof(plugin_handle_t) == 64,
                "Plugin handle alignment wrong: " TOSTRING(alignof(plugin_handle_t)));
 
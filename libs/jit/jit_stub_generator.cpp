@@ -8,6 +8,10 @@
 #include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/Support/TargetSelect.h>
 
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
 using namespace llvm;
 using namespace llvm::orc;
 
@@ -25,6 +29,75 @@ extern "C" void destroy_stub_function(JITStub* stub) {
     delete stub;
 }
 
+namespace {
+
+    // Argument and return kinds of the core_api entries, size_t and uint64_t are both i64
+    enum class StubArg { I32, I64, Ptr };
+
+    Type* stub_arg_type(IRBuilder<>& builder, StubArg kind) {
+        switch (kind) {
+            case StubArg::I32: return builder.getInt32Ty();
+            case StubArg::I64: return builder.getInt64Ty();
+            default: return builder.getPtrTy();
+        }
+    }
+
+    // Stub with the given arguments which calls real_fn(plugin_id, args...)
+    JITStub* create_bound_stub(const char* name, uint32_t plugin_id, uint64_t real_fn,
+                               StubArg ret, std::initializer_list<StubArg> args) {
+        InitializeNativeTarget();
+        InitializeNativeTargetAsmPrinter();
+
+        auto ctx = std::make_unique<LLVMContext>();
+        auto mod = std::make_unique<Module>("stub_mod", *ctx);
+        IRBuilder<> builder(*ctx);
+
+        auto retTy = stub_arg_type(builder, ret);
+        std::vector<Type*> stubArgTys;
+        for (auto kind : args) stubArgTys.push_back(stub_arg_type(builder, kind));
+
+        // The real function takes the plugin id first
+        std::vector<Type*> realArgTys{builder.getInt32Ty()};
+        realArgTys.insert(realArgTys.end(), stubArgTys.begin(), stubArgTys.end());
+
+        auto stubFnType = FunctionType::get(retTy, stubArgTys, false);
+        auto realType = FunctionType::get(retTy, realArgTys, false);
+
+        Function* stubFn = Function::Create(
+            stubFnType, Function::ExternalLinkage, name, mod.get());
+
+        auto entry = BasicBlock::Create(*ctx, "entry", stubFn);
+        builder.SetInsertPoint(entry);
+
+        std::vector<Value*> callArgs{builder.getInt32(plugin_id)};
+        for (auto& arg : stubFn->args()) callArgs.push_back(&arg);
+
+        auto fnPtrVal = ConstantInt::get(Type::getInt64Ty(*ctx), real_fn);
+        auto fnPtr = builder.CreateIntToPtr(fnPtrVal, realType->getPointerTo());
+
+        builder.CreateRet(builder.CreateCall(realType, fnPtr, callArgs));
+
+        auto jitOrErr = LLJITBuilder().create();
+        if (!jitOrErr) return nullptr;
+
+        auto jit = std::move(*jitOrErr);
+        if (auto err = jit->addIRModule(ThreadSafeModule(std::move(mod), std::move(ctx)))) {
+            return nullptr;
+        }
+
+        auto sym = jit->lookup(name);
+        if (!sym) return nullptr;
+
+        auto addr = *sym;
+
+        auto* stub = new JITStub();
+        stub->jit = std::move(jit);
+        stub->fn_ptr = reinterpret_cast<void*>(addr.getValue());
+
+        return stub;
+    }
+}
+
 extern "C" {
 
     JITStub* create_api_subscribe_stub(uint32_t plugin_id, bus_subscribe_t real_fn) {
@@ -448,4 +521,131 @@ extern "C" {
 
         return stub;
     }
-}
\ No newline at end of file
+}
+extern "C" {
+    JITStub* create_bus_filter_stub(const jit_filter_clause_t* clauses, size_t count) {
+        if (!clauses || count == 0) return nullptr;
+
+        InitializeNativeTarget();
+        InitializeNativeTargetAsmPrinter();
+
+        auto ctx = std::make_unique<LLVMContext>();
+        auto mod = std::make_unique<Module>("filter_mod", *ctx);
+        IRBuilder<> builder(*ctx);
+
+        auto voidPtrTy = builder.getPtrTy();
+        auto i32Ty = builder.getInt32Ty();
+        auto i64Ty = builder.getInt64Ty();
+
+        // int (*)(const void* data, size_t len), 1 = deliver
+        auto filterFnType = FunctionType::get(i32Ty, {voidPtrTy, i64Ty}, false);
+
+        Function* filterFn = Function::Create(
+            filterFnType, Function::ExternalLinkage, "bus_filter_stub", mod.get());
+
+        auto argIter = filterFn->arg_begin();
+        Value* data = &*argIter++;
+        Value* len = &*argIter++;
+
+        auto entry = BasicBlock::Create(*ctx, "entry", filterFn);
+        auto reject = BasicBlock::Create(*ctx, "reject", filterFn);
+        auto clause = BasicBlock::Create(*ctx, "clause", filterFn);
+
+        builder.SetInsertPoint(reject);
+        builder.CreateRet(builder.getInt32(0));
+
+        // A payload too short for any clause fails the whole predicate, one bounds check covers all loads
+        uint64_t end = 0;
+        for (size_t i = 0; i < count; i++) {
+            end = std::max<uint64_t>(end, (uint64_t)clauses[i].offset + clauses[i].width);
+        }
+
+        builder.SetInsertPoint(entry);
+        builder.CreateCondBr(builder.CreateICmpULT(len, builder.getInt64(end)), reject, clause);
+        builder.SetInsertPoint(clause);
+
+        for (size_t i = 0; i < count; i++) {
+            const jit_filter_clause_t* c = &clauses[i];
+
+            auto fieldTy = builder.getIntNTy(c->width * 8);
+            Value* fieldPtr = builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(), data, c->offset);
+            Value* field = builder.CreateZExt(builder.CreateAlignedLoad(fieldTy, fieldPtr, MaybeAlign(1)), i64Ty);
+            Value* masked = builder.CreateAnd(field, builder.getInt64(c->mask));
+            Value* rhs = builder.getInt64(c->value);
+
+            Value* pass;
+            switch (c->cmp) {
+                case JIT_FILTER_NE: pass = builder.CreateICmpNE(masked, rhs); break;
+                case JIT_FILTER_LT: pass = builder.CreateICmpULT(masked, rhs); break;
+                case JIT_FILTER_LE: pass = builder.CreateICmpULE(masked, rhs); break;
+                case JIT_FILTER_GT: pass = builder.CreateICmpUGT(masked, rhs); break;
+                case JIT_FILTER_GE: pass = builder.CreateICmpUGE(masked, rhs); break;
+                default: pass = builder.CreateICmpEQ(masked, rhs); break;
+            }
+
+            // Clauses are and-ed, the first failing one rejects
+            auto next = BasicBlock::Create(*ctx, "clause", filterFn);
+            builder.CreateCondBr(pass, next, reject);
+            builder.SetInsertPoint(next);
+        }
+
+        builder.CreateRet(builder.getInt32(1));
+
+        auto jitOrErr = LLJITBuilder().create();
+        if (!jitOrErr) return nullptr;
+
+        auto jit = std::move(*jitOrErr);
+        if (auto err = jit->addIRModule(ThreadSafeModule(std::move(mod), std::move(ctx)))) {
+            return nullptr;
+        }
+
+        auto sym = jit->lookup("bus_filter_stub");
+        if (!sym) return nullptr;
+
+        auto addr = *sym;
+
+        auto* stub = new JITStub();
+        stub->jit = std::move(jit);
+        stub->fn_ptr = reinterpret_cast<void*>(addr.getValue());
+
+        return stub;
+    }
+}
+
+extern "C" {
+    JITStub* create_api_subscribe_ex_stub(uint32_t plugin_id, bus_subscribe_ex_t real_fn) {
+        // (const char* event, bus_cb_t cb, void* user, const bus_sub_opts_t* opts) -> int
+        return create_bound_stub("api_subscribe_ex_stub", plugin_id, reinterpret_cast<uint64_t>(real_fn),
+                                 StubArg::I32, {StubArg::Ptr, StubArg::Ptr, StubArg::Ptr, StubArg::Ptr});
+    }
+
+    JITStub* create_api_publish_ex_stub(uint32_t plugin_id, bus_publish_ex_t real_fn) {
+        // (const char* event, const void* data, size_t len, const bus_pub_opts_t* opts) -> int
+        return create_bound_stub("api_publish_ex_stub", plugin_id, reinterpret_cast<uint64_t>(real_fn),
+                                 StubArg::I32, {StubArg::Ptr, StubArg::Ptr, StubArg::I64, StubArg::Ptr});
+    }
+
+    JITStub* create_api_topic_backpressure_stub(uint32_t plugin_id, bus_topic_backpressure_t real_fn) {
+        // (const char* event, bus_backpressure_t policy, uint32_t block_timeout_ms) -> int
+        return create_bound_stub("api_topic_backpressure_stub", plugin_id, reinterpret_cast<uint64_t>(real_fn),
+                                 StubArg::I32, {StubArg::Ptr, StubArg::I32, StubArg::I32});
+    }
+
+    JITStub* create_api_topic_flag_stub(uint32_t plugin_id, bus_topic_flag_t real_fn) {
+        // (const char* event, int enabled) -> int
+        return create_bound_stub("api_topic_flag_stub", plugin_id, reinterpret_cast<uint64_t>(real_fn),
+                                 StubArg::I32, {StubArg::Ptr, StubArg::I32});
+    }
+
+    JITStub* create_api_replay_stub(uint32_t plugin_id, bus_replay_t real_fn) {
+        // (const char* event, uint64_t from_seq, bus_replay_cb_t cb, void* user) -> int64_t
+        return create_bound_stub("api_replay_stub", plugin_id, reinterpret_cast<uint64_t>(real_fn),
+                                 StubArg::I64, {StubArg::Ptr, StubArg::I64, StubArg::Ptr, StubArg::Ptr});
+    }
+
+    JITStub* create_api_scheduler_timer_ex_stub(uint32_t plugin_id, scheduler_timer_ex_t real_fn) {
+        // (uint64_t delay_ns, uint64_t interval_ns, sched_cb_t cb, void* user, const sched_timer_opts_t* opts) -> int
+        return create_bound_stub("api_scheduler_timer_ex_stub", plugin_id, reinterpret_cast<uint64_t>(real_fn),
+                                 StubArg::I32, {StubArg::I64, StubArg::I64, StubArg::Ptr, StubArg::Ptr, StubArg::Ptr});
+    }
+}
@@ -9,31 +9,79 @@ extern "C" {
 #endif
 
     // Event Bus
+    struct bus_sub_opts_s;
+    struct bus_pub_opts_s;
+
     typedef void (*bus_cb_t)(const void* data, size_t len, void* user);
     typedef int (*bus_subscribe_t)(uint32_t plugin_id, const char* event, bus_cb_t cb, void* user);
+    typedef int (*bus_subscribe_ex_t)(uint32_t plugin_id, const char* event, bus_cb_t cb, void* user,
+                                      const struct bus_sub_opts_s* opts);
+    typedef int (*bus_publish_ex_t)(uint32_t plugin_id, const char* event, const void* data, size_t len,
+                                    const struct bus_pub_opts_s* opts);
+    // policy is a bus_backpressure_t
+    typedef int (*bus_topic_backpressure_t)(uint32_t plugin_id, const char* event, uint32_t policy,
+                                            uint32_t block_timeout_ms);
+    // Same shape for conflate and journal
+    typedef int (*bus_topic_flag_t)(uint32_t plugin_id, const char* event, int enabled);
+    // Same layout as bus_replay_cb_t
+    typedef int (*jit_replay_cb_t)(uint64_t seq, const void* data, size_t len, void* user);
+    typedef int64_t (*bus_replay_t)(uint32_t plugin_id, const char* event, uint64_t from_seq, jit_replay_cb_t cb,
+                                    void* user);
 
     // Scheduler
     typedef void (*sched_cb_t)(const void* data, size_t len, void* user);
     typedef int (*scheduler_after_ms_t)(uint32_t plugin_id, uint64_t ms, sched_cb_t cb, void* user);
     typedef int (*scheduler_every_ms_t)(uint32_t plugin_id, uint64_t ms, sched_cb_t cb, void* user);
     typedef int (*scheduler_cancel_t)(uint32_t plugin_id, int id);
+    struct sched_timer_opts_s;
+    typedef int (*scheduler_timer_ex_t)(uint32_t plugin_id, uint64_t delay_ns, uint64_t interval_ns, sched_cb_t cb,
+                                        void* user, const struct sched_timer_opts_s* opts);
 
     // Heapkit
     typedef int (*hk_get_field_t)(uint32_t plugin_id, const char* type_name, const char* field_name, void* out_value);
     typedef int (*hk_set_field_t)(uint32_t plugin_id, const char* type_name, const char* field_name, void* value);
 
+    // Event bus payload filters, same layout as bus_filter_clause_t in core_utils.h
+    typedef enum {
+        JIT_FILTER_EQ = 0,
+        JIT_FILTER_NE,
+        JIT_FILTER_LT,
+        JIT_FILTER_LE,
+        JIT_FILTER_GT,
+        JIT_FILTER_GE
+    } jit_filter_cmp_t;
+
+    typedef struct {
+        uint32_t offset;
+        uint8_t width;      // 1, 2, 4 or 8
+        uint8_t cmp;        // jit_filter_cmp_t, unsigned
+        uint64_t mask;      // never 0, the core widens it
+        uint64_t value;
+    } jit_filter_clause_t;
+
+    typedef int (*bus_filter_fn_t)(const void* data, size_t len);
+
     // C tarafında opaque struct olarak tanımlıyoruz
     typedef struct JITStub JITStub;
 
     JITStub* create_api_subscribe_stub(uint32_t plugin_id, bus_subscribe_t real_fn);
+    JITStub* create_api_subscribe_ex_stub(uint32_t plugin_id, bus_subscribe_ex_t real_fn);
+    JITStub* create_api_publish_ex_stub(uint32_t plugin_id, bus_publish_ex_t real_fn);
+    JITStub* create_api_topic_backpressure_stub(uint32_t plugin_id, bus_topic_backpressure_t real_fn);
+    JITStub* create_api_topic_flag_stub(uint32_t plugin_id, bus_topic_flag_t real_fn);
+    JITStub* create_api_replay_stub(uint32_t plugin_id, bus_replay_t real_fn);
     JITStub* create_api_scheduler_after_stub(uint32_t plugin_id, scheduler_after_ms_t real_fn);
     JITStub* create_api_scheduler_every_ms_stub(uint32_t plugin_id, scheduler_every_ms_t real_fn);
     JITStub* create_api_scheduler_cancel_stub(uint32_t plugin_id, scheduler_cancel_t real_fn);
+    JITStub* create_api_scheduler_timer_ex_stub(uint32_t plugin_id, scheduler_timer_ex_t real_fn);
 
     // HK Api
     JITStub* create_api_hk_getter_stub(uint32_t plugin_id, hk_get_field_t real_fn);
     JITStub* create_api_hk_setter_stub(uint32_t plugin_id, hk_set_field_t real_fn);
 
+    // Filter: and of every clause over the payload, get_stub_function returns a bus_filter_fn_t
+    JITStub* create_bus_filter_stub(const jit_filter_clause_t* clauses, size_t count);
+
 
     // JIT fonksiyonuna erişim sağlar
     // - Dönüş: int (*)(const char* event, void* cb, void* user)
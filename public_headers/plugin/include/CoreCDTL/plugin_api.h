@@ -22,6 +22,83 @@ typedef struct plugin_param_s {
 } plugin_param_t;
 
 typedef uint32_t plugin_id_t;
+typedef uint16_t event_id_t;
+
+typedef enum {
+    BUS_PRIORITY_INHERIT = 0,   /**< Publish: keep each subscription's class, subscribe: normal */
+    BUS_PRIORITY_REALTIME,
+    BUS_PRIORITY_NORMAL,
+    BUS_PRIORITY_BULK
+} bus_priority_t;
+
+typedef enum {
+    BUS_FILTER_EQ = 0,
+    BUS_FILTER_NE,
+    BUS_FILTER_LT,              /**< Orderings compare unsigned */
+    BUS_FILTER_LE,
+    BUS_FILTER_GT,
+    BUS_FILTER_GE
+} bus_filter_cmp_t;
+
+// Passes when (field & mask) <cmp> value, the field is width bytes at offset in host byte order
+typedef struct bus_filter_clause_s {
+    uint32_t offset;
+    uint8_t width;              /**< 1, 2, 4 or 8 */
+    uint8_t cmp;                /**< bus_filter_cmp_t */
+    uint64_t mask;              /**< 0 = every bit of the field */
+    uint64_t value;
+} bus_filter_clause_t;
+
+typedef struct bus_sub_opts_s {
+    bus_priority_t priority;
+    int ordered;                /**< Serialize deliveries per publish key, in publish order */
+    int direct;                 /**< Run the callback on the publisher's thread, for tiny non-blocking callbacks */
+    int last_value;             /**< Conflated topics: get the cached value of every key right after subscribing */
+    const bus_filter_clause_t *filter;  /**< All clauses must pass, checked before anything is queued */
+    size_t filter_len;          /**< Payloads shorter than a clause needs are rejected */
+} bus_sub_opts_t;
+
+// What a publish does when a subscriber's lane is full
+typedef enum {
+    BUS_BACKPRESSURE_INHERIT = 0,   /**< Publish: the topic's policy, topic: block */
+    BUS_BACKPRESSURE_BLOCK,         /**< Wait for room, at most block_timeout_ms when set */
+    BUS_BACKPRESSURE_FAIL,          /**< Return BUS_PUBLISH_ERR_QUEUE_FULL right away */
+    BUS_BACKPRESSURE_DROP_OLDEST,   /**< Evict the oldest queued delivery of the lane, never waits */
+    BUS_BACKPRESSURE_DROP_NEWEST,   /**< Skip this delivery, the publish still succeeds */
+    BUS_BACKPRESSURE_COALESCE       /**< One pending delivery per subscriber and key, latest wins */
+} bus_backpressure_t;
+
+typedef struct bus_pub_opts_s {
+    bus_priority_t priority;    /**< Overrides the subscriptions' class for this publish */
+    bus_backpressure_t backpressure;
+    uint32_t block_timeout_ms;
+    uint64_t key;               /**< Coalescing / ordering key */
+} bus_pub_opts_t;
+
+// Journal replay, return non-zero to stop early. data points into the journal mapping
+typedef int (*bus_replay_cb_t)(uint64_t seq, const void *data, size_t len, void *user);
+
+// One entry of a batch publish, topic wins over event when both are set
+typedef struct bus_msg_s {
+    const char *event;
+    event_id_t topic;
+    const void *data;
+    size_t len;
+} bus_msg_t;
+
+// What a periodic timer does about the periods that passed while it was late
+typedef enum {
+    SCHED_OVERRUN_SKIP = 0,     /**< Drop them, resume at the next period still ahead */
+    SCHED_OVERRUN_FIRE_ALL,     /**< Run once per missed period, back to back until caught up */
+    SCHED_OVERRUN_COALESCE      /**< Run once now, data points to a uint64_t count of the periods folded in */
+} sched_overrun_t;
+
+// Per timer options of timer_ex
+typedef struct sched_timer_opts_s {
+    int run_inline;             /**< Run on the scheduler thread instead of the callback pool, for short latency-critical work */
+    sched_overrun_t overrun;
+} sched_timer_opts_t;
+
 typedef void (*core_event_cb)(const void *data, size_t len, void *user);
 typedef core_event_cb core_timer_cb;
 typedef void (*plugin_log_internal_func_t)(size_t level, const char *plugin_name, const char *fmt, ...);
@@ -44,6 +121,30 @@ typedef struct core_api_s
     int (*timer_every_ms)(uint64_t ms, core_timer_cb cb, void *user);
     int (*timer_cancel)(int timer_id);
 
+    // Appended after the baseline slots, plugins built against them keep their offsets
+    event_id_t (*topic_id)(const char *event);
+    int (*publish_id)(plugin_id_t plugin_id, event_id_t topic, const void *data, size_t len);
+
+    // Zero-copy publish: write into loan(size), then hand it over with publish_loaned
+    void *(*loan)(size_t size);
+    int (*publish_loaned)(plugin_id_t plugin_id, const char *event, void *buf, size_t len);
+    void (*loan_discard)(void *buf);
+
+    int (*publish_batch)(plugin_id_t plugin_id, const bus_msg_t *msgs, size_t n);
+    int (*subscribe_ex)(const char *event, core_event_cb cb, void *user, const bus_sub_opts_t *opts);
+    int (*publish_ex)(const char *event, const void *data, size_t len, const bus_pub_opts_t *opts);
+    int (*topic_backpressure)(const char *event, bus_backpressure_t policy, uint32_t block_timeout_ms);
+    int (*topic_conflate)(const char *event, int conflated);
+    int (*topic_journal)(const char *event, int journaled);
+    int64_t (*replay)(const char *event, uint64_t from_seq, bus_replay_cb_t cb, void *user);
+    int (*unsubscribe)(const char *event, core_event_cb cb, void *user);
+
+    // Sub-millisecond variants on the monotonic clock
+    int (*timer_after_us)(uint64_t us, core_timer_cb cb, void *user);
+    int (*timer_every_ns)(uint64_t ns, core_timer_cb cb, void *user);
+    int (*timer_ex)(uint64_t delay_ns, uint64_t interval_ns, core_timer_cb cb, void *user,
+                    const sched_timer_opts_t *opts);
+
 } core_api_t;
 
 #ifdef CORE_IMPLEMENT_API_GLUE
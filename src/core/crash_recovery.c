@@ -2,6 +2,7 @@
 #include <unistd.h>
 #include "platform.h"
 #include "log.h"
+#include <pthread.h>
 #include <setjmp.h>
 #include <signal.h>
 #include <stdio.h>
@@ -28,6 +29,29 @@ struct sigcontext {
 
 static void crash_handler(int sig, siginfo_t *info, void *context);
 
+__thread int crash_guard_mask_saved = 0;
+static __thread sigset_t t_guard_mask;
+
+void crash_guard_save_mask(void)
+{
+    pthread_sigmask(SIG_BLOCK, NULL, &t_guard_mask);
+    crash_guard_mask_saved = 1;
+}
+
+// The jump buffers carry no mask, without this the crash signal stays blocked and the next fault kills us
+static void crash_guard_restore_mask(int sig)
+{
+    if (crash_guard_mask_saved) {
+        pthread_sigmask(SIG_SETMASK, &t_guard_mask, NULL);
+        return;
+    }
+
+    sigset_t unblock;
+    sigemptyset(&unblock);
+    sigaddset(&unblock, sig);
+    pthread_sigmask(SIG_UNBLOCK, &unblock, NULL);
+}
+
 void crash_recovery_init(void)
 {
     struct sigaction sa;
@@ -66,6 +90,7 @@ static void crash_handler(int sig, siginfo_t *info, void *ucontext)
             ctx->signal_code = info->si_code;
             ctx->fault_address = info->si_addr;
 
+            crash_guard_restore_mask(sig);
             siglongjmp(scheduler_thread_jmp_env, 1);
         }
 
@@ -76,6 +101,7 @@ static void crash_handler(int sig, siginfo_t *info, void *ucontext)
             ctx->signal_code = info->si_code;
             ctx->fault_address = info->si_addr;
 
+            crash_guard_restore_mask(sig);
             siglongjmp(event_thread_jmp_env, 1);
         }
     }
@@ -1,8 +1,31 @@
 #ifndef CORECDTL_CRASH_RECOVERY_H
 #define CORECDTL_CRASH_RECOVERY_H
 
+#include <setjmp.h>
+#include <stdint.h>
+
+#include "platform.h"
+
 void crash_recovery_init(void);
 
+/*
+ * Guarded callbacks arm their jump buffer with CRASH_GUARD_SETJMP, which
+ * leaves the signal mask out of it: saving the mask is a sigprocmask
+ * syscall per callback. The thread saves its mask once instead and the
+ * crash handler puts it back before jumping, unblocking the crash signal.
+ */
+#define CRASH_GUARD_SETJMP(env) sigsetjmp(env, 0)
+
+extern __thread int crash_guard_mask_saved;
+
+void crash_guard_save_mask(void);
+
+// Once per thread, callers on arbitrary threads (inline delivery) check it per callback
+static inline void crash_guard_ensure_mask(void)
+{
+    if (UNLIKELY(!crash_guard_mask_saved)) crash_guard_save_mask();
+}
+
 typedef struct {
     uint64_t marker;
     int signal;
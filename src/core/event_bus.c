@@ -1,13 +1,25 @@
 #include "event_bus.h"
+#include "event_bus_epoch.h"
+#include "event_bus_filter.h"
+#include "event_bus_index.h"
+#include "event_bus_journal.h"
+#include "event_bus_mailbox.h"
+#include "event_bus_trie.h"
+#include "event_bus_pool.h"
+#include "event_bus_quota.h"
+#include "event_bus_shm.h"
+#include "event_bus_slab.h"
+#include "event_bus_stats.h"
 #include "log.h"
 #include <string.h>
 #include <stdlib.h>
 #include <pthread.h>
 #include <setjmp.h>
 #include <stdio.h>
+#include <stdatomic.h>
+#include <time.h>
 
 #include "platform.h"
-#include "../utils/utils_string.h"
 #include "core_api.h"
 #include "crash_recovery.h"
 #include "gateway.h"
@@ -15,114 +27,927 @@
 
 static sub_t *g_head = NULL;
 static pthread_mutex_t sub_mutex = PTHREAD_MUTEX_INITIALIZER;
-static int g_bus_shut_down = 0;
 static api_type_t self_api_type = EVENT_BUS_API;
-static int event_count = 1;
 
 __thread sigjmp_buf event_thread_jmp_env;
 __thread volatile error_context_t event_bus_error_ctx = {
     .marker = EVENT_BUS_ERROR_MARKER
 };
 
-struct p_thread_pool pthread_pool = {
-    .thread_ptrs = NULL,
-    .thread_max_count = MAX_INIT_EVENT_BUS_THREADS,
-    .thread_count = 0,
-    .thread_map_mask = 0
-};
+void *bus_worker_thread(void *arg);
+
+static bus_payload_t *bus_payload_alloc(size_t len, uint32_t state)
+{
+    bus_payload_t *payload = bus_slab_alloc(sizeof(bus_payload_t) + len);
+    if (UNLIKELY(!payload)) return NULL;
+
+    atomic_init(&payload->refs, 1);
+    payload->state = state;
+    payload->len = len;
+    payload->topic = EVENT_ID_INVALID;
+    return payload;
+}
+
+static inline bus_payload_t *bus_payload_of(void *buf)
+{
+    return (bus_payload_t *)((unsigned char *)buf - offsetof(bus_payload_t, data));
+}
+
+static inline void bus_payload_release(bus_payload_t *payload)
+{
+    if (atomic_fetch_sub_explicit(&payload->refs, 1, memory_order_acq_rel) == 1) {
+        bus_slab_free(payload);
+    }
+}
+
+/*
+ *
+ * @brief Subscription lifetime
+ */
+static void bus_coalesce_forget(const sub_t *sub);
+
+static void bus_sub_free(sub_t *sub)
+{
+    bus_filter_destroy(sub->filter);
+    free(sub->event);
+    free(sub);
+}
+
+// Every task, inline delivery and the index own one reference
+static inline void bus_sub_hold(sub_t *sub)
+{
+    atomic_fetch_add_explicit(&sub->refs, 1, memory_order_relaxed);
+}
+
+static void bus_sub_release(sub_t *sub)
+{
+    if (atomic_fetch_sub_explicit(&sub->refs, 1, memory_order_acq_rel) != 1) return;
+
+    // Nothing is queued for it anymore, only empty cells and mailboxes are left
+    bus_coalesce_forget(sub);
+    if (sub->ordered) bus_mailbox_forget(sub, bus_payload_release);
+
+    bus_sub_free(sub);
+}
+
+// The index reference, dropped once no publisher can still see the subscription
+static void bus_sub_retired(void *ptr)
+{
+    bus_sub_release(ptr);
+}
+
+static inline int bus_sub_dead(const sub_t *sub)
+{
+    return atomic_load_explicit(&sub->dead, memory_order_acquire) != 0;
+}
+
+static inline int bus_sub_wants(const sub_t *sub, const void *data, size_t len)
+{
+    return LIKELY(!sub->filter) || bus_filter_match(sub->filter, data, len);
+}
+
+/*
+ * Index of the first subscriber that wants the payload, every one before it
+ * filtered it out. Dispatch starts there and takes it without asking again,
+ * so each filter runs once per publish. count means nobody wants it and the
+ * payload need not even be copied.
+ */
+static size_t bus_list_first_wanted(const bus_sub_list_t *list, const void *data, size_t len)
+{
+    if (!list) return 0;
+
+    size_t i = 0;
+    while (i < list->count && UNLIKELY(!bus_sub_wants(list->subs[i], data, len))) i++;
+    return i;
+}
+
+/*
+ *
+ * @brief Inline delivery on the publisher's thread
+ */
+// Collected inside the index read section and run after it, callbacks may subscribe
+typedef struct {
+    sub_t *subs[BUS_INLINE_MAX];
+    bus_payload_t *payloads[BUS_INLINE_MAX];
+    size_t count;
+} bus_inline_set_t;
+
+static atomic_uint g_inline_promote_ns = 0;
+static atomic_int g_latency_stats = 1;
+// Set while this thread runs a bus callback, nested publishes stay queued
+static __thread int t_bus_in_callback = 0;
+// Set for good on threads running other core callbacks, see bus_mark_core_thread
+static __thread int t_bus_core_thread = 0;
+
+// A quota delay would stall every callback queued behind this one
+static inline int bus_quota_may_delay(void)
+{
+    return !t_bus_in_callback && !t_bus_core_thread;
+}
+
+static inline int bus_sub_sampled(const sub_t *sub)
+{
+    return atomic_load_explicit(&g_inline_promote_ns, memory_order_relaxed) != 0 &&
+        !sub->ordered && atomic_load_explicit(&sub->direct, memory_order_relaxed) != BUS_SUB_DIRECT;
+}
+
+static void bus_sub_sample(sub_t *sub, uint64_t elapsed_ns)
+{
+    const unsigned int threshold = atomic_load_explicit(&g_inline_promote_ns, memory_order_relaxed);
+    if (threshold == 0) return;
+
+    const unsigned int sample = elapsed_ns > UINT32_MAX ? UINT32_MAX : (unsigned int)elapsed_ns;
+    const unsigned int n = atomic_fetch_add_explicit(&sub->cb_samples, 1, memory_order_relaxed) + 1;
+
+    // Moving average over ~8 calls, racing workers only blur it
+    unsigned int avg = atomic_load_explicit(&sub->cb_avg_ns, memory_order_relaxed);
+    avg = n == 1 ? sample : avg - avg / 8 + sample / 8;
+    atomic_store_explicit(&sub->cb_avg_ns, avg, memory_order_relaxed);
+
+    if (n < BUS_INLINE_PROMOTE_SAMPLES) return;
+
+    const unsigned int mode = atomic_load_explicit(&sub->direct, memory_order_relaxed);
+    if (mode == BUS_SUB_QUEUED && avg < threshold) {
+        atomic_store_explicit(&sub->direct, BUS_SUB_PROMOTED, memory_order_relaxed);
+    } else if (mode == BUS_SUB_PROMOTED && avg > threshold * 2) {
+        // Slowed down, back to the workers and start measuring again
+        atomic_store_explicit(&sub->direct, BUS_SUB_QUEUED, memory_order_relaxed);
+        atomic_store_explicit(&sub->cb_samples, 0, memory_order_relaxed);
+    }
+}
+
+static inline int bus_sub_timed(const sub_t *sub)
+{
+    return atomic_load_explicit(&g_latency_stats, memory_order_relaxed) || bus_sub_sampled(sub);
+}
+
+// Callback timing feeds the latency histograms and inline promotion
+static void bus_delivery_done(sub_t *sub, size_t slot, event_id_t topic, uint64_t wait_ns, uint64_t start_ns)
+{
+    const uint64_t exec_ns = bus_now_ns() - start_ns;
+
+    if (atomic_load_explicit(&g_latency_stats, memory_order_relaxed))
+        bus_stats_record(slot, topic, sub->plugin_id, wait_ns, exec_ns);
+    if (bus_sub_sampled(sub)) bus_sub_sample(sub, exec_ns);
+}
+
+static inline int bus_inline_take(bus_inline_set_t *set, sub_t *sub, bus_payload_t *payload)
+{
+    if (LIKELY(atomic_load_explicit(&sub->direct, memory_order_relaxed) == BUS_SUB_QUEUED)) return 0;
+    if (!set || set->count == BUS_INLINE_MAX || t_bus_in_callback) return 0;
+
+    set->subs[set->count] = sub;
+    set->payloads[set->count] = payload;
+    set->count++;
+    return 1;
+}
+
+// Same crash guard as bus_worker_thread, the marker must stay in this frame
+__attribute__((noinline))
+static void bus_inline_deliver(sub_t *sub, bus_payload_t *payload)
+{
+    error_context_t local_ctx = event_bus_error_ctx;
+    asm volatile("" : : "r"(&local_ctx) : "memory");
+
+    t_bus_in_callback = 1;
+    crash_guard_ensure_mask();
+
+    if (CRASH_GUARD_SETJMP(event_thread_jmp_env) != 0) {
+        add_event_bus_critical_error(sub->plugin_id, sub->event,
+            CRITICAL_ERROR_QUEUE_SOURCE_EVENT_BUS, event_bus_error_ctx);
+    } else if (LIKELY(!bus_sub_dead(sub))) {
+        const uint64_t start = bus_sub_timed(sub) ? bus_now_ns() : 0;
+        sub->cb(payload->data, payload->len, sub->user);
+        if (start) {
+            const uint64_t wait = start > payload->publish_ns ? start - payload->publish_ns : 0;
+            bus_delivery_done(sub, BUS_STATS_INLINE_SLOT, payload->topic, wait, start);
+        }
+    }
+
+    t_bus_in_callback = 0;
+    bus_payload_release(payload);
+    bus_sub_release(sub);
+}
+
+static void bus_inline_run(const bus_inline_set_t *set)
+{
+    for (size_t i = 0; i < set->count; i++) {
+        bus_inline_deliver(set->subs[i], set->payloads[i]);
+    }
+}
+
+void bus_set_inline_promotion(uint32_t threshold_ns)
+{
+    atomic_store_explicit(&g_inline_promote_ns, threshold_ns, memory_order_relaxed);
+}
+
+/*
+ *
+ * @brief Coalescing: one pending delivery per (subscriber, key)
+ */
+#define BUS_COALESCE_BUCKETS 256
+
+typedef struct bus_coalesce_cell_s {
+    const sub_t *sub;
+    uint64_t key;
+    bus_payload_t *payload;     // latest pending payload, NULL once a worker took it
+    struct bus_coalesce_cell_s *next;
+} bus_coalesce_cell_t;
+
+static bus_coalesce_cell_t *g_coalesce[BUS_COALESCE_BUCKETS];
+static pthread_mutex_t g_coalesce_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static struct {
+    atomic_uint_fast64_t block_timeouts;
+    atomic_uint_fast64_t failed;
+    atomic_uint_fast64_t dropped_oldest;
+    atomic_uint_fast64_t dropped_newest;
+    atomic_uint_fast64_t coalesced;
+} g_bp_stats;
+
+static inline size_t bus_coalesce_bucket(const sub_t *sub, uint64_t key)
+{
+    uint64_t h = ((uint64_t)(uintptr_t)sub ^ key) * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h >> 56) & (BUS_COALESCE_BUCKETS - 1);
+}
+
+static bus_payload_t *bus_coalesce_take(bus_coalesce_cell_t *cell)
+{
+    pthread_mutex_lock(&g_coalesce_mutex);
+    bus_payload_t *payload = cell->payload;
+    cell->payload = NULL;
+    pthread_mutex_unlock(&g_coalesce_mutex);
+
+    return payload;
+}
+
+static void bus_coalesce_forget(const sub_t *sub)
+{
+    pthread_mutex_lock(&g_coalesce_mutex);
+    for (size_t i = 0; i < BUS_COALESCE_BUCKETS; i++) {
+        bus_coalesce_cell_t **link = &g_coalesce[i];
+
+        while (*link) {
+            bus_coalesce_cell_t *cell = *link;
+            if (cell->sub != sub) {
+                link = &cell->next;
+                continue;
+            }
+
+            *link = cell->next;
+            if (cell->payload) bus_payload_release(cell->payload);
+            free(cell);
+        }
+    }
+    pthread_mutex_unlock(&g_coalesce_mutex);
+}
+
+static void bus_coalesce_destroy(void)
+{
+    pthread_mutex_lock(&g_coalesce_mutex);
+    for (size_t i = 0; i < BUS_COALESCE_BUCKETS; i++) {
+        bus_coalesce_cell_t *cell = g_coalesce[i];
+        while (cell) {
+            bus_coalesce_cell_t *n = cell->next;
+            if (cell->payload) bus_payload_release(cell->payload);
+            free(cell);
+            cell = n;
+        }
+        g_coalesce[i] = NULL;
+    }
+    pthread_mutex_unlock(&g_coalesce_mutex);
+}
+
+// Queued tasks hold a subscription reference and a payload reference, a coalescing cell or a mailbox
+static void bus_task_discard(const bus_task_t *task)
+{
+    // Mailbox contents are released with the mailbox
+    if (!(task->flags & BUS_TASK_MAILBOX)) {
+        bus_payload_t *payload = task->flags & BUS_TASK_COALESCED ? bus_coalesce_take(task->cell) : task->payload;
+        if (payload) bus_payload_release(payload);
+    }
+
+    bus_sub_release(task->sub_ptr);
+}
+
+static int bus_coalesce_submit(const bus_task_t *task, uint64_t key)
+{
+    const size_t bucket = bus_coalesce_bucket(task->sub_ptr, key);
+
+    pthread_mutex_lock(&g_coalesce_mutex);
+
+    bus_coalesce_cell_t *cell = g_coalesce[bucket];
+    while (cell && (cell->sub != task->sub_ptr || cell->key != key)) cell = cell->next;
+
+    if (!cell) {
+        cell = calloc(1, sizeof(bus_coalesce_cell_t));
+        if (!cell) {
+            pthread_mutex_unlock(&g_coalesce_mutex);
+            bus_payload_release(task->payload);
+            bus_sub_release(task->sub_ptr);
+            return BUS_PUBLISH_ERR_MALLOC_FAILED;
+        }
+        cell->sub = task->sub_ptr;
+        cell->key = key;
+        cell->next = g_coalesce[bucket];
+        g_coalesce[bucket] = cell;
+    }
+
+    bus_payload_t *stale = cell->payload;
+    cell->payload = task->payload;
+
+    pthread_mutex_unlock(&g_coalesce_mutex);
+
+    if (stale) {
+        // The queued task will deliver the newer payload instead, and holds the subscription
+        bus_payload_release(stale);
+        bus_sub_release(task->sub_ptr);
+        atomic_fetch_add_explicit(&g_bp_stats.coalesced, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    bus_task_t pending = *task;
+    pending.cell = cell;
+    pending.flags |= BUS_TASK_COALESCED;
+
+    // Never block here, a cell without a queued task would be stuck forever
+    int ret = bus_pool_submit(&pending, 0);
+    if (ret != 0) {
+        bus_payload_t *payload = bus_coalesce_take(cell);
+        if (payload) bus_payload_release(payload);
+        bus_sub_release(task->sub_ptr);
+        if (ret == BUS_POOL_FULL) atomic_fetch_add_explicit(&g_bp_stats.dropped_newest, 1, memory_order_relaxed);
+    }
+
+    return 0;
+}
+
+/*
+ *
+ * @brief Backpressure
+ */
+static bus_backpressure_t bus_policy_resolve(event_id_t topic, const bus_pub_opts_t *opts, int64_t *timeout_ns)
+{
+    bus_backpressure_t policy = opts ? opts->backpressure : BUS_BACKPRESSURE_INHERIT;
+    uint32_t timeout_ms = opts ? opts->block_timeout_ms : 0;
+    const bus_topic_policy_t *topic_policy = bus_topic_policy_locked(topic);
+
+    // Conflated topics only ever hold the newest value per key, whatever the publisher asks
+    if (topic_policy && topic_policy->conflated) {
+        *timeout_ns = -1;
+        return BUS_BACKPRESSURE_COALESCE;
+    }
+
+    if (policy == BUS_BACKPRESSURE_INHERIT) {
+        policy = topic_policy ? topic_policy->backpressure : BUS_BACKPRESSURE_BLOCK;
+        timeout_ms = topic_policy ? topic_policy->block_timeout_ms : 0;
+    }
+
+    *timeout_ns = timeout_ms ? (int64_t)timeout_ms * 1000000LL : -1;
+    return policy;
+}
+
+static int bus_mailbox_submit(const bus_task_t *task, bus_backpressure_t policy, uint64_t key)
+{
+    bus_payload_t *evicted;
+    bus_mailbox_t *schedule;
+
+    if (bus_mailbox_push(task->sub_ptr, key, task->payload, policy == BUS_BACKPRESSURE_DROP_OLDEST,
+            &evicted, &schedule) != 0) {
+        bus_payload_release(task->payload);
+        bus_sub_release(task->sub_ptr);
+
+        if (policy == BUS_BACKPRESSURE_DROP_NEWEST) {
+            atomic_fetch_add_explicit(&g_bp_stats.dropped_newest, 1, memory_order_relaxed);
+            return 0;
+        }
+        atomic_fetch_add_explicit(&g_bp_stats.failed, 1, memory_order_relaxed);
+        return BUS_PUBLISH_ERR_QUEUE_FULL;
+    }
+
+    if (evicted) {
+        bus_payload_release(evicted);
+        atomic_fetch_add_explicit(&g_bp_stats.dropped_oldest, 1, memory_order_relaxed);
+    }
+
+    if (!schedule) {
+        // The task already draining the mailbox holds the subscription
+        bus_sub_release(task->sub_ptr);
+        return 0;
+    }
+
+    bus_task_t run = {
+        .mailbox = schedule,
+        .sub_ptr = task->sub_ptr,
+        .lane = task->lane,
+        .flags = BUS_TASK_MAILBOX
+    };
+
+    // Its payloads are already accepted, so the mailbox task is never dropped. Waiting for room
+    // is no option either, the publisher may be one of the workers that would make it
+    const int ret = bus_pool_submit(&run, 0);
+    if (ret == BUS_POOL_FULL) bus_pool_defer(bus_mailbox_node(schedule), &run);
+    else if (ret != 0) bus_sub_release(task->sub_ptr);
+    return 0;
+}
+
+// Makes room for a DROP_OLDEST publish, see bus_pool_submit_evict
+static void bus_evict(bus_task_t *evicted)
+{
+    // A mailbox's payloads are already accepted, it keeps its task off the shards instead
+    if (evicted->flags & BUS_TASK_MAILBOX) {
+        bus_pool_defer(bus_mailbox_node(evicted->mailbox), evicted);
+        return;
+    }
+
+    bus_task_discard(evicted);
+    atomic_fetch_add_explicit(&g_bp_stats.dropped_oldest, 1, memory_order_relaxed);
+}
+
+// Consumes the task's payload and subscription references whether or not it gets queued
+static int bus_submit(const bus_task_t *task, bus_backpressure_t policy, int64_t timeout_ns, uint64_t key)
+{
+    int ret;
+
+    // Ordered subscriptions bound their mailbox instead of the shared lane
+    if (task->sub_ptr->ordered) return bus_mailbox_submit(task, policy, key);
+
+    switch (policy) {
+        case BUS_BACKPRESSURE_COALESCE:
+            return bus_coalesce_submit(task, key);
+        case BUS_BACKPRESSURE_DROP_OLDEST:
+            ret = bus_pool_submit_evict(task, bus_evict);
+            break;
+        case BUS_BACKPRESSURE_FAIL:
+        case BUS_BACKPRESSURE_DROP_NEWEST:
+            ret = bus_pool_submit(task, 0);
+            break;
+        default:
+            ret = bus_pool_submit(task, timeout_ns);
+            break;
+    }
+
+    if (LIKELY(ret == 0)) return 0;
+
+    bus_payload_release(task->payload);
+    bus_sub_release(task->sub_ptr);
+    if (ret == BUS_POOL_STOPPED) return 0;
+
+    switch (policy) {
+        case BUS_BACKPRESSURE_DROP_NEWEST:
+        case BUS_BACKPRESSURE_DROP_OLDEST:
+            // Evicting did not free a slot in time, a drop policy still never fails the publish
+            atomic_fetch_add_explicit(&g_bp_stats.dropped_newest, 1, memory_order_relaxed);
+            return 0;
+        case BUS_BACKPRESSURE_FAIL:
+            atomic_fetch_add_explicit(&g_bp_stats.failed, 1, memory_order_relaxed);
+            return BUS_PUBLISH_ERR_QUEUE_FULL;
+        default:
+            atomic_fetch_add_explicit(&g_bp_stats.block_timeouts, 1, memory_order_relaxed);
+            return BUS_PUBLISH_ERR_QUEUE_FULL;
+    }
+}
+
+/*
+ *
+ * @brief BLOCK submissions waiting for room
+ */
+// A publisher parked inside the index read section would hold back every reclaim, so tasks that
+// find the pool full are kept here and submitted once the section is left
+typedef struct {
+    bus_task_t task;
+    int64_t timeout_ns;
+} bus_parked_task_t;
+
+typedef struct {
+    bus_parked_task_t *tasks;
+    size_t count;
+    size_t capacity;
+} bus_park_set_t;
+
+static int bus_park_add(bus_park_set_t *park, const bus_task_t *task, int64_t timeout_ns)
+{
+    if (park->count == park->capacity) {
+        const size_t capacity = park->capacity ? park->capacity * 2 : 16;
+        bus_parked_task_t *tasks = realloc(park->tasks, capacity * sizeof(bus_parked_task_t));
+        if (!tasks) {
+            bus_task_discard(task);
+            atomic_fetch_add_explicit(&g_bp_stats.failed, 1, memory_order_relaxed);
+            return BUS_PUBLISH_ERR_MALLOC_FAILED;
+        }
+        park->tasks = tasks;
+        park->capacity = capacity;
+    }
+
+    park->tasks[park->count].task = *task;
+    park->tasks[park->count].timeout_ns = timeout_ns;
+    park->count++;
+    return 0;
+}
+
+// Inside the index read section, consumes the task's references like bus_submit
+static int bus_park_submit(bus_park_set_t *park, const bus_task_t *task, int64_t timeout_ns)
+{
+    // Once one task waits the later ones queue behind it, a subscriber still sees them in order
+    if (park->count == 0) {
+        const int ret = bus_pool_submit(task, 0);
+        if (LIKELY(ret == 0)) return 0;
+        if (ret == BUS_POOL_STOPPED) {
+            bus_task_discard(task);
+            return 0;
+        }
+    }
+
+    return bus_park_add(park, task, timeout_ns);
+}
+
+// After the index read section, the first error wins
+static int bus_park_run(bus_park_set_t *park)
+{
+    int ret = 0;
+
+    for (size_t i = 0; i < park->count; i++) {
+        const int err = bus_submit(&park->tasks[i].task, BUS_BACKPRESSURE_BLOCK, park->tasks[i].timeout_ns, 0);
+        if (err && !ret) ret = err;
+    }
+
+    free(park->tasks);
+    park->tasks = NULL;
+    park->count = 0;
+    park->capacity = 0;
+    return ret;
+}
+
+void bus_get_backpressure_stats(bus_backpressure_stats_t *out)
+{
+    if (!out) return;
+
+    out->block_timeouts = atomic_load_explicit(&g_bp_stats.block_timeouts, memory_order_relaxed);
+    out->failed = atomic_load_explicit(&g_bp_stats.failed, memory_order_relaxed);
+    out->dropped_oldest = atomic_load_explicit(&g_bp_stats.dropped_oldest, memory_order_relaxed);
+    out->dropped_newest = atomic_load_explicit(&g_bp_stats.dropped_newest, memory_order_relaxed);
+    out->coalesced = atomic_load_explicit(&g_bp_stats.coalesced, memory_order_relaxed);
+}
+
+// Serializes read-modify-write of a topic policy
+static pthread_mutex_t g_policy_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Called with g_policy_mutex held, see bus_topic_set_backpressure
+static int bus_topic_claim(plugin_id_t plugin_id, bus_topic_policy_t *policy)
+{
+    if (plugin_id == PLUGIN_ID_INVALID) return 0;
+    if (policy->owner != PLUGIN_ID_INVALID && policy->owner != plugin_id) return BUS_SUB_ERR_NOT_OWNER;
+
+    policy->owner = plugin_id;
+    return 0;
+}
+
+int bus_topic_set_backpressure(plugin_id_t plugin_id, const char *event, bus_backpressure_t policy,
+                               uint32_t block_timeout_ms)
+{
+    if (!event) return BUS_SUB_ERR_INVALID_EVENT;
+    if (policy < BUS_BACKPRESSURE_BLOCK || policy > BUS_BACKPRESSURE_COALESCE) return -1;
+
+    event_id_t topic = bus_topic_lookup(event);
+    if (topic == EVENT_ID_INVALID) return BUS_SUB_ERR_NOT_FOUND;
+
+    bus_topic_policy_t topic_policy;
+
+    pthread_mutex_lock(&g_policy_mutex);
+    int ret = bus_topic_get_policy(topic, &topic_policy);
+    if (ret == 0) ret = bus_topic_claim(plugin_id, &topic_policy);
+    if (ret == 0) {
+        topic_policy.backpressure = policy;
+        topic_policy.block_timeout_ms = block_timeout_ms;
+        ret = bus_topic_set_policy(topic, &topic_policy);
+    }
+    pthread_mutex_unlock(&g_policy_mutex);
+
+    return ret;
+}
+
+/*
+ *
+ * @brief Publish quotas, checked before the index read section so a delayed publisher holds nothing
+ */
+int bus_set_quota(plugin_id_t plugin_id, const char *event, const bus_quota_t *quota)
+{
+    event_id_t topic = EVENT_ID_INVALID;
+    if (event) {
+        topic = bus_topic_lookup(event);
+        if (topic == EVENT_ID_INVALID) return BUS_SUB_ERR_NOT_FOUND;
+    }
+
+    return bus_quota_set(plugin_id, topic, quota);
+}
+
+int bus_get_quota_stats(plugin_id_t plugin_id, bus_quota_stats_t *out)
+{
+    if (!out) return -1;
+    return bus_quota_stats(plugin_id, out);
+}
+
+static inline void bus_sleep_ns(uint64_t ns)
+{
+    const struct timespec ts = { .tv_sec = (time_t)(ns / 1000000000ULL), .tv_nsec = (long)(ns % 1000000000ULL) };
+    nanosleep(&ts, NULL);
+}
+
+void bus_mark_core_thread(void)
+{
+    t_bus_core_thread = 1;
+}
+
+// Core threads never sleep for a quota, a delay policy rejects inside callbacks
+static int bus_quota_check(plugin_id_t plugin_id, event_id_t topic)
+{
+    uint64_t delay_ns;
+    const int verdict = bus_quota_admit(plugin_id, topic, bus_quota_may_delay(), &delay_ns);
+    if (UNLIKELY(delay_ns)) bus_sleep_ns(delay_ns);
+
+    switch (verdict) {
+        case BUS_QUOTA_PASS: return 0;
+        case BUS_QUOTA_DROPPED: return -1;
+        default: return BUS_PUBLISH_ERR_RATE_LIMITED;
+    }
+}
+
+/*
+ *
+ * @brief Last value cache: newest payload per (plugin_id, topic, key) of conflated topics
+ */
+#define BUS_LVC_BUCKETS 256
+
+typedef struct bus_lvc_entry_s {
+    plugin_id_t plugin_id;
+    event_id_t topic;
+    uint64_t key;
+    bus_payload_t *payload;     // holds its own reference
+    struct bus_lvc_entry_s *next;
+} bus_lvc_entry_t;
+
+static bus_lvc_entry_t *g_lvc[BUS_LVC_BUCKETS];
+static pthread_mutex_t g_lvc_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Every key of a topic shares a bucket, so a replay walks one chain
+static inline size_t bus_lvc_bucket(plugin_id_t plugin_id, event_id_t topic)
+{
+    uint64_t h = (((uint64_t)plugin_id << 16) | topic) * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h >> 56) & (BUS_LVC_BUCKETS - 1);
+}
+
+// Takes over one reference to payload
+static void bus_lvc_store(plugin_id_t plugin_id, event_id_t topic, uint64_t key, bus_payload_t *payload)
+{
+    const size_t bucket = bus_lvc_bucket(plugin_id, topic);
+    bus_payload_t *stale = NULL;
+
+    pthread_mutex_lock(&g_lvc_mutex);
+
+    bus_lvc_entry_t *entry = g_lvc[bucket];
+    while (entry && (entry->plugin_id != plugin_id || entry->topic != topic || entry->key != key)) entry = entry->next;
+
+    if (!entry) {
+        entry = calloc(1, sizeof(bus_lvc_entry_t));
+        if (!entry) {
+            pthread_mutex_unlock(&g_lvc_mutex);
+            bus_payload_release(payload);
+            return;
+        }
+        entry->plugin_id = plugin_id;
+        entry->topic = topic;
+        entry->key = key;
+        entry->next = g_lvc[bucket];
+        g_lvc[bucket] = entry;
+    }
+
+    stale = entry->payload;
+    entry->payload = payload;
+
+    pthread_mutex_unlock(&g_lvc_mutex);
+
+    if (stale) bus_payload_release(stale);
+}
+
+// Queues the cached value of every key to a new subscriber
+static void bus_lvc_replay(sub_t *sub)
+{
+    const size_t bucket = bus_lvc_bucket(sub->plugin_id, sub->event_id);
+
+    pthread_mutex_lock(&g_lvc_mutex);
+
+    for (bus_lvc_entry_t *entry = g_lvc[bucket]; entry; entry = entry->next) {
+        if (entry->plugin_id != sub->plugin_id || entry->topic != sub->event_id) continue;
+        if (!bus_sub_wants(sub, entry->payload->data, entry->payload->len)) continue;
+
+        atomic_fetch_add_explicit(&entry->payload->refs, 1, memory_order_relaxed);
+        bus_sub_hold(sub);
+
+        bus_task_t task = {
+            .payload = entry->payload,
+            .sub_ptr = sub,
+            .lane = sub->lane,
+            .flags = 0
+        };
+
+        // Coalescing never blocks, safe under the cache lock
+        bus_submit(&task, BUS_BACKPRESSURE_COALESCE, -1, entry->key);
+    }
+
+    pthread_mutex_unlock(&g_lvc_mutex);
+}
+
+// topic EVENT_ID_INVALID drops everything
+static void bus_lvc_drop(event_id_t topic)
+{
+    pthread_mutex_lock(&g_lvc_mutex);
+
+    for (size_t i = 0; i < BUS_LVC_BUCKETS; i++) {
+        bus_lvc_entry_t **link = &g_lvc[i];
+
+        while (*link) {
+            bus_lvc_entry_t *entry = *link;
+            if (topic != EVENT_ID_INVALID && entry->topic != topic) {
+                link = &entry->next;
+                continue;
+            }
+
+            *link = entry->next;
+            bus_payload_release(entry->payload);
+            free(entry);
+        }
+    }
+
+    pthread_mutex_unlock(&g_lvc_mutex);
+}
+
+int bus_topic_set_conflated(plugin_id_t plugin_id, const char *event, int conflated)
+{
+    if (!event) return BUS_SUB_ERR_INVALID_EVENT;
 
-task_event_bus_queue_t g_task_event_bus_queue_t;
+    event_id_t topic = bus_topic_lookup(event);
+    if (topic == EVENT_ID_INVALID) return BUS_SUB_ERR_NOT_FOUND;
 
-void *bus_worker_thread(void *arg);
+    bus_topic_policy_t topic_policy;
+
+    pthread_mutex_lock(&g_policy_mutex);
+    int ret = bus_topic_get_policy(topic, &topic_policy);
+    if (ret == 0) ret = bus_topic_claim(plugin_id, &topic_policy);
+    if (ret == 0) {
+        topic_policy.conflated = conflated ? 1 : 0;
+        ret = bus_topic_set_policy(topic, &topic_policy);
+    }
+    pthread_mutex_unlock(&g_policy_mutex);
+
+    // Turning it off forgets the cached values
+    if (ret == 0 && !conflated) bus_lvc_drop(topic);
+    return ret;
+}
+
+/*
+ *
+ * @brief Journal: publishes of selected topics kept on disk for replay
+ */
+int bus_topic_set_journal(plugin_id_t plugin_id, const char *event, int journaled)
+{
+    if (!event) return BUS_SUB_ERR_INVALID_EVENT;
+    if (journaled && !bus_journal_enabled()) return -1;
+
+    event_id_t topic = bus_topic_lookup(event);
+    if (topic == EVENT_ID_INVALID) return BUS_SUB_ERR_NOT_FOUND;
+
+    bus_topic_policy_t topic_policy;
+
+    pthread_mutex_lock(&g_policy_mutex);
+    int ret = bus_topic_get_policy(topic, &topic_policy);
+    if (ret == 0) ret = bus_topic_claim(plugin_id, &topic_policy);
+    if (ret == 0) {
+        topic_policy.journaled = journaled ? 1 : 0;
+        ret = bus_topic_set_policy(topic, &topic_policy);
+    }
+    pthread_mutex_unlock(&g_policy_mutex);
+
+    return ret;
+}
+
+int64_t bus_replay(plugin_id_t plugin_id, const char *event, uint64_t from_seq, bus_replay_cb_t cb, void *user)
+{
+    if (UNLIKELY(plugin_id == PLUGIN_ID_INVALID || !event || !cb)) return -1;
+    return bus_journal_replay(plugin_id, event, from_seq, cb, user);
+}
 
 int bus_init(void)
 {
-    pthread_pool.thread_ptrs = malloc(sizeof(pthread_t*) * MAX_INIT_EVENT_BUS_THREADS);
-    if (!pthread_pool.thread_ptrs) {
-        core_log_error("Could not allocate bus thread pool");
+    const bus_config_t config = BUS_CONFIG_DEFAULT;
+    return bus_init_config(&config);
+}
+
+int bus_init_config(const bus_config_t *config)
+{
+    if (!config) return -1;
+
+    if (bus_slab_init() != 0) {
+        core_log_error("Could not initialize bus payload slab");
         return -1;
     }
 
-    for (int i = 0; i < MAX_INIT_EVENT_BUS_THREADS; i++) {
-        pthread_t *thread = malloc(sizeof(pthread_t));
-        if (!thread) return -1;
-
-        pthread_attr_t attr;
-        pthread_attr_init(&attr);
-        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+    atomic_store(&g_bp_stats.block_timeouts, 0);
+    atomic_store(&g_bp_stats.failed, 0);
+    atomic_store(&g_bp_stats.dropped_oldest, 0);
+    atomic_store(&g_bp_stats.dropped_newest, 0);
+    atomic_store(&g_bp_stats.coalesced, 0);
+    bus_set_inline_promotion(config->inline_promote_ns);
+    atomic_store(&g_latency_stats, config->latency_stats ? 1 : 0);
 
-        if (pthread_create(thread, &attr, &bus_worker_thread, NULL) != 0) {
-            free(thread);
-            return -1;
-        }
+    if (bus_index_init() != 0) {
+        core_log_error("Could not allocate bus subscription index");
+        return -1;
+    }
 
-        pthread_attr_destroy(&attr);
-        pthread_pool.thread_ptrs[i] = thread;
-        pthread_pool.thread_count++;
-        pthread_pool.thread_map_mask |= (1ULL << i);
+    if (bus_journal_init(config) != 0) {
+        core_log_error("Could not open bus journal");
+        return -1;
     }
 
-    g_task_event_bus_queue_t.head = 0;
-    g_task_event_bus_queue_t.tail = 0;
-    g_task_event_bus_queue_t.count = 0;
-    pthread_mutex_init(&g_task_event_bus_queue_t.mutex, NULL);
-    pthread_cond_init(&g_task_event_bus_queue_t.cond_not_empty, NULL);
-    pthread_cond_init(&g_task_event_bus_queue_t.cond_not_full, NULL);
+    if (bus_pool_init(config, &bus_worker_thread) != 0) {
+        core_log_error("Could not start bus worker pool");
+        return -1;
+    }
 
     return 0;
 }
 
 void bus_shutdown(void)
 {
-    pthread_mutex_lock(&g_task_event_bus_queue_t.mutex);
-    g_bus_shut_down = 1;
+    // Remote publishers go first, their service threads publish into the pool
+    bus_shm_stop();
+    bus_pool_stop();
 
-    pthread_cond_broadcast(&g_task_event_bus_queue_t.cond_not_empty);
-    pthread_mutex_unlock(&g_task_event_bus_queue_t.mutex);
-
-    for (size_t i = 0; i < pthread_pool.thread_count; i++) {
-        pthread_join(*pthread_pool.thread_ptrs[i], NULL);
-        free(pthread_pool.thread_ptrs[i]);
+    bus_task_t task;
+    while (bus_pool_drain(&task) == 0) {
+        bus_task_discard(&task);
     }
-    free(pthread_pool.thread_ptrs);
-    pthread_pool.thread_ptrs = NULL;
-    pthread_pool.thread_count = 0;
 
-    for (size_t i = 0; i < g_task_event_bus_queue_t.count; i++) {
-        size_t index = (g_task_event_bus_queue_t.head + i) % MAX_TASKS;
-        free(g_task_event_bus_queue_t.tasks[index].data);
-    }
+    bus_pool_destroy();
+    bus_shm_destroy();
+    bus_journal_destroy();
+    bus_stats_destroy();
+    bus_quota_destroy();
+    bus_coalesce_destroy();
+    bus_lvc_drop(EVENT_ID_INVALID);
+    bus_mailbox_destroy(bus_payload_release);
+    bus_slab_destroy();
 
-    pthread_mutex_destroy(&g_task_event_bus_queue_t.mutex);
-    pthread_cond_destroy(&g_task_event_bus_queue_t.cond_not_empty);
-    pthread_cond_destroy(&g_task_event_bus_queue_t.cond_not_full);
+    bus_index_destroy();
 
     pthread_mutex_lock(&sub_mutex);
     sub_t *it = g_head;
     while (it) {
         sub_t *n = it->next;
-        free(it->event);
-        free(it);
+        bus_sub_free(it);
         it = n;
     }
     g_head = NULL;
     pthread_mutex_unlock(&sub_mutex);
 
     pthread_mutex_destroy(&sub_mutex);
+}
 
-    event_count = 1;
+static inline uint32_t bus_lane_of(bus_priority_t priority)
+{
+    if (priority < BUS_PRIORITY_REALTIME || priority > BUS_PRIORITY_BULK) priority = BUS_PRIORITY_NORMAL;
+    return (uint32_t)priority - BUS_PRIORITY_REALTIME;
 }
 
 int bus_subscribe(plugin_id_t plugin_id, const char *event, bus_cb_t cb, void *user)
+{
+    return bus_subscribe_ex(plugin_id, event, cb, user, NULL);
+}
+
+int bus_subscribe_ex(plugin_id_t plugin_id, const char *event, bus_cb_t cb, void *user, const bus_sub_opts_t *opts)
 {
     if (!event) return BUS_SUB_ERR_INVALID_EVENT;
     if (!cb) return BUS_SUB_ERR_INVALID_CB;
 
+    // Wildcard patterns live in the topic trie and are never interned
+    const int pattern = bus_topic_is_pattern(event);
+    if (pattern < 0) return BUS_SUB_ERR_INVALID_EVENT;
+
+    bus_filter_t *filter = NULL;
+    if (opts && opts->filter_len) {
+        filter = bus_filter_compile(opts->filter, opts->filter_len);
+        if (!filter) return BUS_SUB_ERR_INVALID_FILTER;
+    }
+
     sub_t *s = malloc(sizeof(sub_t));
-    if (!s) return BUS_SUB_ERR_ALLOC_FAILED;
+    if (!s) {
+        bus_filter_destroy(filter);
+        return BUS_SUB_ERR_ALLOC_FAILED;
+    }
 
     s->event = strdup(event);
     if (!s->event) {
+        bus_filter_destroy(filter);
         free(s);
         return BUS_SUB_ERR_STRDUP_FAILED;
     }
@@ -130,13 +955,29 @@ int bus_subscribe(plugin_id_t plugin_id, const char *event, bus_cb_t cb, void *u
     s->cb = cb;
     s->user = user;
     s->plugin_id = plugin_id;
-    s->event_id = event_count++;
+    s->lane = (uint8_t)bus_lane_of(opts ? opts->priority : BUS_PRIORITY_NORMAL);
+    s->ordered = opts && opts->ordered;
+    // Ordered subscribers must not run on several publisher threads at once
+    atomic_init(&s->direct, opts && opts->direct && !s->ordered ? BUS_SUB_DIRECT : BUS_SUB_QUEUED);
+    atomic_init(&s->cb_avg_ns, 0);
+    atomic_init(&s->cb_samples, 0);
+    atomic_init(&s->refs, 1);
+    atomic_init(&s->dead, 0);
+    s->filter = filter;
+    s->event_id = pattern ? EVENT_ID_INVALID : bus_topic_intern(event);
 
     pthread_mutex_lock(&sub_mutex);
+    if ((!pattern && s->event_id == EVENT_ID_INVALID) || bus_index_add(s) != 0) {
+        pthread_mutex_unlock(&sub_mutex);
+        bus_sub_free(s);
+        return BUS_SUB_ERR_ALLOC_FAILED;
+    }
     s->next = g_head;
     g_head = s;
     pthread_mutex_unlock(&sub_mutex);
 
+    if (opts && opts->last_value && !pattern) bus_lvc_replay(s);
+
     if (g_gateway_connected_flag) {
         char msg[GATEWAY_DTLS_MSG_LEN];
         snprintf(msg, GATEWAY_DTLS_MSG_LEN, "[subscribe] %d [%s]", plugin_id, event);
@@ -146,60 +987,527 @@ int bus_subscribe(plugin_id_t plugin_id, const char *event, bus_cb_t cb, void *u
     return 0;
 }
 
+typedef struct {
+    plugin_id_t plugin_id;
+    const char *event;          /**< NULL matches every subscription of the plugin */
+    bus_cb_t cb;
+    void *user;
+} bus_unsub_match_t;
+
+static inline int bus_unsub_matches(const sub_t *sub, const bus_unsub_match_t *match)
+{
+    if (sub->plugin_id != match->plugin_id) return 0;
+    if (!match->event) return 1;
+    return sub->cb == match->cb && sub->user == match->user && strcmp(sub->event, match->event) == 0;
+}
 
-static int enqueue_task(bus_task_t task)
+// Drops our references to the removed subscriptions once their deliveries are over
+static void bus_unsubscribe_wait(sub_t *removed)
 {
-    pthread_mutex_lock(&g_task_event_bus_queue_t.mutex);
+    const uint64_t deadline = bus_now_ns() + (uint64_t)BUS_UNSUBSCRIBE_WAIT_MS * 1000000ULL;
+    const struct timespec pause = { .tv_sec = 0, .tv_nsec = 1000000L };
+    int expired = 0;
+
+    while (removed) {
+        sub_t *sub = removed;
+        removed = sub->next;
+
+        // A callback removing its own subscription would wait for itself
+        while (!t_bus_in_callback && !expired && atomic_load_explicit(&sub->refs, memory_order_acquire) > 1) {
+            if (bus_now_ns() > deadline) {
+                core_log_warn("Event bus: unsubscribe gave up waiting for callbacks of [%s]", sub->event);
+                expired = 1;
+                break;
+            }
+
+            // Lets the index reference go once publishers left the epoch that saw it
+            bus_epoch_collect();
+            nanosleep(&pause, NULL);
+        }
 
-    while (g_task_event_bus_queue_t.count == MAX_TASKS && !g_bus_shut_down) {
-        pthread_cond_wait(&g_task_event_bus_queue_t.cond_not_full,
-                          &g_task_event_bus_queue_t.mutex);
+        bus_sub_release(sub);
     }
+}
 
-    if (g_bus_shut_down) {
-        pthread_mutex_unlock(&g_task_event_bus_queue_t.mutex);
-        return -1;
+// Returns how many subscriptions were removed, *err is set when a match could not be
+static int bus_unsubscribe_matching(const bus_unsub_match_t *match, int *err)
+{
+    sub_t *removed = NULL;
+    int count = 0;
+
+    *err = 0;
+
+    pthread_mutex_lock(&sub_mutex);
+
+    sub_t **link = &g_head;
+    while (*link) {
+        sub_t *sub = *link;
+        if (!bus_unsub_matches(sub, match)) {
+            link = &sub->next;
+            continue;
+        }
+
+        if (bus_index_remove(sub) != 0) {
+            *err = BUS_SUB_ERR_ALLOC_FAILED;
+            link = &sub->next;
+            continue;
+        }
+        *link = sub->next;
+
+        atomic_store_explicit(&sub->dead, 1, memory_order_release);
+        // One reference for the wait below, the index one goes after a grace period
+        bus_sub_hold(sub);
+        bus_epoch_retire(sub, bus_sub_retired);
+
+        sub->next = removed;
+        removed = sub;
+        count++;
     }
 
-    g_task_event_bus_queue_t.tasks[g_task_event_bus_queue_t.tail] = task;
-    g_task_event_bus_queue_t.tail = (g_task_event_bus_queue_t.tail + 1) % MAX_TASKS;
-    g_task_event_bus_queue_t.count++;
+    pthread_mutex_unlock(&sub_mutex);
+
+    bus_unsubscribe_wait(removed);
 
-    pthread_cond_signal(&g_task_event_bus_queue_t.cond_not_empty);
-    pthread_mutex_unlock(&g_task_event_bus_queue_t.mutex);
-    return 0;
+    if (count && g_gateway_connected_flag) {
+        char msg[GATEWAY_DTLS_MSG_LEN];
+        snprintf(msg, GATEWAY_DTLS_MSG_LEN, "[unsubscribe] %d [%s]", match->plugin_id,
+            match->event ? match->event : "*");
+        gateway_msg_send(self_api_type, msg);
+    }
+
+    return count;
 }
 
-int bus_publish(const plugin_id_t plugin_id, const char *event, const void *data, size_t len)
+int bus_unsubscribe(plugin_id_t plugin_id, const char *event, bus_cb_t cb, void *user)
 {
-    if (plugin_id == PLUGIN_ID_INVALID) return BUS_PUBLISH_ERR_INVALID_PLUGIN_ID;
-    if (!data) return BUS_PUBLISH_ERR_INVALID_DATA;
-    if (len == 0) return BUS_PUBLISH_ERR_INVALID_LENGTH;
+    if (!event) return BUS_SUB_ERR_INVALID_EVENT;
+    if (!cb) return BUS_SUB_ERR_INVALID_CB;
 
-    pthread_mutex_lock(&sub_mutex);
+    const bus_unsub_match_t match = { .plugin_id = plugin_id, .event = event, .cb = cb, .user = user };
 
-    const sub_t *it = g_head;
-    while (it) {
-        if (it->plugin_id == plugin_id && optimized_strcmp(it->event, event) == 0) {
-            bus_task_t task;
-
-            task.sub_ptr = (sub_t *)it;
-            task.data = malloc(len);
-            if (!task.data) {
-                pthread_mutex_unlock(&sub_mutex);
-                return BUS_PUBLISH_ERR_MALLOC_FAILED;
+    int err;
+    if (bus_unsubscribe_matching(&match, &err) > 0) return 0;
+    return err ? err : BUS_SUB_ERR_NOT_FOUND;
+}
+
+int bus_unsubscribe_plugin(plugin_id_t plugin_id)
+{
+    if (plugin_id == PLUGIN_ID_INVALID) return -1;
+
+    const bus_unsub_match_t match = { .plugin_id = plugin_id, .event = NULL, .cb = NULL, .user = NULL };
+
+    int err;
+    int count = bus_unsubscribe_matching(&match, &err);
+    return err ? -1 : count;
+}
+
+// Conflated and journaled topics keep publishes even before anyone subscribed
+static inline int bus_topic_retained_locked(event_id_t topic)
+{
+    const bus_topic_policy_t *topic_policy = bus_topic_policy_locked(topic);
+    return topic_policy && (topic_policy->conflated || topic_policy->journaled);
+}
+
+// Consumes the caller's single reference to payload, inside the index read section, list may be empty.
+// first comes from bus_list_first_wanted
+static int bus_dispatch_locked(plugin_id_t plugin_id, const bus_sub_list_t *list, size_t first, event_id_t topic,
+    bus_payload_t *payload, const bus_pub_opts_t *opts, bus_inline_set_t *inl, bus_park_set_t *park)
+{
+    const size_t end = list ? list->count : 0;
+    const size_t count = end - first;
+    const bus_topic_policy_t *topic_policy = bus_topic_policy_locked(topic);
+    const int conflated = topic_policy && topic_policy->conflated;
+    const bus_priority_t priority = opts ? opts->priority : BUS_PRIORITY_INHERIT;
+    int64_t timeout_ns;
+    const bus_backpressure_t policy = bus_policy_resolve(topic, opts, &timeout_ns);
+    const uint64_t key = opts ? opts->key : 0;
+    int ret = 0;
+
+    atomic_store_explicit(&payload->refs, (unsigned int)(count + conflated), memory_order_relaxed);
+    payload->publish_ns = bus_now_ns();
+    payload->topic = topic;
+
+    if (UNLIKELY(topic_policy && topic_policy->journaled)) {
+        bus_journal_append(plugin_id, topic, bus_topic_name_locked(topic), key, payload->data, payload->len);
+    }
+    if (count + (size_t)conflated == 0) {
+        bus_slab_free(payload);
+        return 0;
+    }
+
+    if (conflated) bus_lvc_store(plugin_id, topic, key, payload);
+
+    for (size_t i = first; i < end; i++) {
+        if (i != first && UNLIKELY(!bus_sub_wants(list->subs[i], payload->data, payload->len))) {
+            bus_payload_release(payload);
+            continue;
+        }
+
+        bus_sub_hold(list->subs[i]);
+        if (bus_inline_take(inl, list->subs[i], payload)) continue;
+
+        bus_task_t task = {
+            .payload = payload,
+            .sub_ptr = list->subs[i],
+            .lane = priority == BUS_PRIORITY_INHERIT ? list->subs[i]->lane : bus_lane_of(priority),
+            .flags = 0
+        };
+
+        // Ordered subscriptions wait on their mailbox, which never blocks
+        int err = policy == BUS_BACKPRESSURE_BLOCK && !task.sub_ptr->ordered
+            ? bus_park_submit(park, &task, timeout_ns)
+            : bus_submit(&task, policy, timeout_ns, key);
+        if (err && !ret) ret = err;
+    }
+
+    return ret;
+}
+
+event_id_t bus_topic_id(const char *event)
+{
+    return bus_topic_intern(event);
+}
+
+// Wildcard subscribers may want names nobody subscribed to exactly, those are matched but never interned
+static inline int bus_topic_routable(event_id_t topic, const char *name)
+{
+    return topic != EVENT_ID_INVALID || (name && bus_index_has_patterns());
+}
+
+// Inside the index read section, an uninterned name gets its wildcard matches
+static const bus_sub_list_t *bus_route_locked(plugin_id_t plugin_id, event_id_t topic, const char *name)
+{
+    if (topic != EVENT_ID_INVALID) return bus_index_find(plugin_id, topic);
+    return bus_index_find_name(plugin_id, name);
+}
+
+// topic is EVENT_ID_INVALID for a name nobody interned
+static int bus_publish_topic(const plugin_id_t plugin_id, event_id_t topic, const char *name, const void *data,
+    size_t len, const bus_pub_opts_t *opts)
+{
+    if (UNLIKELY(plugin_id == PLUGIN_ID_INVALID)) return BUS_PUBLISH_ERR_INVALID_PLUGIN_ID;
+    if (UNLIKELY(!data)) return BUS_PUBLISH_ERR_INVALID_DATA;
+    if (UNLIKELY(len == 0)) return BUS_PUBLISH_ERR_INVALID_LENGTH;
+
+    const int quota = bus_quota_check(plugin_id, topic);
+    if (UNLIKELY(quota != 0)) return quota < 0 ? 0 : quota;
+
+    bus_inline_set_t inl;
+    inl.count = 0;
+    bus_park_set_t park = { 0 };
+    bus_payload_t *payload;
+    int ret;
+
+    bus_index_enter();
+
+    const bus_sub_list_t *list = bus_route_locked(plugin_id, topic, name);
+    const int retained = bus_topic_retained_locked(topic);
+    const size_t first = bus_list_first_wanted(list, data, len);
+
+    if ((!list || list->count == 0) && !retained) {
+        ret = BUS_PUBLISH_ERR_EVENT_NOT_FOUND;
+    } else if (!retained && UNLIKELY(first == list->count)) {
+        ret = 0;
+    } else if (!(payload = bus_payload_alloc(len, BUS_PAYLOAD_SHARED))) {
+        ret = BUS_PUBLISH_ERR_MALLOC_FAILED;
+    } else {
+        // One copy for every subscriber, each task holds a reference
+        memcpy(payload->data, data, len);
+        ret = bus_dispatch_locked(plugin_id, list, first, topic, payload, opts, &inl, &park);
+    }
+
+    bus_index_exit();
+
+    const int parked = bus_park_run(&park);
+    bus_inline_run(&inl);
+    return ret ? ret : parked;
+}
+
+int bus_publish_id(const plugin_id_t plugin_id, event_id_t topic, const void *data, size_t len)
+{
+    return bus_publish_topic(plugin_id, topic, NULL, data, len, NULL);
+}
+
+typedef struct {
+    const char *event;                  // NULL when addressed by topic id
+    event_id_t topic;
+    const bus_sub_list_t *list;
+} bus_batch_route_t;
+
+typedef struct {
+    bus_batch_route_t routes[BUS_BATCH_MAX_ROUTES];
+    size_t count;
+    size_t next;                        // replaced once all are taken
+} bus_batch_routes_t;
+
+// Inside the index read section, each distinct topic of a batch is resolved once
+static const bus_batch_route_t *bus_batch_route_locked(plugin_id_t plugin_id, bus_batch_routes_t *cache,
+    const bus_msg_t *msg)
+{
+    // An uninterned name has no id of its own, its wildcard matches are per name
+    const char *event = msg->topic == EVENT_ID_INVALID ? msg->event : NULL;
+
+    for (size_t i = 0; i < cache->count; i++) {
+        const bus_batch_route_t *route = &cache->routes[i];
+        if (route->event == event && (event || route->topic == msg->topic)) return route;
+    }
+
+    bus_batch_route_t *route;
+    if (cache->count < BUS_BATCH_MAX_ROUTES) {
+        route = &cache->routes[cache->count++];
+    } else {
+        route = &cache->routes[cache->next];
+        cache->next = (cache->next + 1) % BUS_BATCH_MAX_ROUTES;
+    }
+
+    route->event = event;
+    route->topic = event ? bus_topic_lookup_locked(event) : msg->topic;
+    route->list = bus_route_locked(plugin_id, route->topic, event);
+    return route;
+}
+
+// Inside the index read section, what finds no room waits in park
+static int bus_batch_flush(const bus_task_t *tasks, size_t n, bus_park_set_t *park)
+{
+    const size_t queued = park->count ? 0 : bus_pool_submit_batch(tasks, n);
+    int ret = 0;
+
+    for (size_t i = queued; i < n; i++) {
+        const int err = bus_park_add(park, &tasks[i], -1);
+        if (err && !ret) ret = err;
+    }
+    return ret;
+}
+
+int bus_publish_batch(const plugin_id_t plugin_id, const bus_msg_t *msgs, size_t n)
+{
+    if (UNLIKELY(plugin_id == PLUGIN_ID_INVALID)) return BUS_PUBLISH_ERR_INVALID_PLUGIN_ID;
+    if (UNLIKELY(!msgs)) return BUS_PUBLISH_ERR_INVALID_DATA;
+    if (UNLIKELY(n == 0)) return BUS_PUBLISH_ERR_INVALID_LENGTH;
+
+    bus_task_t tasks[BUS_BATCH_MAX_TASKS];
+    size_t pending = 0;
+    bus_inline_set_t inl;
+    inl.count = 0;
+    bus_park_set_t park = { 0 };
+    int ret = 0;
+
+    // Bursts usually interleave a handful of topics
+    bus_batch_routes_t routes;
+    routes.count = 0;
+    routes.next = 0;
+
+    bus_index_enter();
+
+    for (size_t i = 0; i < n; i++) {
+        const bus_msg_t *msg = &msgs[i];
+        int err = 0;
+
+        if (UNLIKELY(!msg->data)) err = BUS_PUBLISH_ERR_INVALID_DATA;
+        else if (UNLIKELY(msg->len == 0)) err = BUS_PUBLISH_ERR_INVALID_LENGTH;
+
+        const bus_batch_route_t *route = err ? NULL : bus_batch_route_locked(plugin_id, &routes, msg);
+        event_id_t topic = route ? route->topic : EVENT_ID_INVALID;
+
+        if (!err && bus_topic_routable(topic, msg->topic == EVENT_ID_INVALID ? msg->event : NULL)) {
+            uint64_t delay_ns;
+            const int verdict = bus_quota_admit(plugin_id, topic, bus_quota_may_delay(), &delay_ns);
+
+            if (UNLIKELY(delay_ns)) {
+                // Sleep outside the read section, the lists picked up so far may go stale meanwhile
+                if (pending) {
+                    const int flushed = bus_batch_flush(tasks, pending, &park);
+                    if (flushed && !ret) ret = flushed;
+                    pending = 0;
+                }
+                bus_index_exit();
+                const int parked = bus_park_run(&park);
+                if (parked && !ret) ret = parked;
+                bus_sleep_ns(delay_ns);
+                bus_index_enter();
+                routes.count = 0;
+                routes.next = 0;
+                route = bus_batch_route_locked(plugin_id, &routes, msg);
+                topic = route->topic;
             }
-            memcpy(task.data, data, len);
-            task.len = len;
 
-            enqueue_task(task);
-            pthread_mutex_unlock(&sub_mutex);
-            return 0; // Success
+            if (verdict == BUS_QUOTA_DROPPED) continue;
+            if (verdict == BUS_QUOTA_REJECTED) err = BUS_PUBLISH_ERR_RATE_LIMITED;
+        }
+
+        const bus_sub_list_t *list = err ? NULL : route->list;
+        if (!err && (!list || list->count == 0) && !bus_topic_retained_locked(topic))
+            err = BUS_PUBLISH_ERR_EVENT_NOT_FOUND;
+        const size_t first = err ? 0 : bus_list_first_wanted(list, msg->data, msg->len);
+        if (!err && !bus_topic_retained_locked(topic) && UNLIKELY(first == list->count))
+            continue;
+
+        bus_payload_t *payload = NULL;
+        if (!err) {
+            payload = bus_payload_alloc(msg->len, BUS_PAYLOAD_SHARED);
+            if (UNLIKELY(!payload)) err = BUS_PUBLISH_ERR_MALLOC_FAILED;
+        }
+
+        if (err) {
+            if (!ret) ret = err;
+            continue;
+        }
+
+        memcpy(payload->data, msg->data, msg->len);
+
+        int64_t timeout_ns;
+        const bus_topic_policy_t *topic_policy = bus_topic_policy_locked(topic);
+        if (bus_policy_resolve(topic, NULL, &timeout_ns) != BUS_BACKPRESSURE_BLOCK || timeout_ns >= 0
+            || (topic_policy && topic_policy->journaled)) {
+            // Non-blocking and journaled topics go through their policy one delivery at a time
+            if (pending) {
+                const int flushed = bus_batch_flush(tasks, pending, &park);
+                if (flushed && !ret) ret = flushed;
+                pending = 0;
+            }
+
+            err = bus_dispatch_locked(plugin_id, list, first, topic, payload, NULL, &inl, &park);
+            if (err && !ret) ret = err;
+            continue;
+        }
+
+        atomic_store_explicit(&payload->refs, (unsigned int)(list->count - first), memory_order_relaxed);
+        payload->publish_ns = bus_now_ns();
+        payload->topic = topic;
+
+        for (size_t s = first; s < list->count; s++) {
+            if (pending == BUS_BATCH_MAX_TASKS) {
+                const int flushed = bus_batch_flush(tasks, pending, &park);
+                if (flushed && !ret) ret = flushed;
+                pending = 0;
+            }
+
+            if (s != first && UNLIKELY(!bus_sub_wants(list->subs[s], payload->data, payload->len))) {
+                bus_payload_release(payload);
+                continue;
+            }
+
+            bus_sub_hold(list->subs[s]);
+            if (bus_inline_take(&inl, list->subs[s], payload)) continue;
+
+            tasks[pending].payload = payload;
+            tasks[pending].sub_ptr = list->subs[s];
+            tasks[pending].lane = list->subs[s]->lane;
+            tasks[pending].flags = 0;
+
+            if (list->subs[s]->ordered) {
+                bus_mailbox_submit(&tasks[pending], BUS_BACKPRESSURE_BLOCK, 0);
+                continue;
+            }
+            pending++;
         }
-        it = it->next;
     }
 
-    pthread_mutex_unlock(&sub_mutex);
+    if (pending) {
+        const int flushed = bus_batch_flush(tasks, pending, &park);
+        if (flushed && !ret) ret = flushed;
+    }
+
+    bus_index_exit();
+
+    const int parked = bus_park_run(&park);
+    if (parked && !ret) ret = parked;
+    bus_inline_run(&inl);
+    return ret;
+}
+
+void *bus_loan(size_t size)
+{
+    if (UNLIKELY(size == 0)) return NULL;
+
+    bus_payload_t *payload = bus_payload_alloc(size, BUS_PAYLOAD_LOANED);
+    return payload ? payload->data : NULL;
+}
+
+void bus_loan_discard(void *buf)
+{
+    if (UNLIKELY(!buf)) return;
+
+    bus_payload_t *payload = bus_payload_of(buf);
+    if (UNLIKELY(payload->state != BUS_PAYLOAD_LOANED)) return;
+
+    payload->state = BUS_PAYLOAD_SHARED;
+    bus_payload_release(payload);
+}
+
+int bus_publish_loaned(const plugin_id_t plugin_id, const char *event, void *buf, size_t len)
+{
+    if (UNLIKELY(!buf)) return BUS_PUBLISH_ERR_INVALID_DATA;
+
+    bus_payload_t *payload = bus_payload_of(buf);
+    if (UNLIKELY(payload->state != BUS_PAYLOAD_LOANED)) return BUS_PUBLISH_ERR_INVALID_LOAN;
+
+    if (UNLIKELY(plugin_id == PLUGIN_ID_INVALID)) {
+        bus_loan_discard(buf);
+        return BUS_PUBLISH_ERR_INVALID_PLUGIN_ID;
+    }
+
+    if (UNLIKELY(len == 0 || len > payload->len)) {
+        bus_loan_discard(buf);
+        return BUS_PUBLISH_ERR_INVALID_LENGTH;
+    }
+
+    const event_id_t topic = bus_topic_lookup(event);
+
+    const int quota = bus_topic_routable(topic, event) ? bus_quota_check(plugin_id, topic) : 0;
+    if (UNLIKELY(quota != 0)) {
+        bus_loan_discard(buf);
+        return quota < 0 ? 0 : quota;
+    }
+
+    bus_index_enter();
+
+    const bus_sub_list_t *list = bus_route_locked(plugin_id, topic, event);
+    if ((!list || list->count == 0) && !bus_topic_retained_locked(topic)) {
+        bus_index_exit();
+        bus_loan_discard(buf);
+        return BUS_PUBLISH_ERR_EVENT_NOT_FOUND;
+    }
+    const size_t first = bus_list_first_wanted(list, buf, len);
+    if (!bus_topic_retained_locked(topic) && UNLIKELY(first == list->count)) {
+        bus_index_exit();
+        bus_loan_discard(buf);
+        return 0;
+    }
+
+    // Ownership moves to the bus, the plugin must not touch buf anymore
+    payload->state = BUS_PAYLOAD_SHARED;
+    payload->len = len;
+
+    bus_inline_set_t inl;
+    inl.count = 0;
+    bus_park_set_t park = { 0 };
+    const int ret = bus_dispatch_locked(plugin_id, list, first, topic, payload, NULL, &inl, &park);
+
+    bus_index_exit();
+
+    const int parked = bus_park_run(&park);
+    bus_inline_run(&inl);
+    return ret ? ret : parked;
+}
+
+int bus_publish(const plugin_id_t plugin_id, const char *event, const void *data, size_t len)
+{
+    return bus_publish_ex(plugin_id, event, data, len, NULL);
+}
+
+int bus_publish_ex(const plugin_id_t plugin_id, const char *event, const void *data, size_t len,
+    const bus_pub_opts_t *opts)
+{
+    if (plugin_id == PLUGIN_ID_INVALID) return BUS_PUBLISH_ERR_INVALID_PLUGIN_ID;
+    if (!data) return BUS_PUBLISH_ERR_INVALID_DATA;
+    if (len == 0) return BUS_PUBLISH_ERR_INVALID_LENGTH;
+
+    const event_id_t topic = bus_topic_lookup(event);
+    if (bus_topic_routable(topic, event)) {
+        int ret = bus_publish_topic(plugin_id, topic, event, data, len, opts);
+        if (ret != BUS_PUBLISH_ERR_EVENT_NOT_FOUND) return ret;
+    }
 
     if (g_gateway_connected_flag) {
         char msg[GATEWAY_DTLS_MSG_LEN];
@@ -212,46 +1520,64 @@ int bus_publish(const plugin_id_t plugin_id, const char *event, const void *data
 __attribute__((noinline))
 void *bus_worker_thread(void *arg)
 {
-    (void)arg;
+    const size_t self = (size_t)(uintptr_t)arg;
 
     error_context_t local_ctx = event_bus_error_ctx;
     asm volatile("" : : "r"(&local_ctx) : "memory");
 
+    crash_guard_save_mask();
+
     while (1) {
-        pthread_mutex_lock(&g_task_event_bus_queue_t.mutex);
+        bus_task_t task;
 
-        while (g_task_event_bus_queue_t.count == 0 && !g_bus_shut_down) {
-            pthread_cond_wait(&g_task_event_bus_queue_t.cond_not_empty,
-                              &g_task_event_bus_queue_t.mutex);
-        }
+        // Drains remaining tasks before honouring shutdown or retiring
+        if (bus_pool_take(self, &task) != 0) break;
 
-        if (g_bus_shut_down && g_task_event_bus_queue_t.count == 0) {
-            pthread_mutex_unlock(&g_task_event_bus_queue_t.mutex);
-            break;
-        }
+        bus_payload_t *payload = task.payload;
+        if (UNLIKELY(task.flags & BUS_TASK_COALESCED)) payload = bus_coalesce_take(task.cell);
+        else if (UNLIKELY(task.flags & BUS_TASK_MAILBOX)) payload = bus_mailbox_pop(task.mailbox);
+
+        unsigned int burst = 0;
 
-        bus_task_t task = g_task_event_bus_queue_t.tasks[g_task_event_bus_queue_t.head];
+        while (payload) {
+            const uint64_t start = bus_now_ns();
+            const uint64_t wait = bus_pool_record_wait(self, task.lane, payload->publish_ns, start);
 
-        g_task_event_bus_queue_t.head = (g_task_event_bus_queue_t.head + 1) % MAX_TASKS;
-        g_task_event_bus_queue_t.count--;
+            t_bus_in_callback = 1;
 
-        pthread_cond_signal(&g_task_event_bus_queue_t.cond_not_full);
-        pthread_mutex_unlock(&g_task_event_bus_queue_t.mutex);
+            // Error handler
+            if (CRASH_GUARD_SETJMP(event_thread_jmp_env) != 0) {
+                // Logger add list enquque
+                add_event_bus_critical_error(task.sub_ptr->plugin_id, task.sub_ptr->event,
+                    CRITICAL_ERROR_QUEUE_SOURCE_EVENT_BUS, event_bus_error_ctx);
 
-        // Error handler
-        if (sigsetjmp(event_thread_jmp_env, 1) != 0) {
-            // Logger add list enquque
-            add_event_bus_critical_error(task.sub_ptr->plugin_id, task.sub_ptr->event,
-                CRITICAL_ERROR_QUEUE_SOURCE_EVENT_BUS, event_bus_error_ctx);
+                bus_payload_release(payload);
+            } else {
+                if (LIKELY(task.sub_ptr->cb && !bus_sub_dead(task.sub_ptr))) {
+                    task.sub_ptr->cb(payload->data, payload->len, task.sub_ptr->user);
+                    if (bus_sub_timed(task.sub_ptr)) bus_delivery_done(task.sub_ptr, self, payload->topic, wait, start);
+                }
 
-            free(task.data);
-        } else {
-            if (LIKELY(task.sub_ptr && task.sub_ptr->cb)) {
-                task.sub_ptr->cb(task.data, task.len, task.sub_ptr->user);
+                bus_payload_release(payload);
             }
 
-            free((void *)task.data);
+            t_bus_in_callback = 0;
+
+            if (LIKELY(!(task.flags & BUS_TASK_MAILBOX))) break;
+
+            // Hand the worker to other keys now and then, the mailbox stays scheduled with our reference.
+            // Never wait on our own pool, with no room we simply keep draining
+            if (++burst == BUS_MAILBOX_BURST) {
+                burst = 0;
+                if (bus_pool_submit(&task, 0) == 0) {
+                    task.sub_ptr = NULL;
+                    break;
+                }
+            }
+            payload = bus_mailbox_pop(task.mailbox);
         }
+
+        if (task.sub_ptr) bus_sub_release(task.sub_ptr);
     }
 
     return NULL;
@@ -259,10 +1585,12 @@ void *bus_worker_thread(void *arg)
 
 void event_bus_get_list(char *out_buf, size_t out_buf_size)
 {
-    sub_t *it = g_head;
-
     snprintf(out_buf, out_buf_size, "[on_data] [event_bus]\n[getall]\n");
 
+    // Unsubscribe frees entries, the list is only stable under the mutex
+    pthread_mutex_lock(&sub_mutex);
+    sub_t *it = g_head;
+
     while (it) {
         char temp[512];
         snprintf(temp, sizeof(temp), "[%s] %d\n", it->event, it->plugin_id);
@@ -276,4 +1604,83 @@ void event_bus_get_list(char *out_buf, size_t out_buf_size)
 
         it = it->next;
     }
+    pthread_mutex_unlock(&sub_mutex);
+}
+
+static void bus_stats_append(char *out_buf, size_t out_buf_size, const char *label, const char *name,
+    const bus_latency_stats_t *stats)
+{
+    const size_t used = strlen(out_buf);
+    if (used + 1 >= out_buf_size) return;
+
+    snprintf(out_buf + used, out_buf_size - used,
+        "[%s] %s wait count=%llu p50=%llu p99=%llu p999=%llu max=%llu exec p50=%llu p99=%llu p999=%llu max=%llu\n",
+        label, name, (unsigned long long)stats->wait.count,
+        (unsigned long long)stats->wait.p50_ns, (unsigned long long)stats->wait.p99_ns,
+        (unsigned long long)stats->wait.p999_ns, (unsigned long long)stats->wait.max_ns,
+        (unsigned long long)stats->exec.p50_ns, (unsigned long long)stats->exec.p99_ns,
+        (unsigned long long)stats->exec.p999_ns, (unsigned long long)stats->exec.max_ns);
+}
+
+void event_bus_get_stats(char *out_buf, size_t out_buf_size)
+{
+    static const char *lane_names[BUS_LANE_COUNT] = { "realtime", "normal", "bulk" };
+    bus_latency_stats_t stats;
+    char name[32];
+
+    snprintf(out_buf, out_buf_size, "[on_data] [event_bus]\n[stats]\n");
+
+    for (uint32_t lane = 0; lane < BUS_LANE_COUNT; lane++) {
+        bus_lane_stats_t lane_stats;
+        bus_pool_lane_stats(lane, &lane_stats);
+
+        const size_t used = strlen(out_buf);
+        if (used + 1 >= out_buf_size) return;
+        snprintf(out_buf + used, out_buf_size - used, "[lane] %s depth=%llu hwm=%llu delivered=%llu\n",
+            lane_names[lane], (unsigned long long)lane_stats.depth, (unsigned long long)lane_stats.depth_hwm,
+            (unsigned long long)lane_stats.delivered);
+    }
+
+    if (bus_stats_summary(BUS_STATS_ALL, 0, &stats) == 0) bus_stats_append(out_buf, out_buf_size, "all", "-", &stats);
+
+    const uint32_t topics = bus_stats_id_limit(BUS_STATS_TOPIC);
+    for (uint32_t topic = 1; topic < topics; topic++) {
+        const char *topic_name = bus_topic_name((event_id_t)topic);
+        if (topic_name && bus_stats_summary(BUS_STATS_TOPIC, topic, &stats) == 0)
+            bus_stats_append(out_buf, out_buf_size, "topic", topic_name, &stats);
+    }
+
+    const uint32_t plugins = bus_stats_id_limit(BUS_STATS_PLUGIN);
+    for (uint32_t plugin_id = 0; plugin_id < plugins; plugin_id++) {
+        if (bus_stats_summary(BUS_STATS_PLUGIN, plugin_id, &stats) != 0) continue;
+
+        snprintf(name, sizeof(name), "%u", plugin_id);
+        bus_stats_append(out_buf, out_buf_size, "plugin", name, &stats);
+    }
+
+    const uint32_t quota_plugins = bus_quota_id_limit();
+    for (uint32_t plugin_id = 1; plugin_id < quota_plugins; plugin_id++) {
+        bus_quota_stats_t quota;
+        if (bus_quota_stats((plugin_id_t)plugin_id, &quota) != 0) continue;
+
+        const size_t used = strlen(out_buf);
+        if (used + 1 >= out_buf_size) return;
+        snprintf(out_buf + used, out_buf_size - used, "[quota] %u rejected=%llu dropped=%llu delayed=%llu\n",
+            plugin_id, (unsigned long long)quota.rejected, (unsigned long long)quota.dropped,
+            (unsigned long long)quota.delayed);
+    }
+}
+
+int bus_get_latency_stats(bus_stats_scope_t scope, uint32_t id, bus_latency_stats_t *out)
+{
+    if (!out) return -1;
+    return bus_stats_summary(scope, id, out);
+}
+
+int bus_get_lane_stats(bus_priority_t priority, bus_lane_stats_t *out)
+{
+    if (!out || priority < BUS_PRIORITY_REALTIME || priority > BUS_PRIORITY_BULK) return -1;
+
+    bus_pool_lane_stats(bus_lane_of(priority), out);
+    return 0;
 }
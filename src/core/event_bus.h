@@ -2,57 +2,271 @@
 #define CORE_EVENT_BUST_H
 
 #include <stddef.h>
+#include <stdatomic.h>
 #include <pthread.h>
 #include <setjmp.h>
 #include <stdint.h>
+#include <time.h>
 #include "core_utils.h"
 
 #define MAX_INIT_EVENT_BUS_THREADS 5
-#define MAX_TASKS 100
+#define BUS_DEFAULT_QUEUE_CAPACITY 1024
+#define BUS_DEFAULT_GROW_DEPTH 64
+#define BUS_DEFAULT_IDLE_MS 5000
+#define BUS_BATCH_MAX_TASKS 64
+#define BUS_BATCH_MAX_ROUTES 8          // distinct topics a batch resolves once each
+#define BUS_LANE_COUNT 3                // realtime, normal, bulk
+#define BUS_DEFAULT_LANE_AGING 32
+#define BUS_INLINE_MAX 16               // inline deliveries deferred per publish call
+#define BUS_INLINE_PROMOTE_SAMPLES 64   // measured callbacks before promoting / demoting
+#define BUS_DEFAULT_JOURNAL_SEGMENT (4U * 1024 * 1024)
+#define BUS_DEFAULT_JOURNAL_RETAIN (64U * 1024 * 1024)
+#define BUS_UNSUBSCRIBE_WAIT_MS 5000    // bound on waiting for a removed subscription's callbacks
 
 extern __thread sigjmp_buf event_thread_jmp_env;
 #define EVENT_BUS_ERROR_MARKER 0xDEADBEEFCAFEBABEULL
 
 typedef void (*bus_cb_t)(const void* data, size_t len, void* user);
 
-struct p_thread_pool {
-    pthread_t **thread_ptrs;
-    size_t thread_max_count;
-    size_t thread_count;
-    uint64_t thread_map_mask;
-};
+static inline uint64_t bus_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
 
 typedef struct sub_s {
     char *event;
     plugin_id_t plugin_id;
     event_id_t event_id;
+    uint8_t lane;               /**< Priority lane, bus_priority_t - 1 */
+    uint8_t ordered;            /**< Delivered through per-key mailboxes */
+    _Atomic uint8_t direct;     /**< BUS_SUB_QUEUED / BUS_SUB_DIRECT / BUS_SUB_PROMOTED */
+    atomic_uint cb_avg_ns;      /**< Callback time moving average, auto-promotion only */
+    atomic_uint cb_samples;
+    atomic_uint refs;           /**< Index membership + every queued task or inline delivery */
+    _Atomic uint8_t dead;       /**< Unsubscribed, pending deliveries are dropped */
+    struct bus_filter_s *filter;    /**< Payload predicate checked at publish, NULL = everything */
     bus_cb_t cb;
     void *user;
     struct sub_s *next;
 } sub_t;
 
+#define BUS_SUB_QUEUED      0U  // handed to a worker
+#define BUS_SUB_DIRECT      1U  // inline on the publisher's thread, asked for at subscribe
+#define BUS_SUB_PROMOTED    2U  // inline because its callbacks measured fast
+
+/*
+ * Payload copied once per publish and shared by every fan-out task.
+ * The last worker to drop its reference frees it.
+ */
 typedef struct {
-    void *data;
+    atomic_uint refs;
+    uint32_t state;             /**< BUS_PAYLOAD_LOANED while a plugin owns it */
     size_t len;
+    uint64_t publish_ns;        /**< Monotonic publish time, feeds lane wait metrics */
+    event_id_t topic;           /**< Concrete topic it was published on, for per-topic stats */
+    _Alignas(16) unsigned char data[];
+} bus_payload_t;
+
+#define BUS_PAYLOAD_SHARED 0x53484152U
+#define BUS_PAYLOAD_LOANED 0x4C4F414EU
+
+struct bus_coalesce_cell_s;
+struct bus_mailbox_s;
+
+typedef struct {
+    union {
+        bus_payload_t *payload;
+        struct bus_coalesce_cell_s *cell;   /**< BUS_TASK_COALESCED: latest payload lives here */
+        struct bus_mailbox_s *mailbox;      /**< BUS_TASK_MAILBOX: drain the mailbox in order */
+    };
     sub_t *sub_ptr;
+    uint32_t lane;
+    uint32_t flags;
 } bus_task_t;
 
+#define BUS_TASK_COALESCED 0x1U
+#define BUS_TASK_MAILBOX   0x2U
+
 typedef struct {
-    bus_task_t tasks[MAX_TASKS];
+    bus_task_t *tasks;
+    size_t capacity;
     size_t head;
     size_t tail;
     size_t count;
     pthread_mutex_t mutex;
-    pthread_cond_t cond_not_empty;
-    pthread_cond_t cond_not_full;
 } task_event_bus_queue_t;
 
+typedef enum {
+    BUS_QUEUE_BACKEND_MUTEX,    /**< Circular array behind a single mutex */
+    BUS_QUEUE_BACKEND_RING      /**< Lock-free MPMC ring, futex parking */
+} bus_queue_backend_t;
+
+typedef struct {
+    bus_queue_backend_t queue_backend;
+    size_t queue_capacity;      /**< Per worker shard, rounded up to a power of two by the ring */
+    size_t min_workers;         /**< Always running */
+    size_t max_workers;         /**< 0 = one per online core, never below min_workers */
+    size_t grow_depth;          /**< Shard depth that spawns another worker */
+    uint32_t idle_ms;           /**< Idle time before a surplus worker retires */
+    int pin_cpus;               /**< Pin worker i to core i % ncpu (Linux only) */
+    uint32_t lane_aging;        /**< Higher lane pops before a waiting lower lane is served once */
+    uint32_t inline_promote_ns; /**< Run subscribers whose callbacks average below this inline, 0 = off */
+    int latency_stats;          /**< Record wait / callback histograms per worker, topic and plugin */
+    const char *journal_dir;    /**< Segment files of journaled topics, NULL = journaling off */
+    size_t journal_segment_bytes;
+    size_t journal_retain_bytes;    /**< Oldest segments are deleted beyond this, 0 = no limit */
+    uint32_t journal_retain_s;      /**< ... and once their newest record is older, 0 = no limit */
+} bus_config_t;
+
+#define BUS_CONFIG_DEFAULT { \
+        .queue_backend = BUS_QUEUE_BACKEND_RING, \
+        .queue_capacity = BUS_DEFAULT_QUEUE_CAPACITY, \
+        .min_workers = MAX_INIT_EVENT_BUS_THREADS, \
+        .max_workers = 0, \
+        .grow_depth = BUS_DEFAULT_GROW_DEPTH, \
+        .idle_ms = BUS_DEFAULT_IDLE_MS, \
+        .pin_cpus = 0, \
+        .lane_aging = BUS_DEFAULT_LANE_AGING, \
+        .inline_promote_ns = 0, \
+        .latency_stats = 1, \
+        .journal_dir = NULL, \
+        .journal_segment_bytes = BUS_DEFAULT_JOURNAL_SEGMENT, \
+        .journal_retain_bytes = BUS_DEFAULT_JOURNAL_RETAIN, \
+        .journal_retain_s = 0 \
+    }
+
+/*
+ * Per priority lane, aggregated over every worker.
+ * Wait is publish -> dequeue, so it covers the time spent queued.
+ */
+typedef struct {
+    uint64_t depth;
+    uint64_t depth_hwm;         /**< Deepest a single shard of the lane got */
+    uint64_t delivered;
+    uint64_t wait_avg_ns;
+    uint64_t wait_max_ns;
+} bus_lane_stats_t;
+
+typedef enum {
+    BUS_STATS_ALL,              /**< id ignored */
+    BUS_STATS_TOPIC,            /**< id is an event_id_t */
+    BUS_STATS_PLUGIN            /**< id is the subscriber's plugin_id_t */
+} bus_stats_scope_t;
+
+// Percentiles are bucket upper bounds, within 1/8 of the recorded value
+typedef struct {
+    uint64_t count;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} bus_latency_summary_t;
+
+typedef struct {
+    bus_latency_summary_t wait;     /**< publish -> callback start */
+    bus_latency_summary_t exec;     /**< callback run time */
+} bus_latency_stats_t;
+
+// Overload outcomes since bus_init, one counter per backpressure policy
+typedef struct {
+    uint64_t block_timeouts;
+    uint64_t failed;
+    uint64_t dropped_oldest;
+    uint64_t dropped_newest;
+    uint64_t coalesced;
+} bus_backpressure_stats_t;
+
+// Publishes refused by a plugin's quotas since bus_init, see bus_set_quota
+typedef struct {
+    uint64_t rejected;
+    uint64_t dropped;
+    uint64_t delayed;
+} bus_quota_stats_t;
+
 int bus_init(void);
+int bus_init_config(const bus_config_t *config);
 void bus_shutdown(void);
 int bus_subscribe(plugin_id_t plugin_id, const char *event, bus_cb_t cb, void *user);
+int bus_subscribe_ex(plugin_id_t plugin_id, const char *event, bus_cb_t cb, void *user, const bus_sub_opts_t *opts);
+/*
+ * Removes every subscription of plugin_id matching (event, cb, user) and
+ * returns BUS_SUB_ERR_NOT_FOUND when there was none. Deliveries still
+ * queued are dropped and no callback of it runs once this returns, unless
+ * called from a bus callback or a callback outlived BUS_UNSUBSCRIBE_WAIT_MS.
+ */
+int bus_unsubscribe(plugin_id_t plugin_id, const char *event, bus_cb_t cb, void *user);
+// Same for every subscription of the plugin, for unload / reload. Returns how many were removed, -1 on failure
+int bus_unsubscribe_plugin(plugin_id_t plugin_id);
 int bus_publish(const plugin_id_t plugin_id, const char *event, const void *data, size_t len);
+int bus_publish_ex(const plugin_id_t plugin_id, const char *event, const void *data, size_t len,
+    const bus_pub_opts_t *opts);
+
+// Same as bus_config_t.inline_promote_ns, at runtime
+void bus_set_inline_promotion(uint32_t threshold_ns);
+
+/*
+ * Default policy for every publish on the topic, bus_pub_opts_t overrides it.
+ * Like every setter below it never interns the name: unless somebody
+ * subscribed to it or took its bus_topic_id it returns BUS_SUB_ERR_NOT_FOUND.
+ * The first plugin to change a topic's policy owns it, any other plugin gets
+ * BUS_SUB_ERR_NOT_OWNER. PLUGIN_ID_INVALID is the core, which may change all.
+ */
+int bus_topic_set_backpressure(plugin_id_t plugin_id, const char *event, bus_backpressure_t policy,
+                               uint32_t block_timeout_ms);
+// Keeps one slot per (topic, key): pending updates are overwritten, see bus_sub_opts_t.last_value
+int bus_topic_set_conflated(plugin_id_t plugin_id, const char *event, int conflated);
+// Appends every publish on the topic to the journal, needs bus_config_t.journal_dir
+int bus_topic_set_journal(plugin_id_t plugin_id, const char *event, int journaled);
+
+/*
+ * Streams the journaled publishes of (plugin_id, event) with seq >= from_seq,
+ * oldest first and zero-copy, e.g. to catch up a rebooted plugin. Returns
+ * the number of records handed to cb or -1 when journaling is off.
+ */
+int64_t bus_replay(plugin_id_t plugin_id, const char *event, uint64_t from_seq, bus_replay_cb_t cb, void *user);
+
+/*
+ * Token-bucket limit on the publishes of plugin_id, on event only or on all
+ * of them when event is NULL; a publish has to pass both. quota->rate = 0
+ * lifts the limit. Checked before anything is copied, see bus_quota_t.
+ * A topic nobody interned yet gets BUS_SUB_ERR_NOT_FOUND.
+ */
+int bus_set_quota(plugin_id_t plugin_id, const char *event, const bus_quota_t *quota);
+// returns -1 when the plugin never had a quota
+int bus_get_quota_stats(plugin_id_t plugin_id, bus_quota_stats_t *out);
+// The calling thread runs core callbacks (e.g. scheduler timers), BUS_QUOTA_DELAY rejects there too
+void bus_mark_core_thread(void);
+
+// Interns the event name, ids stay valid for the lifetime of the bus
+event_id_t bus_topic_id(const char *event);
+int bus_publish_id(const plugin_id_t plugin_id, event_id_t topic, const void *data, size_t len);
+
+/*
+ * Publishes n messages in one index read section and one worker wakeup.
+ * Up to BUS_BATCH_MAX_ROUTES distinct topics are resolved once each.
+ * Messages that fail are skipped, the first error code is returned.
+ */
+int bus_publish_batch(const plugin_id_t plugin_id, const bus_msg_t *msgs, size_t n);
+
+/*
+ * Zero-copy publish: the producer writes straight into a core-owned
+ * buffer which is handed to callbacks as is. bus_publish_loaned always
+ * consumes a valid loan, even when it returns an error.
+ */
+void *bus_loan(size_t size);
+int bus_publish_loaned(const plugin_id_t plugin_id, const char *event, void *buf, size_t len);
+void bus_loan_discard(void *buf);
 
 void event_bus_get_list(char *out_buf, size_t out_buf_size);
+// Lane depths and latency percentiles as text, for the gateway
+void event_bus_get_stats(char *out_buf, size_t out_buf_size);
+int bus_get_lane_stats(bus_priority_t priority, bus_lane_stats_t *out);
+// returns -1 when nothing was recorded for the scope / id
+int bus_get_latency_stats(bus_stats_scope_t scope, uint32_t id, bus_latency_stats_t *out);
+void bus_get_backpressure_stats(bus_backpressure_stats_t *out);
 
 typedef int (*api_bus_subscribe_fn)(const char* event, bus_cb_t cb, void* user);
 
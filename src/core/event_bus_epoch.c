@@ -0,0 +1,185 @@
+#include "event_bus_epoch.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "platform.h"
+
+#define EPOCH_ACTIVE    1U      // low bit of a record's state, the epoch sits above it
+#define EPOCH_LIMBO     3       // retired in e, safe in e + 2
+
+typedef struct bus_epoch_rec_s {
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint64_t state;
+    atomic_int used;            /**< Owned by a live thread */
+    struct bus_epoch_rec_s *next;
+} bus_epoch_rec_t;
+
+typedef struct bus_epoch_node_s {
+    void *ptr;
+    bus_epoch_free_fn free_fn;
+    struct bus_epoch_node_s *next;
+} bus_epoch_node_t;
+
+static _Atomic uint64_t g_epoch = 0;
+// Records are never freed, an exiting thread's record is reused by the next one
+static _Atomic(bus_epoch_rec_t *) g_records = NULL;
+
+static pthread_mutex_t g_limbo_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bus_epoch_node_t *g_limbo[EPOCH_LIMBO];
+
+static pthread_key_t g_rec_key;
+static pthread_once_t g_rec_once = PTHREAD_ONCE_INIT;
+
+static __thread bus_epoch_rec_t *t_rec = NULL;
+static __thread unsigned int t_depth = 0;
+
+static void epoch_rec_release(void *arg)
+{
+    bus_epoch_rec_t *rec = arg;
+    atomic_store_explicit(&rec->state, 0, memory_order_release);
+    atomic_store_explicit(&rec->used, 0, memory_order_release);
+}
+
+static void epoch_key_init(void)
+{
+    pthread_key_create(&g_rec_key, epoch_rec_release);
+}
+
+static bus_epoch_rec_t *epoch_register(void)
+{
+    pthread_once(&g_rec_once, epoch_key_init);
+
+    bus_epoch_rec_t *rec;
+    for (rec = atomic_load_explicit(&g_records, memory_order_acquire); rec; rec = rec->next) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&rec->used, &expected, 1)) break;
+    }
+
+    if (!rec) {
+        rec = aligned_alloc(CACHE_LINE_SIZE, sizeof(bus_epoch_rec_t));
+        if (!rec) abort();
+
+        atomic_init(&rec->state, 0);
+        atomic_init(&rec->used, 1);
+        rec->next = atomic_load_explicit(&g_records, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&g_records, &rec->next, rec,
+                memory_order_release, memory_order_relaxed)) {}
+    }
+
+    pthread_setspecific(g_rec_key, rec);
+    t_rec = rec;
+    return rec;
+}
+
+void bus_epoch_enter(void)
+{
+    if (t_depth++) return;
+
+    bus_epoch_rec_t *rec = LIKELY(t_rec != NULL) ? t_rec : epoch_register();
+    const uint64_t epoch = atomic_load_explicit(&g_epoch, memory_order_relaxed);
+
+    // The fence orders the announcement before any pointer the section loads
+    atomic_store_explicit(&rec->state, (epoch << 1) | EPOCH_ACTIVE, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+void bus_epoch_exit(void)
+{
+    if (--t_depth) return;
+    atomic_store_explicit(&t_rec->state, 0, memory_order_release);
+}
+
+static void epoch_free_list(bus_epoch_node_t *node)
+{
+    while (node) {
+        bus_epoch_node_t *next = node->next;
+        node->free_fn(node->ptr);
+        free(node);
+        node = next;
+    }
+}
+
+// g_limbo_mutex held, returns the list that became safe to free
+static bus_epoch_node_t *epoch_try_advance_locked(void)
+{
+    const uint64_t epoch = atomic_load_explicit(&g_epoch, memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_seq_cst);
+    for (bus_epoch_rec_t *rec = atomic_load_explicit(&g_records, memory_order_acquire); rec; rec = rec->next) {
+        const uint64_t state = atomic_load_explicit(&rec->state, memory_order_acquire);
+        if ((state & EPOCH_ACTIVE) && (state >> 1) != epoch) return NULL;
+    }
+
+    atomic_store_explicit(&g_epoch, epoch + 1, memory_order_release);
+
+    // Retired two epochs ago, every reader still inside entered after it was unlinked
+    const size_t safe = (size_t)((epoch + 1) % EPOCH_LIMBO);
+    bus_epoch_node_t *list = g_limbo[safe];
+    g_limbo[safe] = NULL;
+    return list;
+}
+
+void bus_epoch_retire(void *ptr, bus_epoch_free_fn free_fn)
+{
+    if (!ptr) return;
+
+    bus_epoch_node_t *node = malloc(sizeof(bus_epoch_node_t));
+
+    pthread_mutex_lock(&g_limbo_mutex);
+
+    if (UNLIKELY(!node)) {
+        // No room to defer it, leaking beats a use after free
+        pthread_mutex_unlock(&g_limbo_mutex);
+        return;
+    }
+
+    // The caller's unlink must be visible before the epoch it is filed under
+    atomic_thread_fence(memory_order_seq_cst);
+    const uint64_t epoch = atomic_load_explicit(&g_epoch, memory_order_relaxed);
+    node->ptr = ptr;
+    node->free_fn = free_fn;
+    node->next = g_limbo[epoch % EPOCH_LIMBO];
+    g_limbo[epoch % EPOCH_LIMBO] = node;
+
+    bus_epoch_node_t *safe = epoch_try_advance_locked();
+    pthread_mutex_unlock(&g_limbo_mutex);
+
+    // Free functions may take other locks, never under ours
+    epoch_free_list(safe);
+}
+
+void bus_epoch_collect(void)
+{
+    pthread_mutex_lock(&g_limbo_mutex);
+    bus_epoch_node_t *safe = epoch_try_advance_locked();
+    pthread_mutex_unlock(&g_limbo_mutex);
+
+    epoch_free_list(safe);
+}
+
+void bus_epoch_drain(void)
+{
+    for (;;) {
+        bus_epoch_node_t *all = NULL;
+
+        pthread_mutex_lock(&g_limbo_mutex);
+        for (size_t i = 0; i < EPOCH_LIMBO; i++) {
+            bus_epoch_node_t *node = g_limbo[i];
+            g_limbo[i] = NULL;
+
+            while (node) {
+                bus_epoch_node_t *next = node->next;
+                node->next = all;
+                all = node;
+                node = next;
+            }
+        }
+        pthread_mutex_unlock(&g_limbo_mutex);
+
+        if (!all) return;
+        // A free function may retire more
+        epoch_free_list(all);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef CORECDTL_EVENT_BUS_EPOCH_H
+#define CORECDTL_EVENT_BUS_EPOCH_H
+
+/*
+ * Epoch based reclamation for structures publishers read without locks.
+ *
+ * Readers bracket their accesses with enter / exit: one store and a fence
+ * on a per-thread record, nesting is free. Writers unlink an object first
+ * and hand it to retire; it is freed once the global epoch moved twice,
+ * i.e. every reader that could have seen it has left. Reclamation never
+ * waits for readers, so a reader may take a writer's lock.
+ */
+typedef void (*bus_epoch_free_fn)(void *ptr);
+
+void bus_epoch_enter(void);
+void bus_epoch_exit(void);
+
+void bus_epoch_retire(void *ptr, bus_epoch_free_fn free_fn);
+// Advances the epoch when every active reader caught up, frees what became safe
+void bus_epoch_collect(void);
+// Frees everything still retired, only when no reader can be active (shutdown)
+void bus_epoch_drain(void);
+
+#endif //CORECDTL_EVENT_BUS_EPOCH_H
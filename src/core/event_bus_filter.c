@@ -0,0 +1,104 @@
+#include "event_bus_filter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../jit/llvm_jit.h"
+
+_Static_assert(sizeof(jit_filter_clause_t) == sizeof(bus_filter_clause_t), "JIT filter clause layout");
+_Static_assert(offsetof(jit_filter_clause_t, value) == offsetof(bus_filter_clause_t, value), "JIT filter clause layout");
+
+static inline uint64_t filter_width_mask(uint8_t width)
+{
+    return width == 8 ? UINT64_MAX : (1ULL << (width * 8)) - 1;
+}
+
+static inline uint64_t filter_load(const unsigned char *p, uint8_t width)
+{
+    uint8_t v8;
+    uint16_t v16;
+    uint32_t v32;
+    uint64_t v64;
+
+    switch (width) {
+        case 1: memcpy(&v8, p, 1); return v8;
+        case 2: memcpy(&v16, p, 2); return v16;
+        case 4: memcpy(&v32, p, 4); return v32;
+        default: memcpy(&v64, p, 8); return v64;
+    }
+}
+
+bus_filter_t *bus_filter_compile(const bus_filter_clause_t *clauses, size_t count)
+{
+    if (!clauses || count == 0 || count > BUS_FILTER_MAX_CLAUSES) return NULL;
+
+    bus_filter_t *filter = calloc(1, sizeof(bus_filter_t) + count * sizeof(bus_filter_clause_t));
+    if (!filter) return NULL;
+
+    filter->count = count;
+
+    for (size_t i = 0; i < count; i++) {
+        bus_filter_clause_t c = clauses[i];
+
+        if ((c.width != 1 && c.width != 2 && c.width != 4 && c.width != 8) || c.cmp > BUS_FILTER_GE) {
+            free(filter);
+            return NULL;
+        }
+
+        // Both sides see the same normalized clause, mask 0 means the whole field
+        c.mask = (c.mask ? c.mask : UINT64_MAX) & filter_width_mask(c.width);
+        filter->clauses[i] = c;
+
+        const size_t end = (size_t)c.offset + c.width;
+        if (end > filter->end) filter->end = end;
+    }
+
+    // Interpreting stays correct when the JIT is missing or refuses
+    LLVMJITSymbols *jit = llvm_jit_get();
+    if (jit) {
+        JITStub *stub = jit->create_bus_filter_stub((const jit_filter_clause_t *)filter->clauses, count);
+        if (stub) {
+            // C has no object to function pointer cast, copy the address over instead
+            void *fn = jit->get_stub_function(stub);
+            filter->stub = stub;
+            memcpy(&filter->fn, &fn, sizeof(fn));
+        }
+    }
+
+    return filter;
+}
+
+void bus_filter_destroy(bus_filter_t *filter)
+{
+    if (!filter) return;
+
+    LLVMJITSymbols *jit = llvm_jit_get();
+    if (filter->stub && jit) jit->destroy_stub_function(filter->stub);
+    free(filter);
+}
+
+int bus_filter_eval(const bus_filter_t *filter, const void *data, size_t len)
+{
+    if (len < filter->end) return 0;
+
+    const unsigned char *bytes = data;
+
+    for (size_t i = 0; i < filter->count; i++) {
+        const bus_filter_clause_t *c = &filter->clauses[i];
+        const uint64_t field = filter_load(bytes + c->offset, c->width) & c->mask;
+        int pass;
+
+        switch (c->cmp) {
+            case BUS_FILTER_NE: pass = field != c->value; break;
+            case BUS_FILTER_LT: pass = field < c->value; break;
+            case BUS_FILTER_LE: pass = field <= c->value; break;
+            case BUS_FILTER_GT: pass = field > c->value; break;
+            case BUS_FILTER_GE: pass = field >= c->value; break;
+            default: pass = field == c->value; break;
+        }
+
+        if (!pass) return 0;
+    }
+
+    return 1;
+}
@@ -0,0 +1,38 @@
+#ifndef CORECDTL_EVENT_BUS_FILTER_H
+#define CORECDTL_EVENT_BUS_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core_utils.h"
+#include "platform.h"
+
+#define BUS_FILTER_MAX_CLAUSES 16
+
+/*
+ * Payload predicate of one subscription, run by the publisher before the
+ * payload is copied or queued. Compiled to native code through the JIT
+ * library when it is loaded, interpreted otherwise.
+ */
+typedef int (*bus_filter_fn)(const void *data, size_t len);
+
+typedef struct bus_filter_s {
+    bus_filter_fn fn;           /**< JIT compiled, NULL = interpreted */
+    void *stub;                 /**< JITStub owning fn */
+    size_t end;                 /**< Shortest payload every clause fits in */
+    size_t count;
+    bus_filter_clause_t clauses[];
+} bus_filter_t;
+
+// NULL when a clause is malformed, the clauses are copied
+bus_filter_t *bus_filter_compile(const bus_filter_clause_t *clauses, size_t count);
+void bus_filter_destroy(bus_filter_t *filter);
+int bus_filter_eval(const bus_filter_t *filter, const void *data, size_t len);
+
+static inline int bus_filter_match(const bus_filter_t *filter, const void *data, size_t len)
+{
+    if (LIKELY(filter->fn != NULL)) return filter->fn(data, len);
+    return bus_filter_eval(filter, data, len);
+}
+
+#endif //CORECDTL_EVENT_BUS_FILTER_H
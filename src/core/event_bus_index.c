@@ -0,0 +1,704 @@
+#include "event_bus_index.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+#include "event_bus_epoch.h"
+#include "event_bus_trie.h"
+#include "../utils/utils_string.h"
+
+#define BUS_TOPIC_CHUNK     256
+#define BUS_TOPIC_CHUNKS    ((BUS_TOPIC_MAX_COUNT + BUS_TOPIC_CHUNK) / BUS_TOPIC_CHUNK)
+
+typedef struct {
+    uint64_t hash;
+    _Atomic event_id_t id;  // EVENT_ID_INVALID marks an empty slot, set last
+} bus_topic_slot_t;
+
+typedef struct {
+    size_t capacity;
+    bus_topic_slot_t slots[];
+} bus_topic_table_t;
+
+// Cached exact + wildcard subscribers of one plugin on a concrete topic
+typedef struct bus_route_s {
+    plugin_id_t plugin_id;
+    bus_sub_list_t list;
+    struct bus_route_s *next;
+} bus_route_t;
+
+// Lives in a chunk that never moves, so publishers keep pointers to it
+typedef struct {
+    char *name;
+    _Atomic(bus_topic_policy_t *) policy;   // NULL = defaults, replaced on every change
+    _Atomic(bus_route_t *) routes;
+} bus_topic_info_t;
+
+// Wildcard subscribers of one plugin on a name nobody interned, empty lists are cached too
+typedef struct {
+    uint64_t hash;                          // name and plugin_id
+    uint64_t generation;                    // g_pattern_generation it was matched under
+    plugin_id_t plugin_id;
+    bus_sub_list_t list;
+    char name[];
+} bus_name_route_t;
+
+typedef struct {
+    _Atomic uint64_t key;                   // 0 marks an empty slot, set last
+    _Atomic(bus_sub_list_t *) list;         // never modified in place, NULL once emptied
+} bus_index_slot_t;
+
+typedef struct {
+    size_t capacity;
+    size_t count;                           // keys placed, emptied ones included
+    bus_index_slot_t slots[];
+} bus_index_table_t;
+
+/*
+ * Publishers only enter an epoch. Writers serialize on g_index_mutex,
+ * publish a modified copy and retire what they replaced, so a list or
+ * table a reader picked up stays valid until it leaves its epoch.
+ */
+static pthread_mutex_t g_index_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static _Atomic(bus_topic_table_t *) g_topics = NULL;
+static _Atomic(bus_topic_info_t *) g_topic_chunks[BUS_TOPIC_CHUNKS];
+static atomic_size_t g_topic_count = 0;
+
+static const bus_topic_policy_t g_default_policy = {
+    .backpressure = BUS_BACKPRESSURE_BLOCK, .block_timeout_ms = 0, .conflated = 0, .journaled = 0,
+    .owner = PLUGIN_ID_INVALID
+};
+
+static bus_trie_t g_patterns = { 0 };
+static atomic_int g_has_patterns = 0;
+
+// Direct mapped, a colliding name replaces the entry. Bumped after every pattern change
+static _Atomic(bus_name_route_t *) g_name_routes[BUS_NAME_ROUTE_SLOTS];
+static _Atomic uint64_t g_pattern_generation = 0;
+
+static _Atomic(bus_index_table_t *) g_index = NULL;
+
+static inline uint64_t hash_mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline uint64_t hash_str(const char *s)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static inline uint64_t index_key(plugin_id_t plugin_id, event_id_t topic)
+{
+    return ((uint64_t)plugin_id << 16) | topic;
+}
+
+static inline bus_topic_info_t *topic_info_at(event_id_t topic)
+{
+    bus_topic_info_t *chunk = atomic_load_explicit(&g_topic_chunks[topic / BUS_TOPIC_CHUNK], memory_order_relaxed);
+    return &chunk[topic % BUS_TOPIC_CHUNK];
+}
+
+static inline bus_topic_info_t *topic_info(event_id_t topic)
+{
+    // The count is stored after the entry is filled in
+    if (UNLIKELY(topic == EVENT_ID_INVALID || topic > atomic_load_explicit(&g_topic_count, memory_order_acquire)))
+        return NULL;
+    return topic_info_at(topic);
+}
+
+void bus_sub_list_free(void *ptr)
+{
+    bus_sub_list_t *list = ptr;
+    free(list->subs);
+    free(list);
+}
+
+static void routes_free(void *ptr)
+{
+    bus_route_t *route = ptr;
+
+    while (route) {
+        bus_route_t *next = route->next;
+        free(route->list.subs);
+        free(route);
+        route = next;
+    }
+}
+
+static void name_route_free(void *ptr)
+{
+    bus_name_route_t *route = ptr;
+    free(route->list.subs);
+    free(route);
+}
+
+int bus_index_init(void)
+{
+    bus_topic_table_t *topics = calloc(1, sizeof(bus_topic_table_t) +
+        BUS_INDEX_INITIAL_CAPACITY * sizeof(bus_topic_slot_t));
+    bus_index_table_t *index = calloc(1, sizeof(bus_index_table_t) +
+        BUS_INDEX_INITIAL_CAPACITY * sizeof(bus_index_slot_t));
+
+    if (!topics || !index) {
+        free(topics);
+        free(index);
+        return -1;
+    }
+
+    topics->capacity = BUS_INDEX_INITIAL_CAPACITY;
+    index->capacity = BUS_INDEX_INITIAL_CAPACITY;
+
+    pthread_mutex_lock(&g_index_mutex);
+    atomic_store_explicit(&g_topic_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&g_topics, topics, memory_order_release);
+    atomic_store_explicit(&g_index, index, memory_order_release);
+    pthread_mutex_unlock(&g_index_mutex);
+
+    return 0;
+}
+
+// g_index_mutex held
+static void routes_clear_locked(bus_topic_info_t *info)
+{
+    bus_epoch_retire(atomic_exchange_explicit(&info->routes, NULL, memory_order_acq_rel), routes_free);
+}
+
+void bus_index_destroy(void)
+{
+    pthread_mutex_lock(&g_index_mutex);
+
+    bus_trie_destroy(&g_patterns);
+    atomic_store(&g_has_patterns, 0);
+    for (size_t i = 0; i < BUS_NAME_ROUTE_SLOTS; i++) {
+        bus_name_route_t *route = atomic_exchange_explicit(&g_name_routes[i], NULL, memory_order_relaxed);
+        if (route) name_route_free(route);
+    }
+
+    bus_index_table_t *index = atomic_exchange(&g_index, NULL);
+    for (size_t i = 0; index && i < index->capacity; i++) {
+        bus_sub_list_t *list = atomic_load_explicit(&index->slots[i].list, memory_order_relaxed);
+        if (list) bus_sub_list_free(list);
+    }
+    free(index);
+
+    const size_t count = atomic_exchange(&g_topic_count, 0);
+    for (size_t i = 1; i <= count; i++) {
+        bus_topic_info_t *info = topic_info_at((event_id_t)i);
+        free(info->name);
+        free(atomic_load_explicit(&info->policy, memory_order_relaxed));
+        routes_free(atomic_load_explicit(&info->routes, memory_order_relaxed));
+    }
+    for (size_t i = 0; i < BUS_TOPIC_CHUNKS; i++) {
+        free(atomic_exchange(&g_topic_chunks[i], NULL));
+    }
+    free(atomic_exchange(&g_topics, NULL));
+
+    pthread_mutex_unlock(&g_index_mutex);
+
+    // Nobody publishes anymore, whatever is still retired can go
+    bus_epoch_drain();
+}
+
+/*
+ *
+ * @brief Topic interning
+ */
+static event_id_t topic_find(const bus_topic_table_t *table, const char *name, uint64_t hash)
+{
+    if (UNLIKELY(!table)) return EVENT_ID_INVALID;
+
+    const size_t mask = table->capacity - 1;
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const bus_topic_slot_t *slot = &table->slots[i];
+        const event_id_t id = atomic_load_explicit(&slot->id, memory_order_acquire);
+
+        if (id == EVENT_ID_INVALID) return EVENT_ID_INVALID;
+        if (slot->hash == hash && optimized_strcmp(topic_info_at(id)->name, name) == 0) return id;
+    }
+}
+
+static void topic_place(bus_topic_table_t *table, uint64_t hash, event_id_t id)
+{
+    const size_t mask = table->capacity - 1;
+    size_t i = hash & mask;
+
+    while (atomic_load_explicit(&table->slots[i].id, memory_order_relaxed) != EVENT_ID_INVALID) i = (i + 1) & mask;
+
+    table->slots[i].hash = hash;
+    atomic_store_explicit(&table->slots[i].id, id, memory_order_release);
+}
+
+static bus_topic_table_t *topic_grow_locked(bus_topic_table_t *old)
+{
+    const size_t capacity = old->capacity * 2;
+    bus_topic_table_t *table = calloc(1, sizeof(bus_topic_table_t) + capacity * sizeof(bus_topic_slot_t));
+    if (!table) return NULL;
+
+    table->capacity = capacity;
+    for (size_t i = 0; i < old->capacity; i++) {
+        const event_id_t id = atomic_load_explicit(&old->slots[i].id, memory_order_relaxed);
+        if (id != EVENT_ID_INVALID) topic_place(table, old->slots[i].hash, id);
+    }
+
+    atomic_store_explicit(&g_topics, table, memory_order_release);
+    bus_epoch_retire(old, free);
+    return table;
+}
+
+event_id_t bus_topic_lookup(const char *name)
+{
+    if (UNLIKELY(!name)) return EVENT_ID_INVALID;
+
+    const uint64_t hash = hash_str(name);
+
+    bus_epoch_enter();
+    event_id_t id = topic_find(atomic_load_explicit(&g_topics, memory_order_acquire), name, hash);
+    bus_epoch_exit();
+
+    return id;
+}
+
+event_id_t bus_topic_lookup_locked(const char *name)
+{
+    if (UNLIKELY(!name)) return EVENT_ID_INVALID;
+    return topic_find(atomic_load_explicit(&g_topics, memory_order_acquire), name, hash_str(name));
+}
+
+event_id_t bus_topic_intern(const char *name)
+{
+    if (UNLIKELY(!name)) return EVENT_ID_INVALID;
+
+    const uint64_t hash = hash_str(name);
+
+    event_id_t id = bus_topic_lookup(name);
+    if (LIKELY(id != EVENT_ID_INVALID)) return id;
+
+    pthread_mutex_lock(&g_index_mutex);
+
+    // Someone may have interned it before we got the mutex
+    bus_topic_table_t *table = atomic_load_explicit(&g_topics, memory_order_relaxed);
+    const size_t count = atomic_load_explicit(&g_topic_count, memory_order_relaxed);
+    id = topic_find(table, name, hash);
+    if (id != EVENT_ID_INVALID || !table || count >= BUS_TOPIC_MAX_COUNT) {
+        pthread_mutex_unlock(&g_index_mutex);
+        return id;
+    }
+
+    if ((count + 1) * 2 > table->capacity && !(table = topic_grow_locked(table))) {
+        pthread_mutex_unlock(&g_index_mutex);
+        return EVENT_ID_INVALID;
+    }
+
+    id = (event_id_t)(count + 1);
+
+    bus_topic_info_t *chunk = atomic_load_explicit(&g_topic_chunks[id / BUS_TOPIC_CHUNK], memory_order_relaxed);
+    if (!chunk) {
+        chunk = calloc(BUS_TOPIC_CHUNK, sizeof(bus_topic_info_t));
+        if (!chunk) {
+            pthread_mutex_unlock(&g_index_mutex);
+            return EVENT_ID_INVALID;
+        }
+        atomic_store_explicit(&g_topic_chunks[id / BUS_TOPIC_CHUNK], chunk, memory_order_relaxed);
+    }
+
+    char *copy = strdup(name);
+    if (!copy) {
+        pthread_mutex_unlock(&g_index_mutex);
+        return EVENT_ID_INVALID;
+    }
+
+    bus_topic_info_t *info = &chunk[id % BUS_TOPIC_CHUNK];
+    info->name = copy;
+    atomic_init(&info->policy, NULL);
+    atomic_init(&info->routes, NULL);
+
+    atomic_store_explicit(&g_topic_count, count + 1, memory_order_release);
+    topic_place(table, hash, id);
+
+    pthread_mutex_unlock(&g_index_mutex);
+    return id;
+}
+
+// Names never move and live as long as the index
+const char *bus_topic_name(event_id_t topic)
+{
+    const bus_topic_info_t *info = topic_info(topic);
+    return info ? info->name : NULL;
+}
+
+const char *bus_topic_name_locked(event_id_t topic)
+{
+    return bus_topic_name(topic);
+}
+
+int bus_topic_set_policy(event_id_t topic, const bus_topic_policy_t *policy)
+{
+    bus_topic_info_t *info = topic_info(topic);
+    if (!info) return -1;
+
+    bus_topic_policy_t *copy = malloc(sizeof(bus_topic_policy_t));
+    if (!copy) return -1;
+    *copy = *policy;
+
+    // Publishers may still be reading the previous one
+    bus_epoch_retire(atomic_exchange_explicit(&info->policy, copy, memory_order_acq_rel), free);
+    return 0;
+}
+
+int bus_topic_get_policy(event_id_t topic, bus_topic_policy_t *out)
+{
+    int ret = -1;
+
+    bus_epoch_enter();
+    const bus_topic_policy_t *policy = bus_topic_policy_locked(topic);
+    if (policy) {
+        *out = *policy;
+        ret = 0;
+    }
+    bus_epoch_exit();
+
+    return ret;
+}
+
+const bus_topic_policy_t *bus_topic_policy_locked(event_id_t topic)
+{
+    bus_topic_info_t *info = topic_info(topic);
+    if (UNLIKELY(!info)) return NULL;
+
+    const bus_topic_policy_t *policy = atomic_load_explicit(&info->policy, memory_order_acquire);
+    return policy ? policy : &g_default_policy;
+}
+
+/*
+ *
+ * @brief (plugin_id, topic) -> subscribers
+ */
+static const bus_sub_list_t *index_lookup(const bus_index_table_t *table, uint64_t key)
+{
+    const size_t mask = table->capacity - 1;
+
+    for (size_t i = hash_mix(key) & mask;; i = (i + 1) & mask) {
+        const uint64_t slot_key = atomic_load_explicit(&table->slots[i].key, memory_order_acquire);
+
+        if (slot_key == key) return atomic_load_explicit(&table->slots[i].list, memory_order_acquire);
+        if (slot_key == 0) return NULL;
+    }
+}
+
+// g_index_mutex held, the matching slot or the empty one the key would take
+static bus_index_slot_t *index_probe_locked(bus_index_table_t *table, uint64_t key)
+{
+    const size_t mask = table->capacity - 1;
+
+    for (size_t i = hash_mix(key) & mask;; i = (i + 1) & mask) {
+        const uint64_t slot_key = atomic_load_explicit(&table->slots[i].key, memory_order_relaxed);
+        if (slot_key == key || slot_key == 0) return &table->slots[i];
+    }
+}
+
+// Emptied keys are left behind on the way
+static bus_index_table_t *index_grow_locked(bus_index_table_t *old)
+{
+    const size_t capacity = old->capacity * 2;
+    bus_index_table_t *table = calloc(1, sizeof(bus_index_table_t) + capacity * sizeof(bus_index_slot_t));
+    if (!table) return NULL;
+
+    table->capacity = capacity;
+    for (size_t i = 0; i < old->capacity; i++) {
+        bus_sub_list_t *list = atomic_load_explicit(&old->slots[i].list, memory_order_relaxed);
+        if (!list) continue;
+
+        const uint64_t key = atomic_load_explicit(&old->slots[i].key, memory_order_relaxed);
+        bus_index_slot_t *slot = index_probe_locked(table, key);
+        atomic_init(&slot->list, list);
+        atomic_init(&slot->key, key);
+        table->count++;
+    }
+
+    // The lists moved over, only the old table goes
+    atomic_store_explicit(&g_index, table, memory_order_release);
+    bus_epoch_retire(old, free);
+    return table;
+}
+
+int bus_sub_list_push(bus_sub_list_t *list, sub_t *sub)
+{
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 4;
+        sub_t **subs = realloc(list->subs, capacity * sizeof(sub_t *));
+        if (!subs) return -1;
+        list->subs = subs;
+        list->capacity = capacity;
+    }
+
+    list->subs[list->count++] = sub;
+    return 0;
+}
+
+bus_sub_list_t *bus_sub_list_copy(const bus_sub_list_t *from, const sub_t *skip, sub_t *add)
+{
+    bus_sub_list_t *list = calloc(1, sizeof(bus_sub_list_t));
+    if (!list) return NULL;
+
+    int err = 0;
+    for (size_t i = 0; from && i < from->count && !err; i++) {
+        if (from->subs[i] != skip) err = bus_sub_list_push(list, from->subs[i]);
+    }
+    if (!err && add) err = bus_sub_list_push(list, add);
+
+    if (UNLIKELY(err)) {
+        bus_sub_list_free(list);
+        return NULL;
+    }
+    return list;
+}
+
+static int list_contains(const bus_sub_list_t *list, const sub_t *sub)
+{
+    for (size_t i = 0; list && i < list->count; i++) {
+        if (list->subs[i] == sub) return 1;
+    }
+    return 0;
+}
+
+// A pattern may reach any concrete topic, interned or not
+static void routes_clear_all_locked(void)
+{
+    const size_t count = atomic_load_explicit(&g_topic_count, memory_order_relaxed);
+
+    for (size_t i = 1; i <= count; i++) {
+        routes_clear_locked(topic_info_at((event_id_t)i));
+    }
+
+    // A publisher that matched the old trie may still install its entry, the generation turns it away
+    atomic_fetch_add_explicit(&g_pattern_generation, 1, memory_order_release);
+    for (size_t i = 0; i < BUS_NAME_ROUTE_SLOTS; i++) {
+        bus_epoch_retire(atomic_exchange_explicit(&g_name_routes[i], NULL, memory_order_acq_rel), name_route_free);
+    }
+
+    atomic_store_explicit(&g_has_patterns, g_patterns.pattern_count != 0, memory_order_release);
+}
+
+int bus_index_add(sub_t *sub)
+{
+    if (!sub) return -1;
+
+    const int pattern = bus_topic_is_pattern(sub->event);
+    if (pattern < 0 || (!pattern && sub->event_id == EVENT_ID_INVALID)) return -1;
+
+    pthread_mutex_lock(&g_index_mutex);
+
+    bus_index_table_t *table = atomic_load_explicit(&g_index, memory_order_relaxed);
+    if (!table) {
+        pthread_mutex_unlock(&g_index_mutex);
+        return -1;
+    }
+
+    if (pattern) {
+        int ret = bus_trie_insert(&g_patterns, sub);
+        if (ret == 0) routes_clear_all_locked();
+        pthread_mutex_unlock(&g_index_mutex);
+        return ret;
+    }
+
+    const uint64_t key = index_key(sub->plugin_id, sub->event_id);
+
+    if ((table->count + 1) * 2 > table->capacity && !(table = index_grow_locked(table))) {
+        pthread_mutex_unlock(&g_index_mutex);
+        return -1;
+    }
+
+    bus_index_slot_t *slot = index_probe_locked(table, key);
+    bus_sub_list_t *old = atomic_load_explicit(&slot->list, memory_order_relaxed);
+
+    bus_sub_list_t *list = bus_sub_list_copy(old, NULL, sub);
+    if (!list) {
+        pthread_mutex_unlock(&g_index_mutex);
+        return -1;
+    }
+
+    atomic_store_explicit(&slot->list, list, memory_order_release);
+    if (atomic_load_explicit(&slot->key, memory_order_relaxed) == 0) {
+        atomic_store_explicit(&slot->key, key, memory_order_release);
+        table->count++;
+    }
+
+    bus_epoch_retire(old, bus_sub_list_free);
+    routes_clear_locked(topic_info_at(sub->event_id));
+
+    pthread_mutex_unlock(&g_index_mutex);
+    return 0;
+}
+
+int bus_index_remove(sub_t *sub)
+{
+    if (!sub) return -1;
+
+    const int pattern = bus_topic_is_pattern(sub->event);
+    if (pattern < 0 || (!pattern && sub->event_id == EVENT_ID_INVALID)) return -1;
+
+    pthread_mutex_lock(&g_index_mutex);
+
+    bus_index_table_t *table = atomic_load_explicit(&g_index, memory_order_relaxed);
+    if (!table) {
+        pthread_mutex_unlock(&g_index_mutex);
+        return -1;
+    }
+
+    if (pattern) {
+        int ret = bus_trie_remove(&g_patterns, sub);
+        if (ret == 0) routes_clear_all_locked();
+        pthread_mutex_unlock(&g_index_mutex);
+        return ret;
+    }
+
+    bus_index_slot_t *slot = index_probe_locked(table, index_key(sub->plugin_id, sub->event_id));
+    bus_sub_list_t *old = atomic_load_explicit(&slot->list, memory_order_relaxed);
+
+    if (!list_contains(old, sub)) {
+        pthread_mutex_unlock(&g_index_mutex);
+        return -1;
+    }
+
+    bus_sub_list_t *list = NULL;
+    if (old->count > 1 && !(list = bus_sub_list_copy(old, sub, NULL))) {
+        pthread_mutex_unlock(&g_index_mutex);
+        return -1;
+    }
+
+    atomic_store_explicit(&slot->list, list, memory_order_release);
+    bus_epoch_retire(old, bus_sub_list_free);
+    routes_clear_locked(topic_info_at(sub->event_id));
+
+    pthread_mutex_unlock(&g_index_mutex);
+    return 0;
+}
+
+int bus_index_has_patterns(void)
+{
+    return atomic_load_explicit(&g_has_patterns, memory_order_acquire);
+}
+
+void bus_index_enter(void)
+{
+    bus_epoch_enter();
+}
+
+void bus_index_exit(void)
+{
+    bus_epoch_exit();
+}
+
+// g_index_mutex held, so a subscribe cannot clear the cache between the build and the push
+static const bus_sub_list_t *route_build_locked(plugin_id_t plugin_id, event_id_t topic, bus_topic_info_t *info)
+{
+    bus_route_t *head = atomic_load_explicit(&info->routes, memory_order_relaxed);
+
+    // Another publisher may have built it while we waited for the mutex
+    for (bus_route_t *it = head; it; it = it->next) {
+        if (it->plugin_id == plugin_id) return &it->list;
+    }
+
+    const bus_index_table_t *table = atomic_load_explicit(&g_index, memory_order_relaxed);
+    const bus_sub_list_t *exact = table ? index_lookup(table, index_key(plugin_id, topic)) : NULL;
+
+    bus_route_t *route = calloc(1, sizeof(bus_route_t));
+    if (!route) return exact;
+    route->plugin_id = plugin_id;
+
+    int err = 0;
+    for (size_t i = 0; exact && i < exact->count && !err; i++) {
+        err = bus_sub_list_push(&route->list, exact->subs[i]);
+    }
+    if (!err) err = bus_trie_match(&g_patterns, info->name, plugin_id, &route->list);
+
+    if (UNLIKELY(err)) {
+        routes_free(route);
+        return exact;
+    }
+
+    route->next = head;
+    atomic_store_explicit(&info->routes, route, memory_order_release);
+    return &route->list;
+}
+
+// Builds the merged list once per (plugin_id, topic) and keeps it until the next change touching it
+static const bus_sub_list_t *route_find_locked(plugin_id_t plugin_id, event_id_t topic, bus_topic_info_t *info)
+{
+    for (bus_route_t *it = atomic_load_explicit(&info->routes, memory_order_acquire); it; it = it->next) {
+        if (it->plugin_id == plugin_id) return &it->list;
+    }
+
+    pthread_mutex_lock(&g_index_mutex);
+    const bus_sub_list_t *list = route_build_locked(plugin_id, topic, info);
+    pthread_mutex_unlock(&g_index_mutex);
+
+    return list;
+}
+
+const bus_sub_list_t *bus_index_find(plugin_id_t plugin_id, event_id_t topic)
+{
+    const bus_index_table_t *table = atomic_load_explicit(&g_index, memory_order_acquire);
+    if (UNLIKELY(!table)) return NULL;
+
+    const bus_sub_list_t *exact = index_lookup(table, index_key(plugin_id, topic));
+
+    if (LIKELY(!atomic_load_explicit(&g_has_patterns, memory_order_relaxed))) return exact;
+
+    bus_topic_info_t *info = topic_info(topic);
+    if (UNLIKELY(!info)) return exact;
+
+    return route_find_locked(plugin_id, topic, info);
+}
+
+const bus_sub_list_t *bus_index_find_name(plugin_id_t plugin_id, const char *name)
+{
+    if (!name || !atomic_load_explicit(&g_has_patterns, memory_order_acquire)) return NULL;
+
+    const uint64_t hash = hash_mix(hash_str(name) ^ plugin_id);
+    _Atomic(bus_name_route_t *) *slot = &g_name_routes[hash & (BUS_NAME_ROUTE_SLOTS - 1)];
+    // Read before the trie, so an entry never claims a newer generation than it matched
+    const uint64_t generation = atomic_load_explicit(&g_pattern_generation, memory_order_acquire);
+
+    bus_name_route_t *route = atomic_load_explicit(slot, memory_order_acquire);
+    if (LIKELY(route && route->hash == hash && route->generation == generation && route->plugin_id == plugin_id &&
+            strcmp(route->name, name) == 0)) {
+        return route->list.count ? &route->list : NULL;
+    }
+
+    if (bus_topic_is_pattern(name) != 0) return NULL;
+
+    const size_t len = strlen(name);
+    route = calloc(1, sizeof(bus_name_route_t) + len + 1);
+    if (!route) return NULL;
+
+    route->hash = hash;
+    route->generation = generation;
+    route->plugin_id = plugin_id;
+    memcpy(route->name, name, len + 1);
+
+    if (bus_trie_match(&g_patterns, name, plugin_id, &route->list) != 0) {
+        name_route_free(route);
+        return NULL;
+    }
+
+    // Racing publishers each install their own copy, the replaced one is retired like any other
+    bus_epoch_retire(atomic_exchange_explicit(slot, route, memory_order_acq_rel), name_route_free);
+    return route->list.count ? &route->list : NULL;
+}
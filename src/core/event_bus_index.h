@@ -0,0 +1,77 @@
+#ifndef CORECDTL_EVENT_BUS_INDEX_H
+#define CORECDTL_EVENT_BUS_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core_utils.h"
+#include "event_bus.h"
+
+#define BUS_INDEX_INITIAL_CAPACITY 64
+#define BUS_TOPIC_MAX_COUNT UINT16_MAX
+#define BUS_NAME_ROUTE_SLOTS 1024      // cached wildcard matches of uninterned names, power of two
+
+/*
+ * Contiguous subscriber array for one (plugin_id, topic) pair.
+ * Published lists are never modified, a change installs a copy.
+ */
+typedef struct {
+    sub_t **subs;
+    size_t count;
+    size_t capacity;
+} bus_sub_list_t;
+
+typedef struct {
+    bus_backpressure_t backpressure;
+    uint32_t block_timeout_ms;  /**< BUS_BACKPRESSURE_BLOCK only, 0 waits forever */
+    int conflated;              /**< Coalesce every publish, keep the last value per key */
+    int journaled;              /**< Append every publish to the journal */
+    plugin_id_t owner;          /**< First plugin to change the policy, PLUGIN_ID_INVALID while only the core did */
+} bus_topic_policy_t;
+
+int bus_index_init(void);
+void bus_index_destroy(void);
+
+/* === Topic interning === */
+// returns EVENT_ID_INVALID when the topic table is exhausted
+event_id_t bus_topic_intern(const char *name);
+// returns EVENT_ID_INVALID for topics nobody interned yet, never allocates
+event_id_t bus_topic_lookup(const char *name);
+const char *bus_topic_name(event_id_t topic);
+int bus_topic_set_policy(event_id_t topic, const bus_topic_policy_t *policy);
+int bus_topic_get_policy(event_id_t topic, bus_topic_policy_t *out);
+
+/* === Subscription index === */
+// Exact names go to the hash index, wildcard patterns to the topic trie
+int bus_index_add(sub_t *sub);
+// Unlinks sub, readers that already picked up a list keep seeing it until they exit
+int bus_index_remove(sub_t *sub);
+int bus_sub_list_push(bus_sub_list_t *list, sub_t *sub);
+// Copy of from (may be NULL) without skip and with add appended, NULL on failure
+bus_sub_list_t *bus_sub_list_copy(const bus_sub_list_t *from, const sub_t *skip, sub_t *add);
+void bus_sub_list_free(void *list);
+// Lock free, lets publishers skip interning when nobody uses wildcards
+int bus_index_has_patterns(void);
+
+/*
+ * Every subscriber a publish on (plugin_id, topic) reaches. Once wildcard
+ * patterns exist the exact list is merged with the trie matches and
+ * cached per topic until the next (un)subscribe touching it.
+ * enter / exit bracket an epoch read section, no lock is taken, and the
+ * result as well as the *_locked lookups are only valid inside it.
+ */
+void bus_index_enter(void);
+void bus_index_exit(void);
+const bus_sub_list_t *bus_index_find(plugin_id_t plugin_id, event_id_t topic);
+/*
+ * Wildcard subscribers of plugin_id matching a name nobody interned, the
+ * name stays uninterned. NULL when nothing matches. Matches are cached per
+ * (plugin_id, name) in BUS_NAME_ROUTE_SLOTS slots until the next pattern
+ * (un)subscribe, a miss walks the trie without taking a lock.
+ */
+const bus_sub_list_t *bus_index_find_name(plugin_id_t plugin_id, const char *name);
+event_id_t bus_topic_lookup_locked(const char *name);
+const bus_topic_policy_t *bus_topic_policy_locked(event_id_t topic);
+const char *bus_topic_name_locked(event_id_t topic);
+
+#endif //CORECDTL_EVENT_BUS_INDEX_H
@@ -0,0 +1,474 @@
+#include "event_bus_journal.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "platform.h"
+
+_Static_assert(sizeof(bus_journal_header_t) % BUS_JOURNAL_ALIGN == 0, "Journal records must start aligned");
+
+typedef struct {
+    char *path;
+    unsigned char *base;
+    size_t size;                /**< Mapped bytes */
+    size_t used;                /**< Header + committed records, append mutex */
+    uint64_t first_seq;
+    uint64_t last_seq;          /**< 0 while empty */
+    uint64_t last_time_ns;
+    atomic_uint readers;        /**< Replays walking the mapping, blocks retirement */
+} bus_journal_segment_t;
+
+static struct {
+    atomic_int enabled;
+    char *dir;
+    size_t segment_bytes;
+    size_t retain_bytes;
+    uint64_t retain_ns;
+
+    pthread_mutex_t append_mutex;       // active segment, next_seq, retention
+    pthread_rwlock_t segments_lock;     // the segments array itself
+    bus_journal_segment_t **segments;   // oldest first, the last one takes appends
+    size_t count;
+    size_t capacity;
+    bus_journal_segment_t *active;
+    _Atomic uint64_t next_seq;
+} g_journal = {
+    .append_mutex = PTHREAD_MUTEX_INITIALIZER,
+    .segments_lock = PTHREAD_RWLOCK_INITIALIZER,
+    .next_seq = 1
+};
+
+static inline uint64_t journal_wall_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline size_t journal_align(size_t size)
+{
+    return (size + BUS_JOURNAL_ALIGN - 1) & ~(size_t)(BUS_JOURNAL_ALIGN - 1);
+}
+
+// Offset of the payload in data[], records start aligned so the payload does as well
+static inline size_t journal_payload_offset(size_t name_len)
+{
+    return journal_align(sizeof(bus_journal_record_t) + name_len) - sizeof(bus_journal_record_t);
+}
+
+static inline size_t journal_record_size(size_t name_len, size_t len)
+{
+    return journal_align(sizeof(bus_journal_record_t) + journal_payload_offset(name_len) + len);
+}
+
+static inline bus_journal_record_t *journal_record_at(const bus_journal_segment_t *seg, size_t off)
+{
+    if (off + sizeof(bus_journal_record_t) > seg->size) return NULL;
+
+    bus_journal_record_t *rec = (bus_journal_record_t *)(seg->base + off);
+    const uint32_t size = atomic_load_explicit(&rec->size, memory_order_acquire);
+    if (size < sizeof(bus_journal_record_t) || size > seg->size - off) return NULL;
+
+    return rec;
+}
+
+static void journal_segment_free(bus_journal_segment_t *seg, int unlink_file)
+{
+    if (seg->base) munmap(seg->base, seg->size);
+    if (unlink_file && seg->path) unlink(seg->path);
+    free(seg->path);
+    free(seg);
+}
+
+static int journal_segment_push(bus_journal_segment_t *seg)
+{
+    pthread_rwlock_wrlock(&g_journal.segments_lock);
+
+    if (g_journal.count == g_journal.capacity) {
+        const size_t capacity = g_journal.capacity ? g_journal.capacity * 2 : 16;
+        bus_journal_segment_t **segments = realloc(g_journal.segments, capacity * sizeof(bus_journal_segment_t *));
+        if (!segments) {
+            pthread_rwlock_unlock(&g_journal.segments_lock);
+            return -1;
+        }
+        g_journal.segments = segments;
+        g_journal.capacity = capacity;
+    }
+    g_journal.segments[g_journal.count++] = seg;
+
+    pthread_rwlock_unlock(&g_journal.segments_lock);
+    return 0;
+}
+
+static bus_journal_segment_t *journal_segment_create(uint64_t first_seq)
+{
+    bus_journal_segment_t *seg = calloc(1, sizeof(bus_journal_segment_t));
+    if (!seg) return NULL;
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/bus-%020llu.journal", g_journal.dir, (unsigned long long)first_seq);
+
+    // Never reuse a file, an existing one may still be mapped in segments[]
+    seg->path = strdup(path);
+    const int fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (!seg->path || fd < 0) {
+        if (fd < 0) core_log_error("Event bus journal: cannot create %s: %s", path, strerror(errno));
+        if (fd >= 0) close(fd);
+        journal_segment_free(seg, 0);
+        return NULL;
+    }
+
+    // Reserve the blocks now, a store into a sparse page the disk has no room for raises SIGBUS
+    const int err = posix_fallocate(fd, 0, (off_t)g_journal.segment_bytes);
+    if (err != 0) {
+        core_log_error("Event bus journal: cannot allocate %s: %s", path, strerror(err));
+        close(fd);
+        journal_segment_free(seg, 1);
+        return NULL;
+    }
+
+    void *base = mmap(NULL, g_journal.segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        journal_segment_free(seg, 1);
+        return NULL;
+    }
+
+    seg->base = base;
+    seg->size = g_journal.segment_bytes;
+    seg->used = sizeof(bus_journal_header_t);
+    seg->first_seq = first_seq;
+    seg->last_time_ns = journal_wall_ns();
+
+    bus_journal_header_t *header = (bus_journal_header_t *)seg->base;
+    memcpy(header->magic, BUS_JOURNAL_MAGIC, sizeof(header->magic));
+    header->first_seq = first_seq;
+    header->created_ns = seg->last_time_ns;
+
+    return seg;
+}
+
+// Maps a segment left by an earlier run read-only and finds its last committed record
+static bus_journal_segment_t *journal_segment_recover(const char *path)
+{
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(bus_journal_header_t)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    bus_journal_segment_t *seg = calloc(1, sizeof(bus_journal_segment_t));
+    if (!seg || !(seg->path = strdup(path))) {
+        free(seg);
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+
+    seg->base = base;
+    seg->size = (size_t)st.st_size;
+
+    const bus_journal_header_t *header = (const bus_journal_header_t *)seg->base;
+    if (memcmp(header->magic, BUS_JOURNAL_MAGIC, sizeof(header->magic)) != 0) {
+        journal_segment_free(seg, 0);
+        return NULL;
+    }
+
+    seg->first_seq = header->first_seq;
+    seg->last_time_ns = header->created_ns;
+    seg->used = sizeof(bus_journal_header_t);
+
+    const bus_journal_record_t *rec;
+    while ((rec = journal_record_at(seg, seg->used))) {
+        seg->last_seq = rec->seq;
+        seg->last_time_ns = rec->time_ns;
+        seg->used += atomic_load_explicit(&rec->size, memory_order_relaxed);
+    }
+
+    return seg;
+}
+
+static int journal_segment_cmp(const void *a, const void *b)
+{
+    const bus_journal_segment_t *sa = *(bus_journal_segment_t *const *)a;
+    const bus_journal_segment_t *sb = *(bus_journal_segment_t *const *)b;
+    return sa->first_seq < sb->first_seq ? -1 : sa->first_seq > sb->first_seq;
+}
+
+static int journal_recover(void)
+{
+    DIR *dir = opendir(g_journal.dir);
+    if (!dir) return -1;
+
+    uint64_t next_seq = 1;
+    struct dirent *entry;
+
+    while ((entry = readdir(dir))) {
+        unsigned long long first_seq;
+        char tail;
+        if (sscanf(entry->d_name, "bus-%llu.journa%c", &first_seq, &tail) != 2 || tail != 'l') continue;
+
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", g_journal.dir, entry->d_name);
+
+        bus_journal_segment_t *seg = journal_segment_recover(path);
+        if (!seg) {
+            core_log_warn("Event bus journal: skipping unreadable segment %s", path);
+            // Its name stays taken, new segments must not collide with it
+            if (first_seq >= next_seq) next_seq = first_seq + 1;
+            continue;
+        }
+        if (seg->last_seq == 0) {
+            // Nothing was committed, the next segment takes over its first_seq and file name
+            if (seg->first_seq >= next_seq) next_seq = seg->first_seq;
+            journal_segment_free(seg, 1);
+            continue;
+        }
+        if (journal_segment_push(seg) != 0) {
+            journal_segment_free(seg, 0);
+            closedir(dir);
+            return -1;
+        }
+        if (seg->last_seq >= next_seq) next_seq = seg->last_seq + 1;
+        if (seg->first_seq >= next_seq) next_seq = seg->first_seq;
+    }
+    closedir(dir);
+
+    qsort(g_journal.segments, g_journal.count, sizeof(bus_journal_segment_t *), journal_segment_cmp);
+    atomic_store(&g_journal.next_seq, next_seq);
+    return 0;
+}
+
+int bus_journal_init(const bus_config_t *config)
+{
+    if (!config->journal_dir) return 0;
+
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t segment_bytes = config->journal_segment_bytes;
+    if (segment_bytes < BUS_JOURNAL_MIN_SEGMENT) segment_bytes = BUS_JOURNAL_MIN_SEGMENT;
+
+    g_journal.segment_bytes = (segment_bytes + page - 1) / page * page;
+    g_journal.retain_bytes = config->journal_retain_bytes;
+    g_journal.retain_ns = (uint64_t)config->journal_retain_s * 1000000000ULL;
+    g_journal.dir = strdup(config->journal_dir);
+    if (!g_journal.dir) return -1;
+
+    if (mkdir(g_journal.dir, 0755) != 0 && errno != EEXIST) {
+        core_log_error("Event bus journal: cannot create %s", g_journal.dir);
+        bus_journal_destroy();
+        return -1;
+    }
+
+    if (journal_recover() != 0) {
+        core_log_error("Event bus journal: cannot read %s", g_journal.dir);
+        bus_journal_destroy();
+        return -1;
+    }
+
+    atomic_store(&g_journal.enabled, 1);
+    return 0;
+}
+
+void bus_journal_destroy(void)
+{
+    atomic_store(&g_journal.enabled, 0);
+
+    pthread_mutex_lock(&g_journal.append_mutex);
+    pthread_rwlock_wrlock(&g_journal.segments_lock);
+
+    for (size_t i = 0; i < g_journal.count; i++) {
+        journal_segment_free(g_journal.segments[i], 0);
+    }
+    free(g_journal.segments);
+    free(g_journal.dir);
+
+    g_journal.segments = NULL;
+    g_journal.count = 0;
+    g_journal.capacity = 0;
+    g_journal.active = NULL;
+    g_journal.dir = NULL;
+    atomic_store(&g_journal.next_seq, 1);
+
+    pthread_rwlock_unlock(&g_journal.segments_lock);
+    pthread_mutex_unlock(&g_journal.append_mutex);
+}
+
+int bus_journal_enabled(void)
+{
+    return atomic_load_explicit(&g_journal.enabled, memory_order_relaxed);
+}
+
+uint64_t bus_journal_next_seq(void)
+{
+    return atomic_load_explicit(&g_journal.next_seq, memory_order_relaxed);
+}
+
+// Oldest segments go first, the active one and those a replay is reading stay, append mutex held
+static void journal_retire_locked(void)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < g_journal.count; i++) {
+        total += g_journal.segments[i]->size;
+    }
+
+    const uint64_t now = journal_wall_ns();
+    size_t retired = 0;
+
+    pthread_rwlock_wrlock(&g_journal.segments_lock);
+
+    while (retired + 1 < g_journal.count) {
+        bus_journal_segment_t *seg = g_journal.segments[retired];
+        const int too_big = g_journal.retain_bytes && total > g_journal.retain_bytes;
+        const int too_old = g_journal.retain_ns && now - seg->last_time_ns > g_journal.retain_ns;
+
+        if (!too_big && !too_old) break;
+        if (atomic_load_explicit(&seg->readers, memory_order_acquire)) break;
+
+        total -= seg->size;
+        journal_segment_free(seg, 1);
+        retired++;
+    }
+
+    if (retired) {
+        g_journal.count -= retired;
+        memmove(g_journal.segments, g_journal.segments + retired, g_journal.count * sizeof(bus_journal_segment_t *));
+    }
+
+    pthread_rwlock_unlock(&g_journal.segments_lock);
+}
+
+// Append mutex held
+static bus_journal_segment_t *journal_roll_locked(uint64_t first_seq)
+{
+    bus_journal_segment_t *old = g_journal.active;
+    if (old) msync(old->base, old->size, MS_ASYNC);
+
+    bus_journal_segment_t *seg = journal_segment_create(first_seq);
+    if (!seg) {
+        core_log_error("Event bus journal: cannot create segment in %s", g_journal.dir);
+        return NULL;
+    }
+    if (journal_segment_push(seg) != 0) {
+        journal_segment_free(seg, 1);
+        return NULL;
+    }
+
+    g_journal.active = seg;
+    journal_retire_locked();
+    return seg;
+}
+
+uint64_t bus_journal_append(plugin_id_t plugin_id, event_id_t topic, const char *name, uint64_t key,
+    const void *data, size_t len)
+{
+    if (UNLIKELY(!bus_journal_enabled() || !name)) return 0;
+
+    const size_t name_len = strlen(name);
+    const size_t size = journal_record_size(name_len, len);
+    if (UNLIKELY(name_len > UINT16_MAX || size > g_journal.segment_bytes - sizeof(bus_journal_header_t))) return 0;
+
+    pthread_mutex_lock(&g_journal.append_mutex);
+
+    const uint64_t seq = atomic_load_explicit(&g_journal.next_seq, memory_order_relaxed);
+    bus_journal_segment_t *seg = g_journal.active;
+
+    if (UNLIKELY(!seg || seg->size - seg->used < size)) {
+        seg = journal_roll_locked(seq);
+        if (!seg) {
+            pthread_mutex_unlock(&g_journal.append_mutex);
+            return 0;
+        }
+    }
+
+    bus_journal_record_t *rec = (bus_journal_record_t *)(seg->base + seg->used);
+    rec->topic = topic;
+    rec->name_len = (uint16_t)name_len;
+    rec->plugin_id = plugin_id;
+    rec->len = (uint32_t)len;
+    rec->seq = seq;
+    rec->time_ns = journal_wall_ns();
+    rec->key = key;
+    memcpy(rec->data, name, name_len);
+    memcpy(rec->data + journal_payload_offset(name_len), data, len);
+
+    // Publishes the record to concurrent replays
+    atomic_store_explicit(&rec->size, (uint32_t)size, memory_order_release);
+
+    seg->used += size;
+    seg->last_seq = seq;
+    seg->last_time_ns = rec->time_ns;
+    atomic_store_explicit(&g_journal.next_seq, seq + 1, memory_order_relaxed);
+
+    pthread_mutex_unlock(&g_journal.append_mutex);
+    return seq;
+}
+
+int64_t bus_journal_replay(plugin_id_t plugin_id, const char *name, uint64_t from_seq, bus_replay_cb_t cb,
+    void *user)
+{
+    if (!bus_journal_enabled()) return -1;
+
+    const size_t name_len = strlen(name);
+    const size_t payload_offset = journal_payload_offset(name_len);
+
+    // Pin the segments instead of holding the lock, appends may need to roll meanwhile
+    pthread_rwlock_rdlock(&g_journal.segments_lock);
+    const size_t count = g_journal.count;
+    bus_journal_segment_t **segments = count ? malloc(count * sizeof(bus_journal_segment_t *)) : NULL;
+    if (count && !segments) {
+        pthread_rwlock_unlock(&g_journal.segments_lock);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        segments[i] = g_journal.segments[i];
+        atomic_fetch_add_explicit(&segments[i]->readers, 1, memory_order_acq_rel);
+    }
+    pthread_rwlock_unlock(&g_journal.segments_lock);
+
+    int64_t replayed = 0;
+    int stop = 0;
+
+    for (size_t i = 0; i < count && !stop; i++) {
+        const bus_journal_segment_t *seg = segments[i];
+        if (i + 1 < count && segments[i + 1]->first_seq <= from_seq) continue;
+
+        size_t off = sizeof(bus_journal_header_t);
+        const bus_journal_record_t *rec;
+
+        while ((rec = journal_record_at(seg, off))) {
+            off += atomic_load_explicit(&rec->size, memory_order_relaxed);
+
+            if (rec->seq < from_seq || rec->plugin_id != plugin_id) continue;
+            if (rec->name_len != name_len || memcmp(rec->data, name, name_len) != 0) continue;
+
+            replayed++;
+            if (cb(rec->seq, rec->data + payload_offset, rec->len, user) != 0) {
+                stop = 1;
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        atomic_fetch_sub_explicit(&segments[i]->readers, 1, memory_order_acq_rel);
+    }
+    free(segments);
+
+    return replayed;
+}
@@ -0,0 +1,63 @@
+#ifndef CORECDTL_EVENT_BUS_JOURNAL_H
+#define CORECDTL_EVENT_BUS_JOURNAL_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "event_bus.h"
+
+/*
+ * Append-only journal of selected topics in mmap'd segment files
+ * ("bus-<first seq>.journal" under bus_config_t.journal_dir).
+ *
+ * A segment is a bus_journal_header_t followed by records aligned to
+ * BUS_JOURNAL_ALIGN. The topic name is padded so that the payload starts
+ * aligned too, replay hands it out in place. A record is committed by the release store of its size, so readers and
+ * crash recovery stop at the first zero size. Nothing on the append path
+ * waits for the disk: full segments get an MS_ASYNC msync and the page
+ * cache does the rest.
+ */
+#define BUS_JOURNAL_MAGIC       "CDTLJRN2"
+#define BUS_JOURNAL_ALIGN       16      // payloads get malloc alignment
+#define BUS_JOURNAL_MIN_SEGMENT (64 * 1024)
+
+typedef struct {
+    char magic[8];
+    uint64_t first_seq;
+    uint64_t created_ns;        /**< CLOCK_REALTIME */
+    uint8_t reserved[40];
+} bus_journal_header_t;
+
+typedef struct {
+    _Atomic uint32_t size;      /**< Whole record incl. padding, 0 = end of segment */
+    event_id_t topic;           /**< Valid for the lifetime of the process only, see name_len */
+    uint16_t name_len;          /**< Topic name follows the header, survives restarts */
+    plugin_id_t plugin_id;
+    uint32_t len;               /**< Payload bytes after the padded name */
+    uint64_t seq;
+    uint64_t time_ns;           /**< CLOCK_REALTIME, drives age retention */
+    uint64_t key;
+    unsigned char data[];       /**< name, padding, payload */
+} bus_journal_record_t;
+
+int bus_journal_init(const bus_config_t *config);
+void bus_journal_destroy(void);
+int bus_journal_enabled(void);
+
+// Returns the record's sequence number, 0 when it was not written
+uint64_t bus_journal_append(plugin_id_t plugin_id, event_id_t topic, const char *name, uint64_t key,
+    const void *data, size_t len);
+
+/*
+ * Calls cb for every record of (plugin_id, name) with seq >= from_seq,
+ * oldest first, with pointers straight into the mapping. Segments are
+ * only retired once no replay is walking them.
+ */
+int64_t bus_journal_replay(plugin_id_t plugin_id, const char *name, uint64_t from_seq, bus_replay_cb_t cb,
+    void *user);
+
+// Next sequence number to be handed out, records below it may still be replayed
+uint64_t bus_journal_next_seq(void);
+
+#endif //CORECDTL_EVENT_BUS_JOURNAL_H
@@ -0,0 +1,200 @@
+#include "event_bus_mailbox.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "platform.h"
+
+struct bus_mailbox_s {
+    const sub_t *sub;
+    uint64_t key;
+    size_t bucket;
+    bus_payload_t **items;      // ring, capacity is a power of two
+    size_t head;
+    size_t count;
+    size_t capacity;
+    bus_pool_node_t defer_node; // holds its task when that was deferred
+    struct bus_mailbox_s *next;
+};
+
+typedef struct {
+    pthread_mutex_t mutex;
+    bus_mailbox_t *head;
+} bus_mailbox_bucket_t;
+
+static bus_mailbox_bucket_t g_buckets[BUS_MAILBOX_BUCKETS];
+static pthread_once_t g_buckets_once = PTHREAD_ONCE_INIT;
+
+static void mailbox_buckets_init(void)
+{
+    for (size_t i = 0; i < BUS_MAILBOX_BUCKETS; i++) {
+        pthread_mutex_init(&g_buckets[i].mutex, NULL);
+        g_buckets[i].head = NULL;
+    }
+}
+
+static inline size_t mailbox_bucket_of(const sub_t *sub, uint64_t key)
+{
+    uint64_t h = ((uint64_t)(uintptr_t)sub ^ (key * 0xff51afd7ed558ccdULL)) * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h >> 56) & (BUS_MAILBOX_BUCKETS - 1);
+}
+
+// bucket mutex held
+static int mailbox_grow(bus_mailbox_t *box)
+{
+    const size_t capacity = box->capacity ? box->capacity * 2 : 8;
+    bus_payload_t **items = malloc(capacity * sizeof(bus_payload_t *));
+    if (!items) return -1;
+
+    for (size_t i = 0; i < box->count; i++) {
+        items[i] = box->items[(box->head + i) & (box->capacity - 1)];
+    }
+
+    free(box->items);
+    box->items = items;
+    box->head = 0;
+    box->capacity = capacity;
+    return 0;
+}
+
+int bus_mailbox_push(const sub_t *sub, uint64_t key, bus_payload_t *payload, int drop_oldest,
+    bus_payload_t **evicted, bus_mailbox_t **schedule)
+{
+    pthread_once(&g_buckets_once, mailbox_buckets_init);
+
+    const size_t index = mailbox_bucket_of(sub, key);
+    bus_mailbox_bucket_t *bucket = &g_buckets[index];
+
+    *evicted = NULL;
+    *schedule = NULL;
+
+    pthread_mutex_lock(&bucket->mutex);
+
+    bus_mailbox_t *box = bucket->head;
+    while (box && (box->sub != sub || box->key != key)) box = box->next;
+
+    if (!box) {
+        box = calloc(1, sizeof(bus_mailbox_t));
+        if (!box || mailbox_grow(box) != 0) {
+            pthread_mutex_unlock(&bucket->mutex);
+            free(box);
+            return -1;
+        }
+        box->sub = sub;
+        box->key = key;
+        box->bucket = index;
+        box->next = bucket->head;
+        bucket->head = box;
+
+        // A mailbox lives exactly as long as its task, pop frees it once drained
+        *schedule = box;
+    }
+
+    if (UNLIKELY(box->count == BUS_MAILBOX_CAPACITY)) {
+        if (!drop_oldest) {
+            pthread_mutex_unlock(&bucket->mutex);
+            return -1;
+        }
+        *evicted = box->items[box->head];
+        box->head = (box->head + 1) & (box->capacity - 1);
+        box->count--;
+    }
+
+    if (box->count == box->capacity && mailbox_grow(box) != 0) {
+        pthread_mutex_unlock(&bucket->mutex);
+        return -1;
+    }
+
+    box->items[(box->head + box->count) & (box->capacity - 1)] = payload;
+    box->count++;
+
+    pthread_mutex_unlock(&bucket->mutex);
+    return 0;
+}
+
+bus_pool_node_t *bus_mailbox_node(bus_mailbox_t *box)
+{
+    return &box->defer_node;
+}
+
+bus_payload_t *bus_mailbox_pop(bus_mailbox_t *box)
+{
+    bus_mailbox_bucket_t *bucket = &g_buckets[box->bucket];
+
+    pthread_mutex_lock(&bucket->mutex);
+
+    if (box->count) {
+        bus_payload_t *payload = box->items[box->head];
+        box->head = (box->head + 1) & (box->capacity - 1);
+        box->count--;
+        pthread_mutex_unlock(&bucket->mutex);
+        return payload;
+    }
+
+    // Drained and only referenced by its task, the next push creates a fresh one
+    bus_mailbox_t **link = &bucket->head;
+    while (*link != box) link = &(*link)->next;
+    *link = box->next;
+
+    pthread_mutex_unlock(&bucket->mutex);
+
+    free(box->items);
+    free(box);
+    return NULL;
+}
+
+static void mailbox_free(bus_mailbox_t *box, void (*release)(bus_payload_t *payload))
+{
+    for (size_t j = 0; j < box->count; j++) {
+        release(box->items[(box->head + j) & (box->capacity - 1)]);
+    }
+    free(box->items);
+    free(box);
+}
+
+void bus_mailbox_forget(const sub_t *sub, void (*release)(bus_payload_t *payload))
+{
+    pthread_once(&g_buckets_once, mailbox_buckets_init);
+
+    // One mailbox per key, so they may sit in any bucket
+    for (size_t i = 0; i < BUS_MAILBOX_BUCKETS; i++) {
+        bus_mailbox_bucket_t *bucket = &g_buckets[i];
+
+        pthread_mutex_lock(&bucket->mutex);
+
+        bus_mailbox_t **link = &bucket->head;
+        while (*link) {
+            bus_mailbox_t *box = *link;
+            if (box->sub != sub) {
+                link = &box->next;
+                continue;
+            }
+
+            *link = box->next;
+            mailbox_free(box, release);
+        }
+
+        pthread_mutex_unlock(&bucket->mutex);
+    }
+}
+
+void bus_mailbox_destroy(void (*release)(bus_payload_t *payload))
+{
+    pthread_once(&g_buckets_once, mailbox_buckets_init);
+
+    for (size_t i = 0; i < BUS_MAILBOX_BUCKETS; i++) {
+        bus_mailbox_bucket_t *bucket = &g_buckets[i];
+
+        pthread_mutex_lock(&bucket->mutex);
+
+        bus_mailbox_t *box = bucket->head;
+        while (box) {
+            bus_mailbox_t *n = box->next;
+            mailbox_free(box, release);
+            box = n;
+        }
+        bucket->head = NULL;
+
+        pthread_mutex_unlock(&bucket->mutex);
+    }
+}
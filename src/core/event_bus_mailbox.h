@@ -0,0 +1,44 @@
+#ifndef CORECDTL_EVENT_BUS_MAILBOX_H
+#define CORECDTL_EVENT_BUS_MAILBOX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "event_bus.h"
+#include "event_bus_pool.h"
+
+#define BUS_MAILBOX_BUCKETS     256
+#define BUS_MAILBOX_CAPACITY    1024    // pending payloads per (subscriber, key)
+#define BUS_MAILBOX_BURST       32      // deliveries before a mailbox yields its worker
+
+/*
+ * Ordered delivery: one FIFO mailbox per (subscriber, ordering key).
+ * A mailbox exists only while its one pool task does, so its payloads run
+ * one at a time in publish order while other mailboxes use the other
+ * workers, and drained mailboxes cost nothing.
+ * Each hash bucket has its own lock guarding the mailboxes chained on it.
+ */
+typedef struct bus_mailbox_s bus_mailbox_t;
+
+/*
+ * Appends payload. Returns 0 when accepted and -1 when the mailbox is full
+ * (unless drop_oldest made room, the evicted payload is handed back) or
+ * cannot be allocated. *schedule is set when the mailbox just became busy
+ * and the caller must queue a BUS_TASK_MAILBOX task for it.
+ */
+int bus_mailbox_push(const sub_t *sub, uint64_t key, bus_payload_t *payload, int drop_oldest,
+    bus_payload_t **evicted, bus_mailbox_t **schedule);
+
+// Storage for the mailbox task while it waits outside the pool shards, see bus_pool_defer
+bus_pool_node_t *bus_mailbox_node(bus_mailbox_t *box);
+
+// Next payload in publish order, NULL once the mailbox is empty: it is freed then and box is stale
+bus_payload_t *bus_mailbox_pop(bus_mailbox_t *box);
+
+// Frees the mailboxes of a subscription nothing references anymore, pending payloads go through release
+void bus_mailbox_forget(const sub_t *sub, void (*release)(bus_payload_t *payload));
+
+// Frees every mailbox, pending payloads go through release
+void bus_mailbox_destroy(void (*release)(bus_payload_t *payload));
+
+#endif //CORECDTL_EVENT_BUS_MAILBOX_H
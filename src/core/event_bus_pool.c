@@ -0,0 +1,538 @@
+#if defined(__linux__)
+#define _GNU_SOURCE // pthread_setaffinity_np
+#endif
+
+#include "event_bus_pool.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "platform.h"
+
+static struct p_thread_pool pthread_pool = {
+    .threads = NULL,
+    .shards = NULL,
+    .thread_min_count = 0,
+    .thread_max_count = 0,
+    .thread_count = 0,
+    .thread_map_mask = 0
+};
+
+static bus_park_t g_pool_not_empty;
+static bus_park_t g_pool_not_full;
+static atomic_int g_pool_stopping = 0;
+
+// Deferred tasks in FIFO order, g_deferred_count lets workers skip the mutex
+static pthread_mutex_t g_deferred_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bus_pool_node_t *g_deferred_head = NULL;
+static bus_pool_node_t *g_deferred_tail = NULL;
+static atomic_size_t g_deferred_count = 0;
+
+static __thread size_t t_worker_slot = SIZE_MAX;
+static __thread size_t t_submit_hint = 0;
+static __thread uint32_t t_lane_pops[BUS_LANE_COUNT];    // pops served above each lane since its last turn
+
+static inline bus_queue_t *pool_shard(uint32_t lane, size_t slot)
+{
+    return &pthread_pool.shards[lane * pthread_pool.thread_max_count + slot];
+}
+
+static size_t online_cpus(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+}
+
+static void pool_pin_cpu(size_t slot)
+{
+#if OS_LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET((int)(slot % online_cpus()), &set);
+
+    if (pthread_setaffinity_np(pthread_pool.threads[slot], sizeof(set), &set) != 0) {
+        core_log_warn("Bus pool: cannot pin worker %zu", slot);
+    }
+#else
+    (void)slot;
+#endif
+}
+
+// pool mutex held
+static int pool_spawn_locked(size_t slot)
+{
+    const uint64_t bit = 1ULL << slot;
+
+    if (pthread_pool.thread_map_mask & bit) {
+        // The previous occupant already retired, reap it first
+        pthread_join(pthread_pool.threads[slot], NULL);
+        pthread_pool.thread_map_mask &= ~bit;
+    }
+
+    atomic_store(&pthread_pool.thread_count, slot + 1);
+
+    if (pthread_create(&pthread_pool.threads[slot], NULL, pthread_pool.worker_fn, (void *)(uintptr_t)slot) != 0) {
+        atomic_store(&pthread_pool.thread_count, slot);
+        return -1;
+    }
+
+    pthread_pool.thread_map_mask |= bit;
+    if (pthread_pool.pin_cpus) pool_pin_cpu(slot);
+
+    return 0;
+}
+
+static void pool_grow(void)
+{
+    if (atomic_load_explicit(&pthread_pool.thread_count, memory_order_relaxed) >= pthread_pool.thread_max_count)
+        return;
+
+    // Someone else is already resizing, one spawn at a time is enough
+    if (pthread_mutex_trylock(&pthread_pool.mutex) != 0) return;
+
+    const size_t active = atomic_load(&pthread_pool.thread_count);
+    if (active < pthread_pool.thread_max_count && !atomic_load(&g_pool_stopping)) {
+        pool_spawn_locked(active);
+    }
+
+    pthread_mutex_unlock(&pthread_pool.mutex);
+}
+
+static inline int pool_may_retire(size_t self)
+{
+    const size_t active = atomic_load_explicit(&pthread_pool.thread_count, memory_order_relaxed);
+    return self + 1 == active && active > pthread_pool.thread_min_count;
+}
+
+static size_t pool_slot_depth(size_t slot)
+{
+    size_t depth = 0;
+    for (uint32_t lane = 0; lane < BUS_LANE_COUNT; lane++) {
+        depth += bus_queue_depth(pool_shard(lane, slot));
+    }
+    return depth;
+}
+
+static int pool_retire(size_t self)
+{
+    int retired = 0;
+
+    if (pthread_mutex_trylock(&pthread_pool.mutex) != 0) return 0;
+
+    if (!atomic_load(&g_pool_stopping) && pool_may_retire(self) && pool_slot_depth(self) == 0) {
+        // Anything pushed here afterwards is picked up by stealing
+        atomic_store(&pthread_pool.thread_count, self);
+        retired = 1;
+    }
+
+    pthread_mutex_unlock(&pthread_pool.mutex);
+    return retired;
+}
+
+int bus_pool_init(const bus_config_t *config, void *(*worker_fn)(void *))
+{
+    size_t min = config->min_workers ? config->min_workers : 1;
+    size_t max = config->max_workers ? config->max_workers : online_cpus();
+
+    if (max > BUS_POOL_MAX_WORKERS) max = BUS_POOL_MAX_WORKERS;
+    if (min > max) max = min;
+    if (max > BUS_POOL_MAX_WORKERS) max = min = BUS_POOL_MAX_WORKERS;
+
+    const size_t shard_count = max * BUS_LANE_COUNT;
+
+    pthread_pool.threads = calloc(max, sizeof(pthread_t));
+    pthread_pool.shards = calloc(shard_count, sizeof(bus_queue_t));
+    pthread_pool.counters = aligned_alloc(CACHE_LINE_SIZE, max * sizeof(bus_pool_lane_counters_t));
+    if (!pthread_pool.threads || !pthread_pool.shards || !pthread_pool.counters) {
+        free(pthread_pool.threads);
+        free(pthread_pool.shards);
+        free(pthread_pool.counters);
+        pthread_pool.threads = NULL;
+        pthread_pool.shards = NULL;
+        pthread_pool.counters = NULL;
+        return -1;
+    }
+    memset(pthread_pool.counters, 0, max * sizeof(bus_pool_lane_counters_t));
+
+    for (size_t i = 0; i < shard_count; i++) {
+        if (bus_queue_init(&pthread_pool.shards[i], config->queue_backend, config->queue_capacity) != 0) {
+            while (i-- > 0) bus_queue_destroy(&pthread_pool.shards[i]);
+            free(pthread_pool.threads);
+            free(pthread_pool.shards);
+            free(pthread_pool.counters);
+            pthread_pool.threads = NULL;
+            pthread_pool.shards = NULL;
+            pthread_pool.counters = NULL;
+            return -1;
+        }
+    }
+
+    pthread_pool.thread_min_count = min;
+    pthread_pool.thread_max_count = max;
+    pthread_pool.thread_map_mask = 0;
+    pthread_pool.grow_depth = config->grow_depth ? config->grow_depth : BUS_DEFAULT_GROW_DEPTH;
+    pthread_pool.idle_ns = (int64_t)(config->idle_ms ? config->idle_ms : BUS_DEFAULT_IDLE_MS) * 1000000LL;
+    pthread_pool.lane_aging = config->lane_aging ? config->lane_aging : BUS_DEFAULT_LANE_AGING;
+    pthread_pool.pin_cpus = config->pin_cpus;
+    pthread_pool.worker_fn = worker_fn;
+    atomic_init(&pthread_pool.thread_count, 0);
+    for (uint32_t lane = 0; lane < BUS_LANE_COUNT; lane++) atomic_init(&pthread_pool.depth_hwm[lane], 0);
+    pthread_mutex_init(&pthread_pool.mutex, NULL);
+
+    bus_park_init(&g_pool_not_empty);
+    bus_park_init(&g_pool_not_full);
+    atomic_store(&g_pool_stopping, 0);
+
+    pthread_mutex_lock(&pthread_pool.mutex);
+    for (size_t i = 0; i < min; i++) {
+        if (pool_spawn_locked(i) != 0) {
+            pthread_mutex_unlock(&pthread_pool.mutex);
+            core_log_error("Bus pool: cannot start worker %zu", i);
+            return -1;
+        }
+    }
+    pthread_mutex_unlock(&pthread_pool.mutex);
+
+    return 0;
+}
+
+void bus_pool_stop(void)
+{
+    atomic_store(&g_pool_stopping, 1);
+
+    bus_park_notify(&g_pool_not_empty, 1);
+    bus_park_notify(&g_pool_not_full, 1);
+
+    pthread_mutex_lock(&pthread_pool.mutex);
+    for (size_t i = 0; i < pthread_pool.thread_max_count; i++) {
+        if (pthread_pool.thread_map_mask & (1ULL << i)) {
+            pthread_join(pthread_pool.threads[i], NULL);
+        }
+    }
+    pthread_pool.thread_map_mask = 0;
+    atomic_store(&pthread_pool.thread_count, 0);
+    pthread_mutex_unlock(&pthread_pool.mutex);
+}
+
+void bus_pool_destroy(void)
+{
+    for (size_t i = 0; i < pthread_pool.thread_max_count * BUS_LANE_COUNT; i++) {
+        bus_queue_destroy(&pthread_pool.shards[i]);
+    }
+
+    free(pthread_pool.shards);
+    free(pthread_pool.threads);
+    free(pthread_pool.counters);
+    pthread_pool.shards = NULL;
+    pthread_pool.threads = NULL;
+    pthread_pool.counters = NULL;
+    pthread_pool.thread_max_count = 0;
+
+    bus_park_destroy(&g_pool_not_empty);
+    bus_park_destroy(&g_pool_not_full);
+    pthread_mutex_destroy(&pthread_pool.mutex);
+}
+
+// Called after every successful push, grows the pool when the shard backs up
+static inline void pool_note_depth(bus_queue_t *shard, uint32_t lane)
+{
+    const size_t depth = bus_queue_depth(shard);
+    size_t hwm = atomic_load_explicit(&pthread_pool.depth_hwm[lane], memory_order_relaxed);
+
+    while (UNLIKELY(depth > hwm) && !atomic_compare_exchange_weak_explicit(&pthread_pool.depth_hwm[lane],
+            &hwm, depth, memory_order_relaxed, memory_order_relaxed)) {}
+
+    if (UNLIKELY(depth > pthread_pool.grow_depth)) pool_grow();
+}
+
+static int pool_try_submit(const bus_task_t *task)
+{
+    size_t active = atomic_load_explicit(&pthread_pool.thread_count, memory_order_relaxed);
+    if (UNLIKELY(active == 0)) active = 1;
+
+    // Workers keep their own follow-up events local, others round-robin
+    const size_t start = t_worker_slot < active ? t_worker_slot : t_submit_hint++ % active;
+
+    for (size_t i = 0; i < active; i++) {
+        bus_queue_t *shard = pool_shard(task->lane, (start + i) % active);
+
+        if (bus_queue_try_push(shard, task) == 0) {
+            pool_note_depth(shard, task->lane);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+// Every task in the run shares one lane
+static size_t pool_try_submit_n(const bus_task_t *tasks, size_t n)
+{
+    size_t active = atomic_load_explicit(&pthread_pool.thread_count, memory_order_relaxed);
+    if (UNLIKELY(active == 0)) active = 1;
+
+    const size_t start = t_worker_slot < active ? t_worker_slot : t_submit_hint++ % active;
+    size_t pushed = 0;
+
+    for (size_t i = 0; i < active && pushed < n; i++) {
+        bus_queue_t *shard = pool_shard(tasks->lane, (start + i) % active);
+
+        size_t count = bus_queue_try_push_n(shard, tasks + pushed, n - pushed);
+        if (count) pool_note_depth(shard, tasks->lane);
+        pushed += count;
+    }
+
+    return pushed;
+}
+
+static int pool_try_take_lane(size_t self, uint32_t lane, bus_task_t *task)
+{
+    if (LIKELY(bus_queue_try_pop(pool_shard(lane, self), task) == 0)) return 0;
+
+    // Steal, retired slots included so nothing is stranded there
+    const size_t count = pthread_pool.thread_max_count;
+    for (size_t i = 1; i < count; i++) {
+        if (bus_queue_try_pop(pool_shard(lane, (self + i) % count), task) == 0) return 0;
+    }
+
+    return -1;
+}
+
+static int pool_try_take_deferred(bus_task_t *task)
+{
+    if (LIKELY(atomic_load_explicit(&g_deferred_count, memory_order_acquire) == 0)) return -1;
+
+    pthread_mutex_lock(&g_deferred_mutex);
+
+    bus_pool_node_t *node = g_deferred_head;
+    if (node) {
+        g_deferred_head = node->next;
+        if (!g_deferred_head) g_deferred_tail = NULL;
+        // The node belongs to its owner again once the task is copied out
+        *task = node->task;
+        atomic_fetch_sub_explicit(&g_deferred_count, 1, memory_order_relaxed);
+    }
+
+    pthread_mutex_unlock(&g_deferred_mutex);
+    return node ? 0 : -1;
+}
+
+static int pool_try_take(size_t self, bus_task_t *task)
+{
+    // Deferred tasks only exist while the shards were full, they waited longest
+    if (UNLIKELY(pool_try_take_deferred(task) == 0)) return 0;
+
+    // Aging: a lower lane that sat behind lane_aging pops gets the next turn
+    for (uint32_t lane = 1; lane < BUS_LANE_COUNT; lane++) {
+        if (UNLIKELY(t_lane_pops[lane] >= pthread_pool.lane_aging)) {
+            t_lane_pops[lane] = 0;
+            if (pool_try_take_lane(self, lane, task) == 0) return 0;
+        }
+    }
+
+    for (uint32_t lane = 0; lane < BUS_LANE_COUNT; lane++) {
+        if (pool_try_take_lane(self, lane, task) == 0) {
+            for (uint32_t lower = lane + 1; lower < BUS_LANE_COUNT; lower++) t_lane_pops[lower]++;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+uint64_t bus_pool_record_wait(size_t self, uint32_t lane, uint64_t publish_ns, uint64_t now_ns)
+{
+    bus_pool_lane_counters_t *c = &pthread_pool.counters[self];
+    const uint64_t wait = now_ns > publish_ns ? now_ns - publish_ns : 0;
+
+    atomic_store_explicit(&c->delivered[lane],
+        atomic_load_explicit(&c->delivered[lane], memory_order_relaxed) + 1, memory_order_relaxed);
+    atomic_store_explicit(&c->wait_sum_ns[lane],
+        atomic_load_explicit(&c->wait_sum_ns[lane], memory_order_relaxed) + wait, memory_order_relaxed);
+    if (wait > atomic_load_explicit(&c->wait_max_ns[lane], memory_order_relaxed))
+        atomic_store_explicit(&c->wait_max_ns[lane], wait, memory_order_relaxed);
+
+    return wait;
+}
+
+int bus_pool_submit(const bus_task_t *task, int64_t timeout_ns)
+{
+    uint64_t deadline = 0;
+
+    if (UNLIKELY(atomic_load(&g_pool_stopping))) return BUS_POOL_STOPPED;
+
+    while (pool_try_submit(task) != 0) {
+        pool_grow();
+        if (timeout_ns == 0) return BUS_POOL_FULL;
+        if (timeout_ns > 0 && deadline == 0) deadline = bus_now_ns() + (uint64_t)timeout_ns;
+
+        uint32_t ticket = bus_park_prepare(&g_pool_not_full);
+
+        if (atomic_load(&g_pool_stopping)) {
+            bus_park_cancel(&g_pool_not_full);
+            return BUS_POOL_STOPPED;
+        }
+
+        if (pool_try_submit(task) == 0) {
+            bus_park_cancel(&g_pool_not_full);
+            break;
+        }
+
+        int64_t wait_ns = -1;
+        if (timeout_ns > 0) {
+            const uint64_t now = bus_now_ns();
+            if (now >= deadline) {
+                bus_park_cancel(&g_pool_not_full);
+                return BUS_POOL_FULL;
+            }
+            wait_ns = (int64_t)(deadline - now);
+        }
+
+        bus_park_wait(&g_pool_not_full, ticket, wait_ns);
+    }
+
+    bus_park_notify(&g_pool_not_empty, 0);
+    return 0;
+}
+
+int bus_pool_submit_evict(const bus_task_t *task, void (*evict)(bus_task_t *evicted))
+{
+    if (UNLIKELY(atomic_load(&g_pool_stopping))) return BUS_POOL_STOPPED;
+
+    for (unsigned int attempt = 0; pool_try_submit(task) != 0; attempt++) {
+        // Publishers that stole the freed slots keep winning, give up rather than wait
+        if (attempt == BUS_POOL_EVICT_ATTEMPTS) return BUS_POOL_FULL;
+
+        pool_grow();
+
+        size_t active = atomic_load_explicit(&pthread_pool.thread_count, memory_order_relaxed);
+        if (UNLIKELY(active == 0)) active = 1;
+        const size_t slot = t_worker_slot < active ? t_worker_slot : t_submit_hint % active;
+
+        // Head of a shard is the oldest delivery it holds, the other shards of the lane are tried too
+        bus_task_t evicted;
+        if (pool_try_take_lane(slot, task->lane, &evicted) == 0) evict(&evicted);
+    }
+
+    bus_park_notify(&g_pool_not_empty, 0);
+    return 0;
+}
+
+void bus_pool_defer(bus_pool_node_t *node, const bus_task_t *task)
+{
+    node->task = *task;
+    node->next = NULL;
+
+    pthread_mutex_lock(&g_deferred_mutex);
+
+    if (g_deferred_tail) g_deferred_tail->next = node;
+    else g_deferred_head = node;
+    g_deferred_tail = node;
+    atomic_fetch_add_explicit(&g_deferred_count, 1, memory_order_release);
+
+    pthread_mutex_unlock(&g_deferred_mutex);
+
+    bus_park_notify(&g_pool_not_empty, 0);
+}
+
+static size_t pool_submit_run(const bus_task_t *tasks, size_t n)
+{
+    if (UNLIKELY(atomic_load(&g_pool_stopping))) return 0;
+
+    const size_t pushed = pool_try_submit_n(tasks, n);
+    if (pushed < n) pool_grow();
+    return pushed;
+}
+
+size_t bus_pool_submit_batch(const bus_task_t *tasks, size_t n)
+{
+    size_t queued = 0;
+
+    // Split into runs of one lane each
+    while (queued < n) {
+        size_t run = 1;
+        while (queued + run < n && tasks[queued + run].lane == tasks[queued].lane) run++;
+
+        const size_t count = pool_submit_run(tasks + queued, run);
+        queued += count;
+        if (count < run) break;
+    }
+
+    if (queued) bus_park_notify(&g_pool_not_empty, queued > 1);
+    return queued;
+}
+
+int bus_pool_take(size_t self, bus_task_t *task)
+{
+    t_worker_slot = self;
+
+    while (pool_try_take(self, task) != 0) {
+        uint32_t ticket = bus_park_prepare(&g_pool_not_empty);
+
+        if (pool_try_take(self, task) == 0) {
+            bus_park_cancel(&g_pool_not_empty);
+            break;
+        }
+
+        if (atomic_load(&g_pool_stopping)) {
+            bus_park_cancel(&g_pool_not_empty);
+            return -1;
+        }
+
+        const int64_t timeout = pool_may_retire(self) ? pthread_pool.idle_ns : -1;
+        if (bus_park_wait(&g_pool_not_empty, ticket, timeout) != 0 && pool_retire(self)) {
+            return -1;
+        }
+    }
+
+    bus_park_notify(&g_pool_not_full, 0);
+    return 0;
+}
+
+int bus_pool_drain(bus_task_t *task)
+{
+    if (pool_try_take_deferred(task) == 0) return 0;
+
+    for (size_t i = 0; i < pthread_pool.thread_max_count * BUS_LANE_COUNT; i++) {
+        if (bus_queue_try_pop(&pthread_pool.shards[i], task) == 0) return 0;
+    }
+    return -1;
+}
+
+size_t bus_pool_worker_count(void)
+{
+    return atomic_load(&pthread_pool.thread_count);
+}
+
+size_t bus_pool_depth(void)
+{
+    size_t depth = atomic_load_explicit(&g_deferred_count, memory_order_relaxed);
+    for (size_t i = 0; i < pthread_pool.thread_max_count * BUS_LANE_COUNT; i++) {
+        depth += bus_queue_depth(&pthread_pool.shards[i]);
+    }
+    return depth;
+}
+
+void bus_pool_lane_stats(uint32_t lane, bus_lane_stats_t *out)
+{
+    uint64_t wait_sum = 0;
+
+    memset(out, 0, sizeof(*out));
+    if (lane >= BUS_LANE_COUNT || !pthread_pool.counters) return;
+
+    for (size_t i = 0; i < pthread_pool.thread_max_count; i++) {
+        const bus_pool_lane_counters_t *c = &pthread_pool.counters[i];
+        const uint64_t max = atomic_load_explicit(&c->wait_max_ns[lane], memory_order_relaxed);
+
+        out->depth += bus_queue_depth(pool_shard(lane, i));
+        out->delivered += atomic_load_explicit(&c->delivered[lane], memory_order_relaxed);
+        wait_sum += atomic_load_explicit(&c->wait_sum_ns[lane], memory_order_relaxed);
+        if (max > out->wait_max_ns) out->wait_max_ns = max;
+    }
+
+    out->depth_hwm = atomic_load_explicit(&pthread_pool.depth_hwm[lane], memory_order_relaxed);
+    out->wait_avg_ns = out->delivered ? wait_sum / out->delivered : 0;
+}
@@ -0,0 +1,94 @@
+#ifndef CORECDTL_EVENT_BUS_POOL_H
+#define CORECDTL_EVENT_BUS_POOL_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "event_bus.h"
+#include "event_bus_queue.h"
+
+#define BUS_POOL_MAX_WORKERS 64     // one bit per worker in thread_map_mask
+
+#define BUS_POOL_STOPPED    (-1)
+#define BUS_POOL_FULL       (-2)
+
+#define BUS_POOL_EVICT_ATTEMPTS 4   // evictions before a DROP_OLDEST publish gives up
+
+// Caller-owned storage of a deferred task, see bus_pool_defer
+typedef struct bus_pool_node_s {
+    bus_task_t task;
+    struct bus_pool_node_s *next;
+} bus_pool_node_t;
+
+// Written only by the worker currently holding the slot
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_fast64_t delivered[BUS_LANE_COUNT];
+    atomic_uint_fast64_t wait_sum_ns[BUS_LANE_COUNT];
+    atomic_uint_fast64_t wait_max_ns[BUS_LANE_COUNT];
+} bus_pool_lane_counters_t;
+
+/*
+ * Sharded worker pool: one queue shard per (lane, worker slot).
+ * Publishers spread tasks across the active shards of the task's lane, a
+ * worker drains its own shard first and steals from the others before
+ * moving to the next lane or parking. Lanes are served in strict order,
+ * except that a lower lane gets one turn after lane_aging pops above it.
+ * Slots [0, thread_count) are active, the last one retires after
+ * idle_ms without work as long as thread_count stays above the minimum.
+ */
+struct p_thread_pool {
+    pthread_t *threads;
+    bus_queue_t *shards;            /**< [lane * thread_max_count + slot] */
+    bus_pool_lane_counters_t *counters;
+    size_t thread_min_count;
+    size_t thread_max_count;
+    atomic_size_t thread_count;
+    atomic_size_t depth_hwm[BUS_LANE_COUNT];
+    uint64_t thread_map_mask;       /**< Slots holding a not yet joined thread */
+    size_t grow_depth;
+    int64_t idle_ns;
+    uint32_t lane_aging;
+    int pin_cpus;
+    void *(*worker_fn)(void *);
+    pthread_mutex_t mutex;          /**< Serializes grow / retire / shutdown */
+};
+
+int bus_pool_init(const bus_config_t *config, void *(*worker_fn)(void *));
+// Wakes and joins every worker; they drain their shards before exiting
+void bus_pool_stop(void);
+void bus_pool_destroy(void);
+
+/*
+ * Waits up to timeout_ns while every active shard of the task's lane is
+ * full (< 0 forever, 0 fails fast). Returns 0, BUS_POOL_FULL or
+ * BUS_POOL_STOPPED.
+ */
+int bus_pool_submit(const bus_task_t *task, int64_t timeout_ns);
+// Fails fast like a zero timeout, with one wakeup for the whole run; returns how many were queued, in order
+size_t bus_pool_submit_batch(const bus_task_t *tasks, size_t n);
+/*
+ * Never waits: makes room by popping the oldest task of the lane, from any
+ * shard, and handing it to evict. Returns BUS_POOL_FULL once
+ * BUS_POOL_EVICT_ATTEMPTS evictions did not free a slot for the task.
+ */
+int bus_pool_submit_evict(const bus_task_t *task, void (*evict)(bus_task_t *evicted));
+/*
+ * Queues task outside the shards, on an unbounded list the workers serve
+ * first. Only for tasks that may neither be dropped nor wait for room,
+ * node must stay untouched until a worker took the task.
+ */
+void bus_pool_defer(bus_pool_node_t *node, const bus_task_t *task);
+// Called by worker `self`, -1 tells the worker to exit
+int bus_pool_take(size_t self, bus_task_t *task);
+// Pops leftovers after bus_pool_stop
+int bus_pool_drain(bus_task_t *task);
+
+size_t bus_pool_worker_count(void);
+size_t bus_pool_depth(void);
+// Returns the publish -> now wait it just recorded
+uint64_t bus_pool_record_wait(size_t self, uint32_t lane, uint64_t publish_ns, uint64_t now_ns);
+void bus_pool_lane_stats(uint32_t lane, bus_lane_stats_t *out);
+
+#endif //CORECDTL_EVENT_BUS_POOL_H
@@ -0,0 +1,359 @@
+#include "event_bus_queue.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if OS_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static size_t round_up_pow2(size_t v)
+{
+    size_t p = 2;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+/*
+ *
+ * @brief Lock-free ring backend
+ */
+static int bus_ring_init(bus_ring_t *r, size_t capacity)
+{
+    size_t cap = round_up_pow2(capacity);
+
+    r->slots = malloc(sizeof(bus_ring_slot_t) * cap);
+    if (!r->slots) return -1;
+
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(&r->slots[i].seq, i);
+    }
+
+    r->mask = cap - 1;
+    atomic_init(&r->enqueue_pos, 0);
+    atomic_init(&r->dequeue_pos, 0);
+    return 0;
+}
+
+static int bus_ring_try_push(bus_ring_t *r, const bus_task_t *task)
+{
+    bus_ring_slot_t *slot;
+    size_t pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+
+    for (;;) {
+        slot = &r->slots[pos & r->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&r->enqueue_pos, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1; // full
+        } else {
+            pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    slot->task = *task;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return 0;
+}
+
+// Claims a run of consecutive free slots with a single CAS
+static size_t bus_ring_try_push_n(bus_ring_t *r, const bus_task_t *tasks, size_t n)
+{
+    size_t pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+    size_t count;
+
+    for (;;) {
+        count = 0;
+        while (count < n &&
+               atomic_load_explicit(&r->slots[(pos + count) & r->mask].seq, memory_order_acquire) == pos + count) {
+            count++;
+        }
+
+        if (count == 0) {
+            size_t seq = atomic_load_explicit(&r->slots[pos & r->mask].seq, memory_order_acquire);
+            if ((intptr_t)seq - (intptr_t)pos < 0) return 0; // full
+
+            pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&r->enqueue_pos, &pos, pos + count,
+                memory_order_relaxed, memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        bus_ring_slot_t *slot = &r->slots[(pos + i) & r->mask];
+        slot->task = tasks[i];
+        atomic_store_explicit(&slot->seq, pos + i + 1, memory_order_release);
+    }
+
+    return count;
+}
+
+static int bus_ring_try_pop(bus_ring_t *r, bus_task_t *out)
+{
+    bus_ring_slot_t *slot;
+    size_t pos = atomic_load_explicit(&r->dequeue_pos, memory_order_relaxed);
+
+    for (;;) {
+        slot = &r->slots[pos & r->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&r->dequeue_pos, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1; // empty
+        } else {
+            pos = atomic_load_explicit(&r->dequeue_pos, memory_order_relaxed);
+        }
+    }
+
+    *out = slot->task;
+    atomic_store_explicit(&slot->seq, pos + r->mask + 1, memory_order_release);
+    return 0;
+}
+
+/*
+ *
+ * @brief Mutex backend (single lock around a circular array)
+ */
+static int bus_locked_init(task_event_bus_queue_t *q, size_t capacity)
+{
+    q->tasks = malloc(sizeof(bus_task_t) * capacity);
+    if (!q->tasks) return -1;
+
+    q->capacity = capacity;
+    q->head = 0;
+    q->tail = 0;
+    q->count = 0;
+    pthread_mutex_init(&q->mutex, NULL);
+    return 0;
+}
+
+static int bus_locked_try_push(task_event_bus_queue_t *q, const bus_task_t *task)
+{
+    pthread_mutex_lock(&q->mutex);
+
+    if (q->count == q->capacity) {
+        pthread_mutex_unlock(&q->mutex);
+        return -1;
+    }
+
+    q->tasks[q->tail] = *task;
+    q->tail = (q->tail + 1) % q->capacity;
+    q->count++;
+
+    pthread_mutex_unlock(&q->mutex);
+    return 0;
+}
+
+static size_t bus_locked_try_push_n(task_event_bus_queue_t *q, const bus_task_t *tasks, size_t n)
+{
+    pthread_mutex_lock(&q->mutex);
+
+    size_t count = q->capacity - q->count;
+    if (count > n) count = n;
+
+    for (size_t i = 0; i < count; i++) {
+        q->tasks[q->tail] = tasks[i];
+        q->tail = (q->tail + 1) % q->capacity;
+    }
+    q->count += count;
+
+    pthread_mutex_unlock(&q->mutex);
+    return count;
+}
+
+static int bus_locked_try_pop(task_event_bus_queue_t *q, bus_task_t *out)
+{
+    pthread_mutex_lock(&q->mutex);
+
+    if (q->count == 0) {
+        pthread_mutex_unlock(&q->mutex);
+        return -1;
+    }
+
+    *out = q->tasks[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+
+    pthread_mutex_unlock(&q->mutex);
+    return 0;
+}
+
+/*
+ *
+ * @brief Queue front-end
+ */
+int bus_queue_init(bus_queue_t *q, bus_queue_backend_t backend, size_t capacity)
+{
+    if (capacity == 0) return -1;
+
+    q->backend = backend;
+    if (backend == BUS_QUEUE_BACKEND_RING) return bus_ring_init(&q->ring, capacity);
+    return bus_locked_init(&q->locked, capacity);
+}
+
+void bus_queue_destroy(bus_queue_t *q)
+{
+    if (q->backend == BUS_QUEUE_BACKEND_RING) {
+        free(q->ring.slots);
+        q->ring.slots = NULL;
+    } else {
+        free(q->locked.tasks);
+        q->locked.tasks = NULL;
+        pthread_mutex_destroy(&q->locked.mutex);
+    }
+}
+
+int bus_queue_try_push(bus_queue_t *q, const bus_task_t *task)
+{
+    if (LIKELY(q->backend == BUS_QUEUE_BACKEND_RING)) return bus_ring_try_push(&q->ring, task);
+    return bus_locked_try_push(&q->locked, task);
+}
+
+size_t bus_queue_try_push_n(bus_queue_t *q, const bus_task_t *tasks, size_t n)
+{
+    if (LIKELY(q->backend == BUS_QUEUE_BACKEND_RING)) return bus_ring_try_push_n(&q->ring, tasks, n);
+    return bus_locked_try_push_n(&q->locked, tasks, n);
+}
+
+int bus_queue_try_pop(bus_queue_t *q, bus_task_t *out)
+{
+    if (LIKELY(q->backend == BUS_QUEUE_BACKEND_RING)) return bus_ring_try_pop(&q->ring, out);
+    return bus_locked_try_pop(&q->locked, out);
+}
+
+size_t bus_queue_depth(bus_queue_t *q)
+{
+    if (q->backend == BUS_QUEUE_BACKEND_RING) {
+        size_t tail = atomic_load_explicit(&q->ring.enqueue_pos, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&q->ring.dequeue_pos, memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    pthread_mutex_lock(&q->locked.mutex);
+    size_t count = q->locked.count;
+    pthread_mutex_unlock(&q->locked.mutex);
+    return count;
+}
+
+size_t bus_queue_capacity(const bus_queue_t *q)
+{
+    if (q->backend == BUS_QUEUE_BACKEND_RING) return q->ring.mask + 1;
+    return q->locked.capacity;
+}
+
+/*
+ *
+ * @brief Parking (futex on Linux, condvar elsewhere)
+ */
+void bus_park_init(bus_park_t *p)
+{
+    atomic_init(&p->seq, 0);
+    atomic_init(&p->waiters, 0);
+#if !OS_LINUX
+    pthread_mutex_init(&p->mutex, NULL);
+    pthread_cond_init(&p->cond, NULL);
+#endif
+}
+
+void bus_park_destroy(bus_park_t *p)
+{
+#if !OS_LINUX
+    pthread_mutex_destroy(&p->mutex);
+    pthread_cond_destroy(&p->cond);
+#else
+    (void)p;
+#endif
+}
+
+uint32_t bus_park_prepare(bus_park_t *p)
+{
+    atomic_fetch_add(&p->waiters, 1);
+    return atomic_load(&p->seq);
+}
+
+void bus_park_cancel(bus_park_t *p)
+{
+    atomic_fetch_sub(&p->waiters, 1);
+}
+
+int bus_park_wait(bus_park_t *p, uint32_t ticket, int64_t timeout_ns)
+{
+    int ret = 0;
+
+#if OS_LINUX
+    struct timespec ts;
+    struct timespec *tsp = NULL;
+
+    if (timeout_ns >= 0) {
+        ts.tv_sec = (time_t)(timeout_ns / 1000000000LL);
+        ts.tv_nsec = (long)(timeout_ns % 1000000000LL);
+        tsp = &ts;
+    }
+
+    if (atomic_load(&p->seq) == ticket) {
+        if (syscall(SYS_futex, (uint32_t *)&p->seq, FUTEX_WAIT_PRIVATE, ticket, tsp, NULL, 0) == -1 &&
+            errno == ETIMEDOUT) {
+            ret = -1;
+        }
+    }
+#else
+    pthread_mutex_lock(&p->mutex);
+    if (timeout_ns < 0) {
+        while (atomic_load(&p->seq) == ticket)
+            pthread_cond_wait(&p->cond, &p->mutex);
+    } else {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += (time_t)(timeout_ns / 1000000000LL);
+        ts.tv_nsec += (long)(timeout_ns % 1000000000LL);
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec += 1;
+            ts.tv_nsec -= 1000000000L;
+        }
+        while (atomic_load(&p->seq) == ticket && ret == 0) {
+            if (pthread_cond_timedwait(&p->cond, &p->mutex, &ts) == ETIMEDOUT) ret = -1;
+        }
+    }
+    pthread_mutex_unlock(&p->mutex);
+#endif
+
+    atomic_fetch_sub(&p->waiters, 1);
+    return ret;
+}
+
+void bus_park_notify(bus_park_t *p, int wake_all)
+{
+    atomic_fetch_add(&p->seq, 1);
+    if (atomic_load(&p->waiters) == 0) return;
+
+#if OS_LINUX
+    syscall(SYS_futex, (uint32_t *)&p->seq, FUTEX_WAKE_PRIVATE, wake_all ? INT_MAX : 1, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&p->mutex);
+    if (wake_all)
+        pthread_cond_broadcast(&p->cond);
+    else
+        pthread_cond_signal(&p->cond);
+    pthread_mutex_unlock(&p->mutex);
+#endif
+}
@@ -0,0 +1,71 @@
+#ifndef CORECDTL_EVENT_BUS_QUEUE_H
+#define CORECDTL_EVENT_BUS_QUEUE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "platform.h"
+#include "event_bus.h"
+
+/*
+ * Bounded lock-free MPMC ring (sequence-numbered slots).
+ * Each slot carries the ticket of the lap that may touch it next, so
+ * producers and consumers only contend on their own position counter.
+ */
+typedef struct {
+    _Atomic size_t seq;
+    bus_task_t task;
+} bus_ring_slot_t;
+
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) _Atomic size_t enqueue_pos;
+    _Alignas(CACHE_LINE_SIZE) _Atomic size_t dequeue_pos;
+    _Alignas(CACHE_LINE_SIZE) size_t mask;
+    bus_ring_slot_t *slots;
+} bus_ring_t;
+
+typedef struct {
+    bus_queue_backend_t backend;
+    union {
+        bus_ring_t ring;
+        task_event_bus_queue_t locked;
+    };
+} bus_queue_t;
+
+/*
+ * Parking spot for idle workers / blocked producers.
+ * Linux parks on a futex, other platforms fall back to a condvar.
+ * Usage: ticket = prepare(); re-check condition; wait(ticket) or cancel().
+ */
+typedef struct {
+    _Atomic uint32_t seq;
+    _Atomic uint32_t waiters;
+#if !OS_LINUX
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+#endif
+} bus_park_t;
+
+int bus_queue_init(bus_queue_t *q, bus_queue_backend_t backend, size_t capacity);
+void bus_queue_destroy(bus_queue_t *q);
+
+// returns 0 on success, -1 when the queue is full / empty
+int bus_queue_try_push(bus_queue_t *q, const bus_task_t *task);
+int bus_queue_try_pop(bus_queue_t *q, bus_task_t *out);
+// Pushes a prefix of tasks in one reservation, returns how many went in
+size_t bus_queue_try_push_n(bus_queue_t *q, const bus_task_t *tasks, size_t n);
+
+size_t bus_queue_depth(bus_queue_t *q);
+size_t bus_queue_capacity(const bus_queue_t *q);
+
+void bus_park_init(bus_park_t *p);
+void bus_park_destroy(bus_park_t *p);
+uint32_t bus_park_prepare(bus_park_t *p);
+void bus_park_cancel(bus_park_t *p);
+// timeout_ns < 0 waits forever, returns -1 on timeout
+int bus_park_wait(bus_park_t *p, uint32_t ticket, int64_t timeout_ns);
+void bus_park_notify(bus_park_t *p, int wake_all);
+
+#endif //CORECDTL_EVENT_BUS_QUEUE_H
@@ -0,0 +1,238 @@
+#include "event_bus_quota.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "platform.h"
+
+#define BUS_QUOTA_CHUNK_SIZE (1U << BUS_QUOTA_CHUNK_BITS)
+
+typedef struct {
+    _Atomic uint64_t tat;           /**< Theoretical arrival time of the next publish */
+    _Atomic uint64_t interval_ns;   /**< 1 / rate, 0 = unlimited */
+    _Atomic uint64_t tolerance_ns;  /**< burst * interval, how far tat may run ahead of now */
+    _Atomic uint64_t max_delay_ns;
+    atomic_uint action;
+} bus_quota_bucket_t;
+
+typedef struct {
+    bus_quota_bucket_t all;
+    bus_quota_bucket_t topics[BUS_QUOTA_MAX_TOPICS];
+    atomic_uint topic_ids[BUS_QUOTA_MAX_TOPICS];
+    atomic_uint topic_count;        /**< Slots are appended under g_quota_mutex and never reused */
+    atomic_uint_fast64_t rejected;
+    atomic_uint_fast64_t dropped;
+    atomic_uint_fast64_t delayed;
+} bus_quota_plugin_t;
+
+// Two levels like the stats tables, plugins without a quota cost one load
+typedef struct {
+    _Atomic(bus_quota_plugin_t *) plugins[BUS_QUOTA_CHUNK_SIZE];
+} bus_quota_chunk_t;
+
+static _Atomic(bus_quota_chunk_t *) g_quota_chunks[BUS_QUOTA_CHUNK_SIZE];
+static atomic_uint g_quota_id_limit = 0;
+static pthread_mutex_t g_quota_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static bus_quota_plugin_t *plugin_find(plugin_id_t plugin_id)
+{
+    if (UNLIKELY(plugin_id >= BUS_QUOTA_MAX_PLUGIN_ID)) return NULL;
+
+    bus_quota_chunk_t *chunk = atomic_load_explicit(&g_quota_chunks[plugin_id >> BUS_QUOTA_CHUNK_BITS],
+        memory_order_acquire);
+    if (LIKELY(!chunk)) return NULL;
+
+    return atomic_load_explicit(&chunk->plugins[plugin_id & (BUS_QUOTA_CHUNK_SIZE - 1)], memory_order_acquire);
+}
+
+// g_quota_mutex held
+static bus_quota_plugin_t *plugin_get_locked(plugin_id_t plugin_id)
+{
+    bus_quota_plugin_t *rec = plugin_find(plugin_id);
+    if (rec) return rec;
+
+    _Atomic(bus_quota_chunk_t *) *chunk_ptr = &g_quota_chunks[plugin_id >> BUS_QUOTA_CHUNK_BITS];
+    bus_quota_chunk_t *chunk = atomic_load_explicit(chunk_ptr, memory_order_relaxed);
+    if (!chunk) {
+        chunk = calloc(1, sizeof(bus_quota_chunk_t));
+        if (!chunk) return NULL;
+        atomic_store_explicit(chunk_ptr, chunk, memory_order_release);
+    }
+
+    rec = calloc(1, sizeof(bus_quota_plugin_t));
+    if (!rec) return NULL;
+    atomic_store_explicit(&chunk->plugins[plugin_id & (BUS_QUOTA_CHUNK_SIZE - 1)], rec, memory_order_release);
+
+    if (plugin_id >= atomic_load_explicit(&g_quota_id_limit, memory_order_relaxed))
+        atomic_store_explicit(&g_quota_id_limit, (unsigned int)plugin_id + 1, memory_order_relaxed);
+    return rec;
+}
+
+static bus_quota_bucket_t *topic_find(bus_quota_plugin_t *rec, event_id_t topic)
+{
+    const unsigned int count = atomic_load_explicit(&rec->topic_count, memory_order_acquire);
+
+    for (unsigned int i = 0; i < count; i++) {
+        if (atomic_load_explicit(&rec->topic_ids[i], memory_order_relaxed) == topic) return &rec->topics[i];
+    }
+    return NULL;
+}
+
+// Publishers racing a reconfiguration may see old and new parameters mixed, for one token at most
+static void bucket_configure(bus_quota_bucket_t *b, const bus_quota_t *quota)
+{
+    const uint64_t interval = quota->rate ? 1000000000ULL / quota->rate : 0;
+    const uint64_t burst = quota->burst ? quota->burst : quota->rate;
+    const uint32_t max_delay_ms = quota->max_delay_ms ? quota->max_delay_ms : BUS_QUOTA_DEFAULT_DELAY_MS;
+
+    atomic_store_explicit(&b->action, (unsigned int)quota->action, memory_order_relaxed);
+    atomic_store_explicit(&b->max_delay_ns, (uint64_t)max_delay_ms * 1000000ULL, memory_order_relaxed);
+    atomic_store_explicit(&b->tolerance_ns, burst * interval, memory_order_relaxed);
+    atomic_store_explicit(&b->interval_ns, interval, memory_order_release);
+}
+
+int bus_quota_set(plugin_id_t plugin_id, event_id_t topic, const bus_quota_t *quota)
+{
+    if (!quota || plugin_id == PLUGIN_ID_INVALID || plugin_id >= BUS_QUOTA_MAX_PLUGIN_ID) return -1;
+    if (quota->action > BUS_QUOTA_DELAY || quota->rate > 1000000000U) return -1;
+
+    pthread_mutex_lock(&g_quota_mutex);
+
+    bus_quota_plugin_t *rec = plugin_get_locked(plugin_id);
+    if (!rec) {
+        pthread_mutex_unlock(&g_quota_mutex);
+        return -1;
+    }
+
+    bus_quota_bucket_t *bucket = &rec->all;
+    if (topic != EVENT_ID_INVALID) {
+        bucket = topic_find(rec, topic);
+
+        if (!bucket) {
+            const unsigned int count = atomic_load_explicit(&rec->topic_count, memory_order_relaxed);
+            if (count == BUS_QUOTA_MAX_TOPICS) {
+                pthread_mutex_unlock(&g_quota_mutex);
+                return -1;
+            }
+
+            // Configured before it becomes visible, no publisher sees a blank bucket
+            bucket = &rec->topics[count];
+            bucket_configure(bucket, quota);
+            atomic_store_explicit(&rec->topic_ids[count], topic, memory_order_relaxed);
+            atomic_store_explicit(&rec->topic_count, count + 1, memory_order_release);
+
+            pthread_mutex_unlock(&g_quota_mutex);
+            return 0;
+        }
+    }
+
+    bucket_configure(bucket, quota);
+    pthread_mutex_unlock(&g_quota_mutex);
+    return 0;
+}
+
+static int bucket_take(bus_quota_bucket_t *b, uint64_t now, int can_wait, uint64_t *delay_ns)
+{
+    const uint64_t interval = atomic_load_explicit(&b->interval_ns, memory_order_acquire);
+    if (LIKELY(interval == 0)) return BUS_QUOTA_PASS;
+
+    const uint64_t tolerance = atomic_load_explicit(&b->tolerance_ns, memory_order_relaxed);
+    uint64_t tat = atomic_load_explicit(&b->tat, memory_order_relaxed);
+
+    for (;;) {
+        const uint64_t next = (tat > now ? tat : now) + interval;
+        uint64_t wait = 0;
+
+        if (next - now > tolerance) {
+            const unsigned int action = atomic_load_explicit(&b->action, memory_order_relaxed);
+            wait = next - now - tolerance;
+
+            if (action != BUS_QUOTA_DELAY || !can_wait ||
+                wait > atomic_load_explicit(&b->max_delay_ns, memory_order_relaxed))
+                return action == BUS_QUOTA_DROP ? BUS_QUOTA_DROPPED : BUS_QUOTA_REJECTED;
+        }
+
+        // A delayed publish reserves its slot now, later ones queue up behind it
+        if (atomic_compare_exchange_weak_explicit(&b->tat, &tat, next, memory_order_relaxed, memory_order_relaxed)) {
+            *delay_ns = wait;
+            return BUS_QUOTA_PASS;
+        }
+    }
+}
+
+// Gives back a token taken by bucket_take when the other bucket refused the publish
+static inline void bucket_refund(bus_quota_bucket_t *b)
+{
+    const uint64_t interval = atomic_load_explicit(&b->interval_ns, memory_order_relaxed);
+    if (interval) atomic_fetch_sub_explicit(&b->tat, interval, memory_order_relaxed);
+}
+
+int bus_quota_admit(plugin_id_t plugin_id, event_id_t topic, int can_wait, uint64_t *delay_ns)
+{
+    *delay_ns = 0;
+
+    bus_quota_plugin_t *rec = plugin_find(plugin_id);
+    if (LIKELY(!rec)) return BUS_QUOTA_PASS;
+
+    const uint64_t now = bus_now_ns();
+    bus_quota_bucket_t *topic_bucket = topic != EVENT_ID_INVALID ? topic_find(rec, topic) : NULL;
+    uint64_t topic_delay = 0;
+    uint64_t plugin_delay = 0;
+    int verdict = BUS_QUOTA_PASS;
+
+    if (topic_bucket) verdict = bucket_take(topic_bucket, now, can_wait, &topic_delay);
+    if (verdict == BUS_QUOTA_PASS) {
+        verdict = bucket_take(&rec->all, now, can_wait, &plugin_delay);
+        if (verdict != BUS_QUOTA_PASS && topic_bucket) bucket_refund(topic_bucket);
+    }
+
+    switch (verdict) {
+        case BUS_QUOTA_DROPPED:
+            atomic_fetch_add_explicit(&rec->dropped, 1, memory_order_relaxed);
+            return verdict;
+        case BUS_QUOTA_REJECTED:
+            atomic_fetch_add_explicit(&rec->rejected, 1, memory_order_relaxed);
+            return verdict;
+        default:
+            break;
+    }
+
+    *delay_ns = topic_delay > plugin_delay ? topic_delay : plugin_delay;
+    if (*delay_ns) atomic_fetch_add_explicit(&rec->delayed, 1, memory_order_relaxed);
+    return BUS_QUOTA_PASS;
+}
+
+int bus_quota_stats(plugin_id_t plugin_id, bus_quota_stats_t *out)
+{
+    const bus_quota_plugin_t *rec = plugin_find(plugin_id);
+    if (!rec) return -1;
+
+    out->rejected = atomic_load_explicit(&rec->rejected, memory_order_relaxed);
+    out->dropped = atomic_load_explicit(&rec->dropped, memory_order_relaxed);
+    out->delayed = atomic_load_explicit(&rec->delayed, memory_order_relaxed);
+    return 0;
+}
+
+uint32_t bus_quota_id_limit(void)
+{
+    return atomic_load_explicit(&g_quota_id_limit, memory_order_relaxed);
+}
+
+void bus_quota_destroy(void)
+{
+    pthread_mutex_lock(&g_quota_mutex);
+
+    for (size_t c = 0; c < BUS_QUOTA_CHUNK_SIZE; c++) {
+        bus_quota_chunk_t *chunk = atomic_exchange(&g_quota_chunks[c], NULL);
+        if (!chunk) continue;
+
+        for (size_t i = 0; i < BUS_QUOTA_CHUNK_SIZE; i++) {
+            free(atomic_load_explicit(&chunk->plugins[i], memory_order_relaxed));
+        }
+        free(chunk);
+    }
+    atomic_store(&g_quota_id_limit, 0);
+
+    pthread_mutex_unlock(&g_quota_mutex);
+}
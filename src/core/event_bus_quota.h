@@ -0,0 +1,40 @@
+#ifndef CORECDTL_EVENT_BUS_QUOTA_H
+#define CORECDTL_EVENT_BUS_QUOTA_H
+
+#include <stdint.h>
+
+#include "event_bus.h"
+
+/*
+ * Publish quotas: one token bucket per plugin and per (plugin, topic).
+ *
+ * A bucket is kept as GCRA, a single theoretical arrival time advanced by
+ * CAS: a publish is admitted while that time stays within burst intervals
+ * of now, which behaves like a token bucket without a refill timer. Plugin
+ * records are allocated on first configuration and live until
+ * bus_quota_destroy, reconfiguring only swaps a bucket's parameters, so the
+ * publish path never takes a lock.
+ */
+#define BUS_QUOTA_CHUNK_BITS        8
+#define BUS_QUOTA_MAX_PLUGIN_ID     (1U << (2 * BUS_QUOTA_CHUNK_BITS))  // plugins at or above cannot get a quota
+#define BUS_QUOTA_MAX_TOPICS        16      // topic quotas per plugin
+#define BUS_QUOTA_DEFAULT_DELAY_MS  100
+
+#define BUS_QUOTA_PASS      0
+#define BUS_QUOTA_DROPPED   1
+#define BUS_QUOTA_REJECTED  2
+
+// topic = EVENT_ID_INVALID for the plugin-wide bucket, quota->rate = 0 lifts the limit
+int bus_quota_set(plugin_id_t plugin_id, event_id_t topic, const bus_quota_t *quota);
+/*
+ * Takes a token of the topic's and of the plugin's bucket. On BUS_QUOTA_PASS
+ * *delay_ns is how long the caller has to wait before publishing, the token
+ * is already reserved. Without can_wait a delay policy rejects instead.
+ */
+int bus_quota_admit(plugin_id_t plugin_id, event_id_t topic, int can_wait, uint64_t *delay_ns);
+int bus_quota_stats(plugin_id_t plugin_id, bus_quota_stats_t *out);
+// Exclusive upper bound of the plugin ids that ever got a quota
+uint32_t bus_quota_id_limit(void);
+void bus_quota_destroy(void);
+
+#endif //CORECDTL_EVENT_BUS_QUOTA_H
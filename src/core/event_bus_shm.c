@@ -0,0 +1,656 @@
+#define _GNU_SOURCE // memfd_create
+#include "event_bus_shm.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+
+#if OS_LINUX
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BUS_SHM_ALIGN CACHE_LINE_SIZE
+
+static inline size_t shm_align(size_t v)
+{
+    return (v + BUS_SHM_ALIGN - 1) & ~(size_t)(BUS_SHM_ALIGN - 1);
+}
+
+/*
+ *
+ * @brief Shared ring, same code on both sides of the mapping
+ */
+// Layout of one ring inside the mapping, kept privately so the peer cannot resize it under us
+typedef struct {
+    bus_shm_ring_t *ring;
+    unsigned char *slots;
+    uint32_t slot_size;
+    uint64_t mask;
+} bus_shm_view_t;
+
+static inline bus_shm_slot_t *shm_slot(const bus_shm_view_t *v, uint64_t pos)
+{
+    return (bus_shm_slot_t *)(v->slots + (size_t)(pos & v->mask) * v->slot_size);
+}
+
+static inline int shm_fits(const bus_shm_view_t *v, size_t name_len, size_t len)
+{
+    return name_len <= UINT16_MAX && sizeof(bus_shm_slot_t) + name_len + len <= v->slot_size;
+}
+
+static void shm_ring_notify(bus_shm_ring_t *ring)
+{
+    atomic_fetch_add(&ring->signal, 1);
+    if (atomic_load(&ring->waiters) == 0) return;
+
+    // Not FUTEX_PRIVATE: the waiter may live in the other process
+    syscall(SYS_futex, (uint32_t *)&ring->signal, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static int shm_ring_push(const bus_shm_view_t *v, uint16_t kind, uint32_t sub_id, int32_t status,
+    const char *name, size_t name_len, const void *data, size_t len)
+{
+    uint64_t pos = atomic_load_explicit(&v->ring->enqueue_pos, memory_order_relaxed);
+    bus_shm_slot_t *slot;
+
+    // The peer may have set enqueue_pos or seq to anything, a publisher must not spin on it forever
+    for (int retries = 0;; retries++) {
+        if (UNLIKELY(retries == BUS_SHM_MAX_RETRIES)) return -1;
+
+        slot = shm_slot(v, pos);
+        const uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        const int64_t diff = (int64_t)(seq - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&v->ring->enqueue_pos, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return -1;
+        } else {
+            pos = atomic_load_explicit(&v->ring->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    slot->kind = kind;
+    slot->name_len = (uint16_t)name_len;
+    slot->sub_id = sub_id;
+    slot->len = (uint32_t)len;
+    slot->status = status;
+    if (name_len) memcpy(slot->data, name, name_len);
+    if (len) memcpy(slot->data + name_len, data, len);
+
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    shm_ring_notify(v->ring);
+    return 0;
+}
+
+// Claims the oldest message, it stays in the ring until shm_ring_release
+static bus_shm_slot_t *shm_ring_claim(const bus_shm_view_t *v, uint64_t *pos_out)
+{
+    uint64_t pos = atomic_load_explicit(&v->ring->dequeue_pos, memory_order_relaxed);
+
+    for (int retries = 0;; retries++) {
+        if (UNLIKELY(retries == BUS_SHM_MAX_RETRIES)) {
+            // Same as a push, a corrupted dequeue_pos costs this round and is counted
+            atomic_fetch_add_explicit(&v->ring->dropped, 1, memory_order_relaxed);
+            return NULL;
+        }
+
+        bus_shm_slot_t *slot = shm_slot(v, pos);
+        const uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        const int64_t diff = (int64_t)(seq - (pos + 1));
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&v->ring->dequeue_pos, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                *pos_out = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            pos = atomic_load_explicit(&v->ring->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+static inline void shm_ring_release(const bus_shm_view_t *v, bus_shm_slot_t *slot, uint64_t pos)
+{
+    atomic_store_explicit(&slot->seq, pos + v->mask + 1, memory_order_release);
+}
+
+static inline int shm_ring_empty(const bus_shm_view_t *v)
+{
+    const uint64_t pos = atomic_load_explicit(&v->ring->dequeue_pos, memory_order_relaxed);
+    return atomic_load_explicit(&shm_slot(v, pos)->seq, memory_order_acquire) != pos + 1;
+}
+
+static void shm_ring_wait(const bus_shm_view_t *v, int timeout_ms)
+{
+    struct timespec ts;
+    struct timespec *tsp = NULL;
+
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+        tsp = &ts;
+    }
+
+    atomic_fetch_add(&v->ring->waiters, 1);
+    const uint32_t ticket = atomic_load(&v->ring->signal);
+    if (shm_ring_empty(v)) {
+        syscall(SYS_futex, (uint32_t *)&v->ring->signal, FUTEX_WAIT, ticket, tsp, NULL, 0);
+    }
+    atomic_fetch_sub(&v->ring->waiters, 1);
+}
+
+static void shm_view_init(bus_shm_view_t *v, unsigned char *base, uint64_t offset, uint32_t slot_size,
+    uint32_t slot_count)
+{
+    v->ring = (bus_shm_ring_t *)(base + offset);
+    v->slots = base + offset + shm_align(sizeof(bus_shm_ring_t));
+    v->slot_size = slot_size;
+    v->mask = (uint64_t)slot_count - 1;
+}
+
+/*
+ *
+ * @brief Core side: one service thread per channel
+ */
+struct bus_shm_channel_s;
+
+// user pointer of a remote subscription
+typedef struct bus_shm_route_s {
+    struct bus_shm_channel_s *channel;
+    uint32_t sub_id;
+    char *event;                /**< To unsubscribe once the channel closes */
+    struct bus_shm_route_s *next;
+} bus_shm_route_t;
+
+typedef struct bus_shm_channel_s {
+    int fd;
+    unsigned char *base;
+    size_t size;
+    plugin_id_t plugin_id;
+    bus_shm_header_t *header;
+    bus_shm_view_t to_core;
+    bus_shm_view_t to_remote;
+    atomic_int closed;
+    int running;                /**< Service thread not joined yet */
+    pthread_t thread;
+    bus_shm_route_t *routes;    /**< Service thread only, freed with the channel */
+    struct bus_shm_channel_s *next;
+} bus_shm_channel_t;
+
+static bus_shm_channel_t *g_shm_channels = NULL;
+static pthread_mutex_t g_shm_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void bus_shm_forward(const void *data, size_t len, void *user)
+{
+    bus_shm_route_t *route = user;
+    bus_shm_channel_t *channel = route->channel;
+
+    if (UNLIKELY(atomic_load_explicit(&channel->closed, memory_order_acquire))) return;
+
+    if (UNLIKELY(!shm_fits(&channel->to_remote, 0, len) ||
+            shm_ring_push(&channel->to_remote, BUS_SHM_MSG_DELIVER, route->sub_id, 0, NULL, 0, data, len) != 0)) {
+        atomic_fetch_add_explicit(&channel->to_remote.ring->dropped, 1, memory_order_relaxed);
+    }
+}
+
+static int bus_shm_subscribe(bus_shm_channel_t *channel, uint32_t sub_id, const char *event)
+{
+    if (sub_id >= BUS_SHM_MAX_SUBS) return BUS_SUB_ERR_INVALID_CB;
+
+    // The remote is not trusted to hand out each id once, unique ids keep routes at BUS_SHM_MAX_SUBS
+    for (const bus_shm_route_t *r = channel->routes; r; r = r->next) {
+        if (r->sub_id == sub_id) return BUS_SUB_ERR_DUPLICATE;
+    }
+
+    bus_shm_route_t *route = malloc(sizeof(bus_shm_route_t));
+    if (!route) return BUS_SUB_ERR_ALLOC_FAILED;
+
+    route->channel = channel;
+    route->sub_id = sub_id;
+    route->event = strdup(event);
+    if (!route->event) {
+        free(route);
+        return BUS_SUB_ERR_STRDUP_FAILED;
+    }
+
+    // Forwarding is one memcpy into the ring, no reason to hop through a worker
+    const bus_sub_opts_t opts = { .priority = BUS_PRIORITY_INHERIT, .direct = 1 };
+    const int ret = bus_subscribe_ex(channel->plugin_id, event, bus_shm_forward, route, &opts);
+    if (ret != 0) {
+        free(route->event);
+        free(route);
+        return ret;
+    }
+
+    route->next = channel->routes;
+    channel->routes = route;
+    return 0;
+}
+
+static void bus_shm_ack(bus_shm_channel_t *channel, uint32_t sub_id, int32_t status)
+{
+    // The remote waits on it, so unlike deliveries it is retried until there is room
+    while (shm_ring_push(&channel->to_remote, BUS_SHM_MSG_ACK, sub_id, status, NULL, 0, NULL, 0) != 0) {
+        if (atomic_load(&channel->closed)) return;
+        struct timespec ts = { .tv_sec = 0, .tv_nsec = 1000000L };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static void *bus_shm_service(void *arg)
+{
+    bus_shm_channel_t *channel = arg;
+    char *name = malloc((size_t)channel->to_core.slot_size + 1);
+    if (!name) return NULL;
+
+    while (!atomic_load_explicit(&channel->closed, memory_order_acquire)) {
+        uint64_t pos;
+        bus_shm_slot_t *slot = shm_ring_claim(&channel->to_core, &pos);
+        if (!slot) {
+            shm_ring_wait(&channel->to_core, BUS_SHM_IDLE_MS);
+            continue;
+        }
+
+        // The peer can still scribble on the slot, read each header field exactly once and bound everything by it
+        const volatile bus_shm_slot_t *head = slot;
+        const uint16_t kind = head->kind;
+        const size_t name_len = head->name_len;
+        const size_t len = head->len;
+        const uint32_t sub_id = head->sub_id;
+
+        if (name_len > 0 && shm_fits(&channel->to_core, name_len, len)) {
+            memcpy(name, slot->data, name_len);
+            name[name_len] = '\0';
+
+            switch (kind) {
+                case BUS_SHM_MSG_SUBSCRIBE:
+                    bus_shm_ack(channel, sub_id, -bus_shm_subscribe(channel, sub_id, name));
+                    break;
+                case BUS_SHM_MSG_PUBLISH:
+                    bus_publish(channel->plugin_id, name, slot->data + name_len, len);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        shm_ring_release(&channel->to_core, slot, pos);
+    }
+
+    // Publishers stop seeing the remote's subscriptions, the routes go with the channel
+    for (bus_shm_route_t *route = channel->routes; route; route = route->next) {
+        bus_unsubscribe(channel->plugin_id, route->event, bus_shm_forward, route);
+    }
+
+    free(name);
+    return NULL;
+}
+
+static uint32_t shm_round_up_pow2(size_t v)
+{
+    uint32_t p = 2;
+    while (p < v && p < (1U << 30)) p <<= 1;
+    return p;
+}
+
+int bus_shm_open(plugin_id_t plugin_id, size_t slot_size, size_t slot_count)
+{
+    if (plugin_id == PLUGIN_ID_INVALID) return -1;
+    if (slot_size == 0) slot_size = BUS_SHM_DEFAULT_SLOT;
+    if (slot_count == 0) slot_count = BUS_SHM_DEFAULT_SLOTS;
+
+    const size_t stride = shm_align(sizeof(bus_shm_slot_t) + slot_size);
+    if (stride > UINT32_MAX) return -1;
+
+    const uint32_t count = shm_round_up_pow2(slot_count);
+    const size_t ring_bytes = shm_align(sizeof(bus_shm_ring_t)) + (size_t)count * stride;
+    const size_t header_bytes = shm_align(sizeof(bus_shm_header_t));
+    const size_t size = header_bytes + 2 * ring_bytes;
+
+    bus_shm_channel_t *channel = calloc(1, sizeof(bus_shm_channel_t));
+    if (!channel) return -1;
+
+    channel->fd = memfd_create("corecdtl-bus", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (channel->fd < 0) {
+        free(channel);
+        return -1;
+    }
+
+    // Sealed so the remote cannot shrink the file and fault us with SIGBUS
+    if (ftruncate(channel->fd, (off_t)size) != 0 ||
+        fcntl(channel->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        close(channel->fd);
+        free(channel);
+        return -1;
+    }
+
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, channel->fd, 0);
+    if (base == MAP_FAILED) {
+        close(channel->fd);
+        free(channel);
+        return -1;
+    }
+
+    channel->base = base;
+    channel->size = size;
+    channel->plugin_id = plugin_id;
+    channel->header = (bus_shm_header_t *)channel->base;
+
+    bus_shm_header_t *header = channel->header;
+    header->magic = BUS_SHM_MAGIC;
+    header->version = BUS_SHM_VERSION;
+    header->slot_size = (uint32_t)stride;
+    header->slot_count = count;
+    header->plugin_id = plugin_id;
+    header->to_core_offset = header_bytes;
+    header->to_remote_offset = header_bytes + ring_bytes;
+    header->size = size;
+
+    shm_view_init(&channel->to_core, channel->base, header->to_core_offset, (uint32_t)stride, count);
+    shm_view_init(&channel->to_remote, channel->base, header->to_remote_offset, (uint32_t)stride, count);
+
+    // memfd pages start zeroed, only the slot laps need setting
+    for (uint64_t i = 0; i < count; i++) {
+        atomic_store_explicit(&shm_slot(&channel->to_core, i)->seq, i, memory_order_relaxed);
+        atomic_store_explicit(&shm_slot(&channel->to_remote, i)->seq, i, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_release);
+
+    if (pthread_create(&channel->thread, NULL, bus_shm_service, channel) != 0) {
+        munmap(channel->base, channel->size);
+        close(channel->fd);
+        free(channel);
+        return -1;
+    }
+    channel->running = 1;
+
+    pthread_mutex_lock(&g_shm_mutex);
+    channel->next = g_shm_channels;
+    g_shm_channels = channel;
+    pthread_mutex_unlock(&g_shm_mutex);
+
+    return channel->fd;
+}
+
+// g_shm_mutex held
+static void bus_shm_close_locked(bus_shm_channel_t *channel)
+{
+    atomic_store_explicit(&channel->closed, 1, memory_order_release);
+    atomic_store_explicit(&channel->header->closed, 1, memory_order_release);
+    shm_ring_notify(channel->to_core.ring);
+    shm_ring_notify(channel->to_remote.ring);
+
+    if (channel->running) {
+        pthread_join(channel->thread, NULL);
+        channel->running = 0;
+    }
+
+    // The mapping stays until the channel is freed
+    if (channel->fd >= 0) {
+        close(channel->fd);
+        channel->fd = -1;
+    }
+}
+
+// Closed first, the service thread has dropped every subscription pointing at it by then
+static void bus_shm_free(bus_shm_channel_t *channel)
+{
+    bus_shm_route_t *route = channel->routes;
+    while (route) {
+        bus_shm_route_t *next = route->next;
+        free(route->event);
+        free(route);
+        route = next;
+    }
+    munmap(channel->base, channel->size);
+    free(channel);
+}
+
+int bus_shm_close(int fd)
+{
+    if (fd < 0) return -1;
+
+    pthread_mutex_lock(&g_shm_mutex);
+    bus_shm_channel_t **link = &g_shm_channels;
+    while (*link && (*link)->fd != fd) link = &(*link)->next;
+
+    bus_shm_channel_t *channel = *link;
+    if (channel) {
+        *link = channel->next;
+        bus_shm_close_locked(channel);
+        bus_shm_free(channel);
+    }
+    pthread_mutex_unlock(&g_shm_mutex);
+
+    return channel ? 0 : -1;
+}
+
+void bus_shm_stop(void)
+{
+    pthread_mutex_lock(&g_shm_mutex);
+    for (bus_shm_channel_t *channel = g_shm_channels; channel; channel = channel->next) {
+        bus_shm_close_locked(channel);
+    }
+    pthread_mutex_unlock(&g_shm_mutex);
+}
+
+void bus_shm_destroy(void)
+{
+    bus_shm_stop();
+
+    pthread_mutex_lock(&g_shm_mutex);
+    bus_shm_channel_t *channel = g_shm_channels;
+    while (channel) {
+        bus_shm_channel_t *next = channel->next;
+        bus_shm_free(channel);
+        channel = next;
+    }
+    g_shm_channels = NULL;
+    pthread_mutex_unlock(&g_shm_mutex);
+}
+
+/*
+ *
+ * @brief Remote side
+ */
+typedef struct {
+    bus_cb_t cb;
+    void *user;
+    atomic_int status;
+} bus_shm_client_sub_t;
+
+struct bus_shm_client_s {
+    unsigned char *base;
+    size_t size;
+    bus_shm_header_t *header;
+    bus_shm_view_t to_core;
+    bus_shm_view_t to_remote;
+    atomic_uint sub_count;
+    bus_shm_client_sub_t subs[BUS_SHM_MAX_SUBS];
+};
+
+bus_shm_client_t *bus_shm_attach(int fd)
+{
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(bus_shm_header_t)) return NULL;
+
+    const size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) return NULL;
+
+    const bus_shm_header_t *header = base;
+    const uint32_t count = header->slot_count;
+    const size_t ring_bytes = shm_align(sizeof(bus_shm_ring_t)) + (size_t)count * header->slot_size;
+
+    if (header->magic != BUS_SHM_MAGIC || header->version != BUS_SHM_VERSION || header->size != size ||
+        count == 0 || (count & (count - 1)) != 0 || header->slot_size < sizeof(bus_shm_slot_t) ||
+        header->to_core_offset + ring_bytes > size || header->to_remote_offset + ring_bytes > size) {
+        munmap(base, size);
+        return NULL;
+    }
+
+    bus_shm_client_t *client = calloc(1, sizeof(bus_shm_client_t));
+    if (!client) {
+        munmap(base, size);
+        return NULL;
+    }
+
+    client->base = base;
+    client->size = size;
+    client->header = base;
+    shm_view_init(&client->to_core, client->base, header->to_core_offset, header->slot_size, count);
+    shm_view_init(&client->to_remote, client->base, header->to_remote_offset, header->slot_size, count);
+
+    return client;
+}
+
+void bus_shm_detach(bus_shm_client_t *client)
+{
+    if (!client) return;
+
+    munmap(client->base, client->size);
+    free(client);
+}
+
+static inline int shm_client_closed(const bus_shm_client_t *client)
+{
+    return atomic_load_explicit(&client->header->closed, memory_order_acquire) != 0;
+}
+
+int bus_shm_client_subscribe(bus_shm_client_t *client, const char *event, bus_cb_t cb, void *user)
+{
+    if (!client || !event || !cb || shm_client_closed(client)) return -1;
+
+    const size_t name_len = strlen(event);
+    if (name_len == 0 || !shm_fits(&client->to_core, name_len, 0)) return -1;
+
+    const unsigned int sub_id = atomic_fetch_add(&client->sub_count, 1);
+    if (sub_id >= BUS_SHM_MAX_SUBS) return -1;
+
+    bus_shm_client_sub_t *sub = &client->subs[sub_id];
+    sub->cb = cb;
+    sub->user = user;
+    atomic_store(&sub->status, 0);
+
+    if (shm_ring_push(&client->to_core, BUS_SHM_MSG_SUBSCRIBE, sub_id, 0, event, name_len, NULL, 0) != 0) {
+        atomic_store(&sub->status, -BUS_PUBLISH_ERR_QUEUE_FULL);
+        return -1;
+    }
+    return (int)sub_id;
+}
+
+int bus_shm_client_sub_status(const bus_shm_client_t *client, int sub_id)
+{
+    if (!client || sub_id < 0 || sub_id >= BUS_SHM_MAX_SUBS) return -1;
+    return atomic_load(&client->subs[sub_id].status);
+}
+
+int bus_shm_client_publish(bus_shm_client_t *client, const char *event, const void *data, size_t len)
+{
+    if (UNLIKELY(!client || !event)) return BUS_PUBLISH_ERR_INVALID_PLUGIN_ID;
+    if (UNLIKELY(!data)) return BUS_PUBLISH_ERR_INVALID_DATA;
+
+    const size_t name_len = strlen(event);
+    if (UNLIKELY(len == 0 || name_len == 0 || !shm_fits(&client->to_core, name_len, len)))
+        return BUS_PUBLISH_ERR_INVALID_LENGTH;
+    if (UNLIKELY(shm_client_closed(client))) return BUS_PUBLISH_ERR_EVENT_NOT_FOUND;
+
+    if (shm_ring_push(&client->to_core, BUS_SHM_MSG_PUBLISH, 0, 0, event, name_len, data, len) != 0)
+        return BUS_PUBLISH_ERR_QUEUE_FULL;
+    return 0;
+}
+
+int bus_shm_client_poll(bus_shm_client_t *client, int timeout_ms)
+{
+    if (!client) return -1;
+
+    int handled = 0;
+    int waited = 0;
+
+    // At most one lap per call so a busy channel cannot pin the caller
+    while ((uint64_t)handled <= client->to_remote.mask) {
+        uint64_t pos;
+        bus_shm_slot_t *slot = shm_ring_claim(&client->to_remote, &pos);
+
+        if (!slot) {
+            if (handled || waited || timeout_ms == 0) break;
+            if (shm_client_closed(client)) return -1;
+
+            shm_ring_wait(&client->to_remote, timeout_ms);
+            waited = 1;
+            continue;
+        }
+
+        const uint32_t sub_id = slot->sub_id;
+        if (sub_id < BUS_SHM_MAX_SUBS) {
+            bus_shm_client_sub_t *sub = &client->subs[sub_id];
+
+            if (slot->kind == BUS_SHM_MSG_ACK) {
+                atomic_store(&sub->status, slot->status == 0 ? 1 : slot->status);
+            } else if (slot->kind == BUS_SHM_MSG_DELIVER && sub->cb) {
+                sub->cb(slot->data + slot->name_len, slot->len, sub->user);
+            }
+        }
+
+        shm_ring_release(&client->to_remote, slot, pos);
+        handled++;
+    }
+
+    if (!handled && shm_client_closed(client)) return -1;
+    return handled;
+}
+
+#else
+
+int bus_shm_open(plugin_id_t plugin_id, size_t slot_size, size_t slot_count)
+{
+    (void)plugin_id; (void)slot_size; (void)slot_count;
+    core_log_error("Event bus shared memory transport needs Linux");
+    return -1;
+}
+
+int bus_shm_close(int fd) { (void)fd; return -1; }
+void bus_shm_stop(void) {}
+void bus_shm_destroy(void) {}
+
+bus_shm_client_t *bus_shm_attach(int fd) { (void)fd; return NULL; }
+void bus_shm_detach(bus_shm_client_t *client) { (void)client; }
+
+int bus_shm_client_subscribe(bus_shm_client_t *client, const char *event, bus_cb_t cb, void *user)
+{
+    (void)client; (void)event; (void)cb; (void)user;
+    return -1;
+}
+
+int bus_shm_client_sub_status(const bus_shm_client_t *client, int sub_id)
+{
+    (void)client; (void)sub_id;
+    return -1;
+}
+
+int bus_shm_client_publish(bus_shm_client_t *client, const char *event, const void *data, size_t len)
+{
+    (void)client; (void)event; (void)data; (void)len;
+    return -1;
+}
+
+int bus_shm_client_poll(bus_shm_client_t *client, int timeout_ms)
+{
+    (void)client; (void)timeout_ms;
+    return -1;
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef CORECDTL_EVENT_BUS_SHM_H
+#define CORECDTL_EVENT_BUS_SHM_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "platform.h"
+#include "event_bus.h"
+
+/*
+ * Shared-memory transport for out-of-process plugins.
+ *
+ * A channel is one memfd holding two bounded MPSC rings: to_core carries
+ * the remote's subscribe / publish requests, to_remote carries deliveries.
+ * Messages are written once into a ring slot and read in place on the
+ * other side, sleeping consumers park on a process-shared futex in the
+ * ring header. The remote gets the fd by fork / exec or SCM_RIGHTS and
+ * talks to it with the bus_shm_client_* calls below.
+ *
+ * Remote subscriptions are ordinary bus subscriptions of the channel's
+ * plugin_id with direct delivery, so topic and wildcard semantics match
+ * bus_subscribe / bus_publish exactly. A delivery that finds to_remote
+ * full is dropped and counted in the ring's dropped counter. Ring positions
+ * are writable by both processes, so no side retries a claim more than
+ * BUS_SHM_MAX_RETRIES times: what gives up is dropped and counted too.
+ */
+#define BUS_SHM_MAGIC           0x4D485343U     // "CSHM"
+#define BUS_SHM_VERSION         1
+#define BUS_SHM_DEFAULT_SLOT    512
+#define BUS_SHM_DEFAULT_SLOTS   1024
+#define BUS_SHM_MAX_SUBS        64              // per channel
+#define BUS_SHM_IDLE_MS         100             // service thread re-checks for close
+#define BUS_SHM_MAX_RETRIES     64              // lost races on a ring position before giving up
+
+typedef enum {
+    BUS_SHM_MSG_SUBSCRIBE = 1,  /**< remote -> core: name = event, sub_id picked by the remote */
+    BUS_SHM_MSG_PUBLISH,        /**< remote -> core: name = event, payload */
+    BUS_SHM_MSG_ACK,            /**< core -> remote: status of SUBSCRIBE sub_id */
+    BUS_SHM_MSG_DELIVER         /**< core -> remote: payload for sub_id */
+} bus_shm_msg_kind_t;
+
+// One ring slot, a message is written straight into it and read in place
+typedef struct {
+    _Atomic uint64_t seq;       /**< Lap ticket, see bus_ring_t */
+    uint16_t kind;              /**< bus_shm_msg_kind_t */
+    uint16_t name_len;
+    uint32_t sub_id;
+    uint32_t len;               /**< Payload bytes after the name */
+    int32_t status;
+    unsigned char data[];       /**< name, then payload */
+} bus_shm_slot_t;
+
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint64_t enqueue_pos;
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint64_t dequeue_pos;
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint32_t signal;     // futex word
+    _Atomic uint32_t waiters;
+    _Atomic uint64_t dropped;
+} bus_shm_ring_t;
+
+// Start of the mapping, every field is fixed size so both sides agree
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_size;         /**< Stride of a slot, bus_shm_slot_t included */
+    uint32_t slot_count;        /**< Power of two */
+    plugin_id_t plugin_id;
+    _Atomic uint32_t closed;
+    uint64_t to_core_offset;
+    uint64_t to_remote_offset;
+    uint64_t size;
+} bus_shm_header_t;
+
+/* === Core side === */
+/*
+ * Creates a channel acting as plugin_id and starts its service thread.
+ * slot_size bounds name + payload of one message. Returns the memfd to hand
+ * to the remote process, or -1.
+ */
+int bus_shm_open(plugin_id_t plugin_id, size_t slot_size, size_t slot_count);
+// Stops serving the channel, removes the remote's subscriptions and frees it
+int bus_shm_close(int fd);
+// Joins every service thread, must run before the worker pool stops
+void bus_shm_stop(void);
+void bus_shm_destroy(void);
+
+/* === Remote side === */
+typedef struct bus_shm_client_s bus_shm_client_t;
+
+bus_shm_client_t *bus_shm_attach(int fd);
+void bus_shm_detach(bus_shm_client_t *client);
+// Asynchronous, returns the sub_id (>= 0), the ACK shows up on a later poll
+int bus_shm_client_subscribe(bus_shm_client_t *client, const char *event, bus_cb_t cb, void *user);
+// 0 = still pending, 1 = active, < 0 = the bus rejected it
+int bus_shm_client_sub_status(const bus_shm_client_t *client, int sub_id);
+int bus_shm_client_publish(bus_shm_client_t *client, const char *event, const void *data, size_t len);
+/*
+ * Runs callbacks for pending deliveries straight out of the ring, waits up
+ * to timeout_ms (< 0 forever) when there are none. Returns how many
+ * messages were handled, -1 once the core closed the channel.
+ */
+int bus_shm_client_poll(bus_shm_client_t *client, int timeout_ms);
+
+#endif //CORECDTL_EVENT_BUS_SHM_H
@@ -0,0 +1,295 @@
+#include "event_bus_slab.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "platform.h"
+
+#define BUS_SLAB_LARGE          UINT32_MAX
+#define BUS_SLAB_MAX_BLOCK      (BUS_SLAB_MIN_BLOCK << (BUS_SLAB_CLASS_COUNT - 1))
+#define BUS_SLAB_MIN_PER_CHUNK  4
+
+typedef struct bus_slab_cache_s bus_slab_cache_t;
+
+typedef struct {
+    union {
+        bus_slab_cache_t *owner;
+        size_t large_size;
+    };
+    uint32_t size_class;
+    uint32_t reserved;
+} bus_slab_header_t;
+
+_Static_assert(sizeof(bus_slab_header_t) == 16, "Slab header must keep payloads 16-byte aligned");
+
+// Overlays the header while a block sits on a free list
+typedef struct bus_slab_free_s {
+    struct bus_slab_free_s *next;
+} bus_slab_free_t;
+
+typedef struct bus_slab_chunk_s {
+    struct bus_slab_chunk_s *next;
+    size_t size;
+} bus_slab_chunk_t;
+
+struct bus_slab_cache_s {
+    bus_slab_free_t *local[BUS_SLAB_CLASS_COUNT];
+    _Alignas(CACHE_LINE_SIZE) _Atomic(bus_slab_free_t *) remote[BUS_SLAB_CLASS_COUNT];
+
+    // Single writer (the owning thread), read by bus_slab_get_stats
+    _Alignas(CACHE_LINE_SIZE) atomic_uint_fast64_t hits;
+    atomic_uint_fast64_t misses;
+    atomic_uint_fast64_t remote_frees;
+    atomic_uint_fast64_t bytes_alloc;
+    atomic_uint_fast64_t bytes_freed;
+
+    int abandoned;
+    bus_slab_cache_t *next;
+};
+
+static pthread_mutex_t g_slab_mtx = PTHREAD_MUTEX_INITIALIZER;
+static bus_slab_cache_t *g_caches = NULL;
+static bus_slab_chunk_t *g_chunks = NULL;
+static uint64_t g_bytes_reserved = 0;
+static atomic_uint g_slab_generation = 1;
+
+static pthread_key_t g_slab_key;
+static pthread_once_t g_slab_once = PTHREAD_ONCE_INIT;
+
+static __thread bus_slab_cache_t *t_cache = NULL;
+static __thread unsigned int t_generation = 0;
+
+static inline void slab_count(atomic_uint_fast64_t *counter, uint64_t n)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n,
+        memory_order_relaxed);
+}
+
+static inline size_t slab_class_size(uint32_t size_class)
+{
+    return (size_t)BUS_SLAB_MIN_BLOCK << size_class;
+}
+
+static inline uint32_t slab_class_of(size_t total)
+{
+    if (total <= BUS_SLAB_MIN_BLOCK) return 0;
+    return (uint32_t)(64 - __builtin_clzll((unsigned long long)(total - 1))) - 6;
+}
+
+static void slab_thread_exit(void *arg)
+{
+    pthread_mutex_lock(&g_slab_mtx);
+    // The cache may belong to a destroyed generation, only touch live ones
+    for (bus_slab_cache_t *it = g_caches; it; it = it->next) {
+        if (it == arg) {
+            it->abandoned = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_slab_mtx);
+}
+
+static void slab_key_create(void)
+{
+    pthread_key_create(&g_slab_key, slab_thread_exit);
+}
+
+static bus_slab_cache_t *slab_cache_get(void)
+{
+    const unsigned int generation = atomic_load_explicit(&g_slab_generation, memory_order_relaxed);
+    if (LIKELY(t_cache && t_generation == generation)) return t_cache;
+
+    pthread_once(&g_slab_once, slab_key_create);
+
+    pthread_mutex_lock(&g_slab_mtx);
+
+    bus_slab_cache_t *cache = g_caches;
+    while (cache && !cache->abandoned) cache = cache->next;
+
+    if (cache) {
+        // Adopt the cache of an exited thread, its blocks are still owned by it
+        cache->abandoned = 0;
+    } else {
+        cache = calloc(1, sizeof(bus_slab_cache_t));
+        if (!cache) {
+            pthread_mutex_unlock(&g_slab_mtx);
+            return NULL;
+        }
+        cache->next = g_caches;
+        g_caches = cache;
+    }
+
+    pthread_mutex_unlock(&g_slab_mtx);
+
+    t_cache = cache;
+    t_generation = generation;
+    pthread_setspecific(g_slab_key, cache);
+    return cache;
+}
+
+static bus_slab_free_t *slab_refill(bus_slab_cache_t *cache, uint32_t size_class)
+{
+    const size_t block = slab_class_size(size_class);
+    size_t count = BUS_SLAB_CHUNK_SIZE / block;
+    if (count < BUS_SLAB_MIN_PER_CHUNK) count = BUS_SLAB_MIN_PER_CHUNK;
+
+    const size_t size = sizeof(bus_slab_chunk_t) + block * count;
+    bus_slab_chunk_t *chunk = malloc(size);
+    if (UNLIKELY(!chunk)) return NULL;
+
+    chunk->size = size;
+
+    pthread_mutex_lock(&g_slab_mtx);
+    chunk->next = g_chunks;
+    g_chunks = chunk;
+    g_bytes_reserved += size;
+    pthread_mutex_unlock(&g_slab_mtx);
+
+    unsigned char *base = (unsigned char *)(chunk + 1);
+    bus_slab_free_t *head = NULL;
+
+    for (size_t i = count; i > 0; i--) {
+        bus_slab_free_t *node = (bus_slab_free_t *)(base + (i - 1) * block);
+        node->next = head;
+        head = node;
+    }
+
+    cache->local[size_class] = head;
+    return head;
+}
+
+int bus_slab_init(void)
+{
+    pthread_once(&g_slab_once, slab_key_create);
+    return 0;
+}
+
+void bus_slab_destroy(void)
+{
+    pthread_mutex_lock(&g_slab_mtx);
+
+    bus_slab_chunk_t *chunk = g_chunks;
+    while (chunk) {
+        bus_slab_chunk_t *n = chunk->next;
+        free(chunk);
+        chunk = n;
+    }
+    g_chunks = NULL;
+    g_bytes_reserved = 0;
+
+    bus_slab_cache_t *cache = g_caches;
+    while (cache) {
+        bus_slab_cache_t *n = cache->next;
+        free(cache);
+        cache = n;
+    }
+    g_caches = NULL;
+
+    // Invalidates every thread's t_cache
+    atomic_fetch_add(&g_slab_generation, 1);
+
+    pthread_mutex_unlock(&g_slab_mtx);
+}
+
+void *bus_slab_alloc(size_t size)
+{
+    bus_slab_cache_t *cache = slab_cache_get();
+    if (UNLIKELY(!cache)) return NULL;
+
+    const size_t total = size + sizeof(bus_slab_header_t);
+    bus_slab_header_t *hdr;
+
+    if (UNLIKELY(total > BUS_SLAB_MAX_BLOCK)) {
+        hdr = malloc(total);
+        if (!hdr) return NULL;
+
+        hdr->large_size = total;
+        hdr->size_class = BUS_SLAB_LARGE;
+        slab_count(&cache->misses, 1);
+        slab_count(&cache->bytes_alloc, total);
+        return hdr + 1;
+    }
+
+    const uint32_t size_class = slab_class_of(total);
+    bus_slab_free_t *node = cache->local[size_class];
+
+    if (UNLIKELY(!node)) {
+        node = atomic_exchange_explicit(&cache->remote[size_class], NULL, memory_order_acquire);
+        cache->local[size_class] = node;
+    }
+
+    if (LIKELY(node != NULL)) {
+        slab_count(&cache->hits, 1);
+    } else {
+        node = slab_refill(cache, size_class);
+        if (UNLIKELY(!node)) return NULL;
+        slab_count(&cache->misses, 1);
+    }
+
+    cache->local[size_class] = node->next;
+
+    hdr = (bus_slab_header_t *)node;
+    hdr->owner = cache;
+    hdr->size_class = size_class;
+    slab_count(&cache->bytes_alloc, slab_class_size(size_class));
+    return hdr + 1;
+}
+
+void bus_slab_free(void *ptr)
+{
+    if (UNLIKELY(!ptr)) return;
+
+    bus_slab_header_t *hdr = (bus_slab_header_t *)ptr - 1;
+    bus_slab_cache_t *cache = slab_cache_get();
+
+    if (UNLIKELY(hdr->size_class == BUS_SLAB_LARGE)) {
+        if (cache) slab_count(&cache->bytes_freed, hdr->large_size);
+        free(hdr);
+        return;
+    }
+
+    bus_slab_cache_t *owner = hdr->owner;
+    const uint32_t size_class = hdr->size_class;
+    bus_slab_free_t *node = (bus_slab_free_t *)hdr;
+
+    if (cache) slab_count(&cache->bytes_freed, slab_class_size(size_class));
+
+    if (LIKELY(owner == cache)) {
+        node->next = cache->local[size_class];
+        cache->local[size_class] = node;
+        return;
+    }
+
+    node->next = atomic_load_explicit(&owner->remote[size_class], memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&owner->remote[size_class], &node->next, node,
+            memory_order_release, memory_order_relaxed)) {
+    }
+
+    if (cache) slab_count(&cache->remote_frees, 1);
+}
+
+void bus_slab_get_stats(bus_slab_stats_t *out)
+{
+    if (!out) return;
+
+    uint64_t alloc = 0;
+    uint64_t freed = 0;
+
+    out->hits = 0;
+    out->misses = 0;
+    out->remote_frees = 0;
+
+    pthread_mutex_lock(&g_slab_mtx);
+    for (bus_slab_cache_t *it = g_caches; it; it = it->next) {
+        out->hits += atomic_load_explicit(&it->hits, memory_order_relaxed);
+        out->misses += atomic_load_explicit(&it->misses, memory_order_relaxed);
+        out->remote_frees += atomic_load_explicit(&it->remote_frees, memory_order_relaxed);
+        alloc += atomic_load_explicit(&it->bytes_alloc, memory_order_relaxed);
+        freed += atomic_load_explicit(&it->bytes_freed, memory_order_relaxed);
+    }
+    out->bytes_reserved = g_bytes_reserved;
+    pthread_mutex_unlock(&g_slab_mtx);
+
+    out->bytes_in_use = alloc > freed ? alloc - freed : 0;
+}
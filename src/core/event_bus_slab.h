@@ -0,0 +1,34 @@
+#ifndef CORECDTL_EVENT_BUS_SLAB_H
+#define CORECDTL_EVENT_BUS_SLAB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Size-class slab allocator for event payloads.
+ *
+ * Every thread owns a cache with one free list per class. A block freed
+ * by another thread (publisher mallocs, worker frees) goes onto the
+ * owner's lock-free remote list and is pulled back on its next miss.
+ */
+#define BUS_SLAB_MIN_BLOCK      64
+#define BUS_SLAB_CLASS_COUNT    11      // 64 B .. 64 KB
+#define BUS_SLAB_CHUNK_SIZE     (256 * 1024)
+
+typedef struct {
+    uint64_t hits;              /**< Served from a thread cache */
+    uint64_t misses;            /**< Needed a fresh chunk or a large malloc */
+    uint64_t remote_frees;      /**< Blocks returned by a foreign thread */
+    uint64_t bytes_in_use;      /**< Block bytes currently handed out */
+    uint64_t bytes_reserved;    /**< Chunk bytes obtained from the system */
+} bus_slab_stats_t;
+
+int bus_slab_init(void);
+void bus_slab_destroy(void);
+
+void *bus_slab_alloc(size_t size);
+void bus_slab_free(void *ptr);
+
+void bus_slab_get_stats(bus_slab_stats_t *out);
+
+#endif //CORECDTL_EVENT_BUS_SLAB_H
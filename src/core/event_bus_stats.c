@@ -0,0 +1,227 @@
+#include "event_bus_stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+
+#define BUS_STATS_CHUNK_SIZE (1U << BUS_STATS_CHUNK_BITS)
+
+// Two levels so a sparse id space only pays for the chunks it touches
+typedef struct {
+    _Atomic(bus_hist_pair_t *) pairs[BUS_STATS_CHUNK_SIZE];
+} bus_stats_chunk_t;
+
+typedef struct {
+    _Atomic(bus_stats_chunk_t *) chunks[BUS_STATS_CHUNK_SIZE];
+    atomic_uint id_limit;
+} bus_stats_table_t;
+
+// One table per slot like g_slot_hists, so hot topics do not bounce a shared line between workers
+static _Atomic(bus_hist_pair_t *) g_slot_hists[BUS_STATS_INLINE_SLOT + 1];
+static bus_stats_table_t g_topic_hists[BUS_STATS_INLINE_SLOT + 1];
+static bus_stats_table_t g_plugin_hists[BUS_STATS_INLINE_SLOT + 1];
+
+static inline size_t hist_bucket(uint64_t v)
+{
+    if (v < BUS_HIST_SUB_COUNT) return (size_t)v;
+
+    const unsigned int e = 63U - (unsigned int)__builtin_clzll(v);
+    if (UNLIKELY(e >= BUS_HIST_MAX_BITS)) return BUS_HIST_BUCKETS - 1;
+
+    return (e - BUS_HIST_SUB_BITS + 1) * BUS_HIST_SUB_COUNT + ((v >> (e - BUS_HIST_SUB_BITS)) & (BUS_HIST_SUB_COUNT - 1));
+}
+
+// Highest value that still falls into bucket i
+static inline uint64_t hist_bucket_high(size_t i)
+{
+    if (i < BUS_HIST_SUB_COUNT) return i;
+
+    const size_t group = i / BUS_HIST_SUB_COUNT;
+    const uint64_t sub = i % BUS_HIST_SUB_COUNT;
+    return ((BUS_HIST_SUB_COUNT + sub + 1) << (group - 1)) - 1;
+}
+
+// Allocates on first use, racing writers keep whichever pair landed first
+static bus_hist_pair_t *pair_get(_Atomic(bus_hist_pair_t *) *ptr)
+{
+    bus_hist_pair_t *pair = atomic_load_explicit(ptr, memory_order_acquire);
+    if (LIKELY(pair)) return pair;
+
+    bus_hist_pair_t *fresh = calloc(1, sizeof(bus_hist_pair_t));
+    if (!fresh) return NULL;
+
+    if (atomic_compare_exchange_strong_explicit(ptr, &pair, fresh, memory_order_acq_rel, memory_order_acquire)) {
+        return fresh;
+    }
+    free(fresh);
+    return pair;
+}
+
+static bus_hist_pair_t *table_get(bus_stats_table_t *table, uint32_t id, int create)
+{
+    if (UNLIKELY(id >= BUS_STATS_MAX_ID)) return NULL;
+
+    _Atomic(bus_stats_chunk_t *) *chunk_ptr = &table->chunks[id >> BUS_STATS_CHUNK_BITS];
+    bus_stats_chunk_t *chunk = atomic_load_explicit(chunk_ptr, memory_order_acquire);
+
+    if (!chunk) {
+        if (!create) return NULL;
+
+        bus_stats_chunk_t *fresh = calloc(1, sizeof(bus_stats_chunk_t));
+        if (!fresh) return NULL;
+
+        if (atomic_compare_exchange_strong_explicit(chunk_ptr, &chunk, fresh,
+                memory_order_acq_rel, memory_order_acquire)) {
+            chunk = fresh;
+        } else {
+            free(fresh);
+        }
+    }
+
+    _Atomic(bus_hist_pair_t *) *ptr = &chunk->pairs[id & (BUS_STATS_CHUNK_SIZE - 1)];
+    if (!create) return atomic_load_explicit(ptr, memory_order_acquire);
+
+    unsigned int limit = atomic_load_explicit(&table->id_limit, memory_order_relaxed);
+    while (limit <= id && !atomic_compare_exchange_weak_explicit(&table->id_limit, &limit, id + 1,
+            memory_order_relaxed, memory_order_relaxed)) {}
+
+    return pair_get(ptr);
+}
+
+static inline void hist_add_owned(bus_hist_t *h, uint64_t v)
+{
+    atomic_uint_fast64_t *c = &h->counts[hist_bucket(v)];
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+static inline void hist_add_shared(bus_hist_t *h, uint64_t v)
+{
+    atomic_fetch_add_explicit(&h->counts[hist_bucket(v)], 1, memory_order_relaxed);
+}
+
+static inline void pair_add(bus_hist_pair_t *pair, size_t slot, uint64_t wait_ns, uint64_t exec_ns)
+{
+    if (LIKELY(slot != BUS_STATS_INLINE_SLOT)) {
+        hist_add_owned(&pair->wait, wait_ns);
+        hist_add_owned(&pair->exec, exec_ns);
+    } else {
+        hist_add_shared(&pair->wait, wait_ns);
+        hist_add_shared(&pair->exec, exec_ns);
+    }
+}
+
+void bus_stats_record(size_t slot, event_id_t topic, plugin_id_t plugin_id, uint64_t wait_ns, uint64_t exec_ns)
+{
+    if (slot > BUS_STATS_INLINE_SLOT) slot = BUS_STATS_INLINE_SLOT;
+
+    bus_hist_pair_t *pair = pair_get(&g_slot_hists[slot]);
+    if (LIKELY(pair)) pair_add(pair, slot, wait_ns, exec_ns);
+
+    if (topic != EVENT_ID_INVALID && (pair = table_get(&g_topic_hists[slot], topic, 1))) {
+        pair_add(pair, slot, wait_ns, exec_ns);
+    }
+
+    if ((pair = table_get(&g_plugin_hists[slot], plugin_id, 1))) {
+        pair_add(pair, slot, wait_ns, exec_ns);
+    }
+}
+
+static void hist_summarize(const uint64_t *counts, bus_latency_summary_t *out)
+{
+    memset(out, 0, sizeof(*out));
+
+    for (size_t i = 0; i < BUS_HIST_BUCKETS; i++) {
+        out->count += counts[i];
+    }
+    if (out->count == 0) return;
+
+    const uint64_t p50 = (out->count * 500 + 999) / 1000;
+    const uint64_t p90 = (out->count * 900 + 999) / 1000;
+    const uint64_t p99 = (out->count * 990 + 999) / 1000;
+    const uint64_t p999 = (out->count * 999 + 999) / 1000;
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < BUS_HIST_BUCKETS; i++) {
+        if (!counts[i]) continue;
+
+        const uint64_t before = seen;
+        const uint64_t high = hist_bucket_high(i);
+        seen += counts[i];
+
+        if (before < p50 && seen >= p50) out->p50_ns = high;
+        if (before < p90 && seen >= p90) out->p90_ns = high;
+        if (before < p99 && seen >= p99) out->p99_ns = high;
+        if (before < p999 && seen >= p999) out->p999_ns = high;
+        out->max_ns = high;
+    }
+}
+
+static void hist_accumulate(const bus_hist_t *h, uint64_t *counts)
+{
+    for (size_t i = 0; i < BUS_HIST_BUCKETS; i++) {
+        counts[i] += atomic_load_explicit(&h->counts[i], memory_order_relaxed);
+    }
+}
+
+int bus_stats_summary(bus_stats_scope_t scope, uint32_t id, bus_latency_stats_t *out)
+{
+    uint64_t wait[BUS_HIST_BUCKETS] = { 0 };
+    uint64_t exec[BUS_HIST_BUCKETS] = { 0 };
+    const bus_hist_pair_t *pair;
+
+    if (scope != BUS_STATS_ALL && scope != BUS_STATS_TOPIC && scope != BUS_STATS_PLUGIN) return -1;
+
+    for (size_t i = 0; i <= BUS_STATS_INLINE_SLOT; i++) {
+        switch (scope) {
+            case BUS_STATS_ALL: pair = atomic_load_explicit(&g_slot_hists[i], memory_order_acquire); break;
+            case BUS_STATS_TOPIC: pair = table_get(&g_topic_hists[i], id, 0); break;
+            default: pair = table_get(&g_plugin_hists[i], id, 0); break;
+        }
+        if (!pair) continue;
+
+        hist_accumulate(&pair->wait, wait);
+        hist_accumulate(&pair->exec, exec);
+    }
+
+    hist_summarize(wait, &out->wait);
+    hist_summarize(exec, &out->exec);
+    return out->wait.count ? 0 : -1;
+}
+
+uint32_t bus_stats_id_limit(bus_stats_scope_t scope)
+{
+    if (scope != BUS_STATS_TOPIC && scope != BUS_STATS_PLUGIN) return 0;
+
+    const bus_stats_table_t *tables = scope == BUS_STATS_TOPIC ? g_topic_hists : g_plugin_hists;
+    uint32_t limit = 0;
+
+    for (size_t i = 0; i <= BUS_STATS_INLINE_SLOT; i++) {
+        const uint32_t slot_limit = atomic_load_explicit(&tables[i].id_limit, memory_order_relaxed);
+        if (slot_limit > limit) limit = slot_limit;
+    }
+    return limit;
+}
+
+static void table_destroy(bus_stats_table_t *table)
+{
+    for (size_t c = 0; c < BUS_STATS_CHUNK_SIZE; c++) {
+        bus_stats_chunk_t *chunk = atomic_exchange(&table->chunks[c], NULL);
+        if (!chunk) continue;
+
+        for (size_t i = 0; i < BUS_STATS_CHUNK_SIZE; i++) {
+            free(atomic_load_explicit(&chunk->pairs[i], memory_order_relaxed));
+        }
+        free(chunk);
+    }
+    atomic_store(&table->id_limit, 0);
+}
+
+void bus_stats_destroy(void)
+{
+    for (size_t i = 0; i <= BUS_STATS_INLINE_SLOT; i++) {
+        free(atomic_exchange(&g_slot_hists[i], NULL));
+        table_destroy(&g_topic_hists[i]);
+        table_destroy(&g_plugin_hists[i]);
+    }
+}
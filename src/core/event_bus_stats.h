@@ -0,0 +1,47 @@
+#ifndef CORECDTL_EVENT_BUS_STATS_H
+#define CORECDTL_EVENT_BUS_STATS_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "event_bus.h"
+#include "event_bus_pool.h"
+
+/*
+ * Log-linear (HDR style) histogram: values below BUS_HIST_SUB_COUNT get a
+ * bucket each, every power of two above is split into BUS_HIST_SUB_COUNT
+ * buckets, so a bucket is never wider than 1/8 of its value.
+ */
+#define BUS_HIST_SUB_BITS   3
+#define BUS_HIST_SUB_COUNT  (1U << BUS_HIST_SUB_BITS)
+#define BUS_HIST_MAX_BITS   36      // ~68 s, longer samples land in the last bucket
+#define BUS_HIST_BUCKETS    ((BUS_HIST_MAX_BITS - BUS_HIST_SUB_BITS + 1) * BUS_HIST_SUB_COUNT)
+
+#define BUS_STATS_CHUNK_BITS    8
+#define BUS_STATS_MAX_ID        (1U << (2 * BUS_STATS_CHUNK_BITS))  // topic / plugin ids at or above are not tracked
+#define BUS_STATS_INLINE_SLOT   BUS_POOL_MAX_WORKERS                // shared by publishers delivering inline
+
+typedef struct {
+    atomic_uint_fast64_t counts[BUS_HIST_BUCKETS];
+} bus_hist_t;
+
+typedef struct {
+    bus_hist_t wait;
+    bus_hist_t exec;
+} bus_hist_pair_t;
+
+/*
+ * Histograms are allocated on first use and live until bus_stats_destroy.
+ * Every slot keeps its own overall, per-topic and per-plugin histograms: a
+ * worker slot has a single writer and skips the atomic RMW, only the inline
+ * slot is shared and uses relaxed fetch_add. Readers merge the slots with
+ * relaxed loads and never stop the bus.
+ */
+void bus_stats_destroy(void);
+void bus_stats_record(size_t slot, event_id_t topic, plugin_id_t plugin_id, uint64_t wait_ns, uint64_t exec_ns);
+int bus_stats_summary(bus_stats_scope_t scope, uint32_t id, bus_latency_stats_t *out);
+// Exclusive upper bound of the ids recorded so far in scope
+uint32_t bus_stats_id_limit(bus_stats_scope_t scope);
+
+#endif //CORECDTL_EVENT_BUS_STATS_H
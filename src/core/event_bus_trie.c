@@ -0,0 +1,281 @@
+#include "event_bus_trie.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "event_bus_epoch.h"
+#include "platform.h"
+
+// Never modified in place, adding a child publishes a copy
+typedef struct {
+    size_t count;
+    struct bus_trie_node_s *nodes[];
+} bus_trie_children_t;
+
+/*
+ * Nodes are never freed before bus_trie_destroy, a node's segment is fixed
+ * once it is reachable. Children and subscriber lists are swapped under the
+ * index mutex and the old copies retired, so readers only need an epoch.
+ */
+struct bus_trie_node_s {
+    char *segment;
+    size_t segment_len;
+    _Atomic(bus_trie_children_t *) children;    // literal segments
+    _Atomic(struct bus_trie_node_s *) any;      // '*' child
+    _Atomic(bus_sub_list_t *) subs;             // patterns ending on this node
+    _Atomic(bus_sub_list_t *) subs_all;         // patterns ending on this node + ".#"
+};
+
+static inline size_t segment_len(const char *s)
+{
+    const char *end = strchr(s, BUS_TOPIC_SEPARATOR);
+    return end ? (size_t)(end - s) : strlen(s);
+}
+
+int bus_topic_is_pattern(const char *name)
+{
+    if (UNLIKELY(!name)) return -1;
+
+    int pattern = 0;
+    int empty = 0;
+
+    for (const char *seg = name;; ) {
+        const size_t len = segment_len(seg);
+        const int last = seg[len] == '\0';
+
+        if (len == 0) empty = 1;
+
+        for (size_t i = 0; i < len; i++) {
+            if (seg[i] != BUS_TOPIC_WILDCARD_ONE && seg[i] != BUS_TOPIC_WILDCARD_ALL) continue;
+            if (len != 1) return -1;
+            if (seg[i] == BUS_TOPIC_WILDCARD_ALL && !last) return -1;
+            pattern = 1;
+        }
+
+        if (last) break;
+        seg += len + 1;
+    }
+
+    if (pattern && empty) return -1;
+    return pattern;
+}
+
+static bus_trie_node_t *trie_child(const bus_trie_node_t *node, const char *seg, size_t len)
+{
+    if (len == 1 && seg[0] == BUS_TOPIC_WILDCARD_ONE) return atomic_load_explicit(&node->any, memory_order_acquire);
+
+    const bus_trie_children_t *children = atomic_load_explicit(&node->children, memory_order_acquire);
+    for (size_t i = 0; children && i < children->count; i++) {
+        bus_trie_node_t *child = children->nodes[i];
+        if (child->segment_len == len && memcmp(child->segment, seg, len) == 0) return child;
+    }
+    return NULL;
+}
+
+// Index mutex held
+static bus_trie_node_t *trie_add_child(bus_trie_node_t *node, const char *seg, size_t len)
+{
+    bus_trie_node_t *child = calloc(1, sizeof(bus_trie_node_t));
+    if (!child) return NULL;
+
+    if (len == 1 && seg[0] == BUS_TOPIC_WILDCARD_ONE) {
+        atomic_store_explicit(&node->any, child, memory_order_release);
+        return child;
+    }
+
+    bus_trie_children_t *old = atomic_load_explicit(&node->children, memory_order_relaxed);
+    const size_t count = old ? old->count : 0;
+    bus_trie_children_t *children = malloc(sizeof(bus_trie_children_t) + (count + 1) * sizeof(bus_trie_node_t *));
+    child->segment = malloc(len + 1);
+    if (!children || !child->segment) {
+        free(children);
+        free(child->segment);
+        free(child);
+        return NULL;
+    }
+
+    memcpy(child->segment, seg, len);
+    child->segment[len] = '\0';
+    child->segment_len = len;
+
+    if (count) memcpy(children->nodes, old->nodes, count * sizeof(bus_trie_node_t *));
+    children->nodes[count] = child;
+    children->count = count + 1;
+
+    atomic_store_explicit(&node->children, children, memory_order_release);
+    bus_epoch_retire(old, free);
+    return child;
+}
+
+// Index mutex held, the node list a pattern ends on; creates the path when create is set
+static _Atomic(bus_sub_list_t *) *trie_pattern_list(bus_trie_t *trie, const char *pattern, int create)
+{
+    bus_trie_node_t *node = atomic_load_explicit(&trie->root, memory_order_relaxed);
+
+    if (!node && create) {
+        node = calloc(1, sizeof(bus_trie_node_t));
+        if (!node) return NULL;
+        atomic_store_explicit(&trie->root, node, memory_order_release);
+    }
+
+    for (const char *seg = pattern; node; ) {
+        const size_t len = segment_len(seg);
+
+        if (len == 1 && seg[0] == BUS_TOPIC_WILDCARD_ALL) return &node->subs_all;
+
+        bus_trie_node_t *child = trie_child(node, seg, len);
+        if (!child && create) child = trie_add_child(node, seg, len);
+        node = child;
+
+        if (seg[len] == '\0') return node ? &node->subs : NULL;
+        seg += len + 1;
+    }
+
+    return NULL;
+}
+
+int bus_trie_insert(bus_trie_t *trie, sub_t *sub)
+{
+    if (UNLIKELY(!trie || !sub || bus_topic_is_pattern(sub->event) != 1)) return -1;
+
+    _Atomic(bus_sub_list_t *) *slot = trie_pattern_list(trie, sub->event, 1);
+    if (!slot) return -1;
+
+    bus_sub_list_t *old = atomic_load_explicit(slot, memory_order_relaxed);
+    bus_sub_list_t *list = bus_sub_list_copy(old, NULL, sub);
+    if (!list) return -1;
+
+    atomic_store_explicit(slot, list, memory_order_release);
+    bus_epoch_retire(old, bus_sub_list_free);
+
+    trie->pattern_count++;
+    return 0;
+}
+
+int bus_trie_remove(bus_trie_t *trie, sub_t *sub)
+{
+    if (UNLIKELY(!trie || !sub || bus_topic_is_pattern(sub->event) != 1)) return -1;
+
+    _Atomic(bus_sub_list_t *) *slot = trie_pattern_list(trie, sub->event, 0);
+    if (!slot) return -1;
+
+    bus_sub_list_t *old = atomic_load_explicit(slot, memory_order_relaxed);
+
+    size_t i = 0;
+    while (old && i < old->count && old->subs[i] != sub) i++;
+    if (!old || i == old->count) return -1;
+
+    // Keeps subscription order, deliveries follow it
+    bus_sub_list_t *list = NULL;
+    if (old->count > 1 && !(list = bus_sub_list_copy(old, sub, NULL))) return -1;
+
+    atomic_store_explicit(slot, list, memory_order_release);
+    bus_epoch_retire(old, bus_sub_list_free);
+
+    trie->pattern_count--;
+    return 0;
+}
+
+static int trie_push_plugin(const _Atomic(bus_sub_list_t *) *slot, plugin_id_t plugin_id, bus_sub_list_t *out)
+{
+    const bus_sub_list_t *from = atomic_load_explicit(slot, memory_order_acquire);
+
+    for (size_t i = 0; from && i < from->count; i++) {
+        if (from->subs[i]->plugin_id == plugin_id && bus_sub_list_push(out, from->subs[i]) != 0) return -1;
+    }
+    return 0;
+}
+
+// The nodes one level of a match has reached, each at most once
+typedef struct {
+    const bus_trie_node_t **nodes;
+    size_t count;
+    size_t capacity;
+} trie_frontier_t;
+
+static int trie_frontier_add(trie_frontier_t *f, const bus_trie_node_t *node)
+{
+    if (!node) return 0;
+
+    for (size_t i = 0; i < f->count; i++) {
+        if (f->nodes[i] == node) return 0;
+    }
+
+    if (f->count == f->capacity) {
+        const size_t capacity = f->capacity ? f->capacity * 2 : 8;
+        const bus_trie_node_t **nodes = realloc(f->nodes, capacity * sizeof(bus_trie_node_t *));
+        if (!nodes) return -1;
+        f->nodes = nodes;
+        f->capacity = capacity;
+    }
+
+    f->nodes[f->count++] = node;
+    return 0;
+}
+
+int bus_trie_match(const bus_trie_t *trie, const char *topic, plugin_id_t plugin_id, bus_sub_list_t *out)
+{
+    const bus_trie_node_t *root = atomic_load_explicit(&trie->root, memory_order_acquire);
+    if (!root || !topic) return 0;
+
+    // Breadth first, one segment per level, so nothing is walked twice
+    trie_frontier_t level = { 0 };
+    trie_frontier_t next = { 0 };
+    int err = trie_frontier_add(&level, root);
+
+    for (const char *seg = topic; !err && level.count; ) {
+        const size_t len = segment_len(seg);
+        next.count = 0;
+
+        for (size_t i = 0; i < level.count && !err; i++) {
+            const bus_trie_node_t *node = level.nodes[i];
+
+            // "#" also matches zero segments, so it fires before the segment is consumed
+            err = trie_push_plugin(&node->subs_all, plugin_id, out);
+            if (!err) err = trie_frontier_add(&next, trie_child(node, seg, len));
+            if (!err) err = trie_frontier_add(&next, atomic_load_explicit(&node->any, memory_order_acquire));
+        }
+
+        trie_frontier_t swap = level;
+        level = next;
+        next = swap;
+
+        if (seg[len] == '\0') break;
+        seg += len + 1;
+    }
+
+    // The whole topic is consumed, what is left ends here
+    for (size_t i = 0; i < level.count && !err; i++) {
+        err = trie_push_plugin(&level.nodes[i]->subs_all, plugin_id, out);
+        if (!err) err = trie_push_plugin(&level.nodes[i]->subs, plugin_id, out);
+    }
+
+    free(level.nodes);
+    free(next.nodes);
+    return err;
+}
+
+static void trie_free_node(bus_trie_node_t *node)
+{
+    if (!node) return;
+
+    bus_trie_children_t *children = atomic_load_explicit(&node->children, memory_order_relaxed);
+    for (size_t i = 0; children && i < children->count; i++) {
+        trie_free_node(children->nodes[i]);
+    }
+    trie_free_node(atomic_load_explicit(&node->any, memory_order_relaxed));
+
+    free(children);
+    free(node->segment);
+    bus_sub_list_t *subs = atomic_load_explicit(&node->subs, memory_order_relaxed);
+    if (subs) bus_sub_list_free(subs);
+    subs = atomic_load_explicit(&node->subs_all, memory_order_relaxed);
+    if (subs) bus_sub_list_free(subs);
+    free(node);
+}
+
+void bus_trie_destroy(bus_trie_t *trie)
+{
+    trie_free_node(atomic_exchange_explicit(&trie->root, NULL, memory_order_relaxed));
+    trie->pattern_count = 0;
+}
@@ -0,0 +1,45 @@
+#ifndef CORECDTL_EVENT_BUS_TRIE_H
+#define CORECDTL_EVENT_BUS_TRIE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "event_bus.h"
+#include "event_bus_index.h"
+
+#define BUS_TOPIC_SEPARATOR     '.'
+#define BUS_TOPIC_WILDCARD_ONE  '*'     // exactly one segment
+#define BUS_TOPIC_WILDCARD_ALL  '#'     // zero or more trailing segments, last segment only
+
+/*
+ * Hierarchical topics are '.' separated segments ("sensor.room1.temp").
+ * Returns 1 for a wildcard pattern, 0 for a plain topic name and -1 when
+ * a wildcard shares its segment with other characters, '#' is not the
+ * last segment or a pattern has an empty segment.
+ */
+int bus_topic_is_pattern(const char *name);
+
+typedef struct bus_trie_node_s bus_trie_node_t;
+
+/*
+ * Wildcard subscriptions compiled into a segment trie.
+ * Matching walks the topic one segment per level, following the literal
+ * and the '*' child of every node reached so far, each node at most once.
+ * It costs depth times the pattern prefixes alive on a level, linear in
+ * topic depth and independent of the patterns parked on one node.
+ * Writers serialize on the index mutex and publish copies, bus_trie_match
+ * only needs an epoch read section.
+ */
+typedef struct {
+    _Atomic(bus_trie_node_t *) root;
+    size_t pattern_count;       /**< Index mutex */
+} bus_trie_t;
+
+int bus_trie_insert(bus_trie_t *trie, sub_t *sub);
+// -1 when sub is not in the trie, nodes stay behind for the next pattern on the path
+int bus_trie_remove(bus_trie_t *trie, sub_t *sub);
+// Appends the subscribers of plugin_id whose pattern matches topic to out, lock free
+int bus_trie_match(const bus_trie_t *trie, const char *topic, plugin_id_t plugin_id, bus_sub_list_t *out);
+void bus_trie_destroy(bus_trie_t *trie);
+
+#endif //CORECDTL_EVENT_BUS_TRIE_H
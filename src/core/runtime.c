@@ -88,17 +88,17 @@ int core_init(void)
 
     core_log_init();
 
-    llvm_jit_init();
-    plugin_init();
-    llvm_jit_cleanup();
-
-    core_log_info("Core init");
-
+    // Plugins subscribe and publish from initialize / start, and manifests set topic quotas
     if (bus_init() != 0) {
         core_log_error("Bus init failed");
         return 4;
     }
 
+    llvm_jit_init();
+    plugin_init();
+    llvm_jit_cleanup();
+
+    core_log_info("Core init");
 
     if (scheduler_init() != 0) {
         core_log_error("Scheduler init failed");
@@ -5,8 +5,10 @@
 
 #include "core_utils.h"
 #include "crash_recovery.h"
+#include "event_bus.h"
 #include "gateway.h"
 #include "log.h"
+#include "scheduler_queue.h"
 
 #if defined(OS_LINUX)
 #include <pthread.h>
@@ -16,19 +18,15 @@
 #include <windows.h>
 #endif
 
+#include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
-typedef struct scheduler_timer_s {
-    int id;
-    uint64_t due_ms;
-    uint64_t interval_ms;
-    sched_cb_t cb;
-    plugin_id_t plugin_id;
-    void *user;
-    int repeating;
-    struct scheduler_timer_s *next;
-} scheduler_timer_t;
+#if OS_LINUX
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
 
 __thread sigjmp_buf scheduler_thread_jmp_env;
 __thread volatile error_context_t scheduler_error_ctx = {
@@ -38,113 +36,451 @@ __thread volatile error_context_t scheduler_error_ctx = {
 static api_type_t self_api_type = SCHEDULER_API;
 
 static pthread_mutex_t g_mtx = PTHREAD_MUTEX_INITIALIZER;
+#if OS_LINUX
+static int g_timer_fd = -1;
+#else
 static pthread_cond_t g_cv = PTHREAD_COND_INITIALIZER;
-static scheduler_timer_t *g_timers = NULL;
-static int g_next_id = 1;
+#endif
+static sched_queue_t g_queue;
 static int g_running = 0;
 static pthread_t g_thr;
 
-static uint64_t now_ms(void)
+// Callback pool, popped timers wait in FIFO order on run_next
+static pthread_cond_t g_run_cv = PTHREAD_COND_INITIALIZER;
+static scheduler_timer_t *g_run_head = NULL;
+static scheduler_timer_t *g_run_tail = NULL;
+static pthread_t *g_workers = NULL;
+static uint32_t g_worker_count = 0;
+
+/*
+ * Timer ids are slot map handles: the low bits index g_slots, the bits
+ * above carry the slot's generation. Releasing a slot bumps its generation,
+ * so a stale id no longer matches and is rejected without a search. Free
+ * slots are reused oldest first, which keeps a generation from coming
+ * round again soon. All of it is guarded by g_mtx.
+ */
+#define SCHED_SLOT_INDEX_BITS   20
+#define SCHED_SLOT_MAX          (1U << SCHED_SLOT_INDEX_BITS)
+#define SCHED_SLOT_GEN_MAX      ((1U << (31 - SCHED_SLOT_INDEX_BITS)) - 1)
+#define SCHED_SLOT_INITIAL      64
+#define SCHED_SLOT_NONE         UINT32_MAX
+
+typedef struct {
+    scheduler_timer_t *timer;   /**< NULL while free */
+    uint32_t gen;
+    uint32_t next_free;
+} sched_slot_t;
+
+static sched_slot_t *g_slots = NULL;
+static uint32_t g_slot_count = 0;
+static uint32_t g_slot_capacity = 0;
+static uint32_t g_free_head = SCHED_SLOT_NONE;
+static uint32_t g_free_tail = SCHED_SLOT_NONE;
+
+static uint64_t now_ns(void)
 {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// UINT64_MAX is "nothing due" to the queue and the timerfd, far deadlines saturate just below it
+#define SCHED_DUE_MAX (UINT64_MAX - 1)
+
+static inline uint64_t sched_add_sat(uint64_t a, uint64_t b)
+{
+    return a >= SCHED_DUE_MAX || b >= SCHED_DUE_MAX - a ? SCHED_DUE_MAX : a + b;
+}
+
+static inline uint64_t sched_mul_sat(uint64_t v, uint64_t unit)
+{
+    return v > SCHED_DUE_MAX / unit ? SCHED_DUE_MAX : v * unit;
+}
+
+// Returns the timer's id, -1 when the table is full
+static int slot_alloc(scheduler_timer_t *t)
+{
+    uint32_t idx = g_free_head;
+
+    if (idx != SCHED_SLOT_NONE) {
+        g_free_head = g_slots[idx].next_free;
+        if (g_free_head == SCHED_SLOT_NONE) g_free_tail = SCHED_SLOT_NONE;
+    } else {
+        if (g_slot_count == g_slot_capacity) {
+            if (g_slot_capacity == SCHED_SLOT_MAX) return -1;
+
+            const uint32_t capacity = g_slot_capacity ? g_slot_capacity * 2 : SCHED_SLOT_INITIAL;
+            sched_slot_t *slots = realloc(g_slots, capacity * sizeof(sched_slot_t));
+            if (!slots) return -1;
+            g_slots = slots;
+            g_slot_capacity = capacity;
+        }
+
+        idx = g_slot_count++;
+        g_slots[idx].gen = 1;
+    }
+
+    g_slots[idx].timer = t;
+    t->id = (int)((g_slots[idx].gen << SCHED_SLOT_INDEX_BITS) | idx);
+    return t->id;
+}
+
+static scheduler_timer_t *slot_lookup(int id)
+{
+    const uint32_t idx = (uint32_t)id & (SCHED_SLOT_MAX - 1);
+    if (UNLIKELY(idx >= g_slot_count)) return NULL;
+
+    const sched_slot_t *slot = &g_slots[idx];
+    if (slot->gen != (uint32_t)id >> SCHED_SLOT_INDEX_BITS) return NULL;
+    return slot->timer;
+}
+
+static void slot_release(int id)
+{
+    const uint32_t idx = (uint32_t)id & (SCHED_SLOT_MAX - 1);
+    sched_slot_t *slot = &g_slots[idx];
+
+    slot->timer = NULL;
+    slot->gen = slot->gen == SCHED_SLOT_GEN_MAX ? 1 : slot->gen + 1;
+    slot->next_free = SCHED_SLOT_NONE;
+
+    if (g_free_tail == SCHED_SLOT_NONE) g_free_head = idx;
+    else g_slots[g_free_tail].next_free = idx;
+    g_free_tail = idx;
+}
+
+static void slot_destroy(void)
+{
+    free(g_slots);
+    g_slots = NULL;
+    g_slot_count = 0;
+    g_slot_capacity = 0;
+    g_free_head = SCHED_SLOT_NONE;
+    g_free_tail = SCHED_SLOT_NONE;
+}
+
+/*
+ *
+ * @brief Sleeping until a deadline (timerfd on Linux, condvar elsewhere)
+ *
+ * Deadlines are absolute CLOCK_MONOTONIC ns, wall clock steps move none of
+ * them. On Linux the thread blocks in read() on a timerfd armed with
+ * TFD_TIMER_ABSTIME: no relative timeout to recompute, and its resolution
+ * is the kernel's hrtimer one.
+ */
+static int sched_wait_init(void)
+{
+#if OS_LINUX
+    g_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    return g_timer_fd < 0 ? -1 : 0;
+#else
+    return 0;
+#endif
+}
+
+static void sched_wait_destroy(void)
+{
+#if OS_LINUX
+    if (g_timer_fd >= 0) close(g_timer_fd);
+    g_timer_fd = -1;
+#endif
+}
+
+#if OS_LINUX
+// UINT64_MAX disarms, a deadline in the past fires right away
+static void sched_timerfd_arm(uint64_t due_ns)
+{
+    struct itimerspec its = { 0 };
+
+    if (due_ns != UINT64_MAX) {
+        if (due_ns == 0) due_ns = 1;    // it_value 0 would disarm
+        its.it_value.tv_sec = (time_t)(due_ns / 1000000000ULL);
+        its.it_value.tv_nsec = (long)(due_ns % 1000000000ULL);
+    }
+    timerfd_settime(g_timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+#endif
+
+// g_mtx held, released while sleeping. Returns early when woken, the caller rechecks
+static void sched_wait(uint64_t due_ns)
+{
+#if OS_LINUX
+    sched_timerfd_arm(due_ns);
+    pthread_mutex_unlock(&g_mtx);
+
+    uint64_t expirations;
+    if (read(g_timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EINTR)
+        core_log_error("Scheduler: timerfd read failed");
+
+    pthread_mutex_lock(&g_mtx);
+#else
+    if (due_ns == UINT64_MAX) {
+        pthread_cond_wait(&g_cv, &g_mtx);
+        return;
+    }
+
+    // The condvar keeps CLOCK_REALTIME, only the remaining time is taken from it
+    const uint64_t now = now_ns();
+    const uint64_t delta = due_ns > now ? due_ns - now : 0;
     struct timespec ts;
     clock_gettime(CLOCK_REALTIME, &ts);
-    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+    ts.tv_sec += (time_t)(delta / 1000000000ULL);
+    ts.tv_nsec += (long)(delta % 1000000000ULL);
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec += 1;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&g_cv, &g_mtx, &ts);
+#endif
 }
 
-static void insert_timer(scheduler_timer_t *t)
+// g_mtx held: pulls the sleeping scheduler thread forward to due_ns
+static void sched_wake(uint64_t due_ns)
 {
-    if (!g_timers || t->due_ms < g_timers->due_ms) {
-        t->next = g_timers;
-        g_timers = t;
+#if OS_LINUX
+    sched_timerfd_arm(due_ns);
+#else
+    (void)due_ns;
+    pthread_cond_broadcast(&g_cv);
+#endif
+}
+
+// g_mtx held. Queues t again by its deadline, pulling the scheduler thread forward if it is the earliest
+static int sched_enqueue(scheduler_timer_t *t)
+{
+    const uint64_t due = sched_queue_next_due(&g_queue);
+    if (sched_queue_insert(&g_queue, t) != 0) return -1;
+
+    // Only an earlier deadline changes how long the scheduler thread sleeps
+    if (t->due_ns < due) sched_wake(t->due_ns);
+    return 0;
+}
+
+// g_mtx held. Phase locked: the next deadline follows from the last one, not from when the callback returned
+static void sched_rearm(scheduler_timer_t *t)
+{
+    const uint64_t now = now_ns();
+    const uint64_t next = sched_add_sat(t->due_ns, t->interval_ns);
+
+    t->missed = 0;
+    if (LIKELY(next > now)) {
+        t->due_ns = next;
         return;
     }
 
-    scheduler_timer_t *it = g_timers;
-    
-    while (it->next && it->next->due_ms <= t->due_ms)
-        it = it->next;
-    
-    t->next = it->next;
-    it->next = t;
+    // Periods whose deadline already passed, next included
+    const uint64_t overdue = (now - next) / t->interval_ns + 1;
+
+    switch (t->overrun) {
+        case SCHED_OVERRUN_FIRE_ALL:
+            t->due_ns = next;
+            t->overruns++;
+            break;
+        case SCHED_OVERRUN_COALESCE:
+            // Due right away at the latest passed deadline, carrying the ones before it
+            t->due_ns = next + (overdue - 1) * t->interval_ns;
+            t->missed = overdue - 1;
+            t->overruns += overdue - 1;
+            break;
+        default:
+            t->due_ns = sched_add_sat(next, overdue * t->interval_ns);
+            t->overruns += overdue;
+            break;
+    }
 }
 
+// g_mtx held. A periodic timer is only queued again here, after its callback returned, so it never overlaps itself
+static void sched_finish(scheduler_timer_t *t)
+{
+    // A cancel during the callback already released the id
+    if (t->cancelled) {
+        free(t);
+        return;
+    }
+
+    const uint64_t lateness = t->started_ns > t->due_ns ? t->started_ns - t->due_ns : 0;
+    t->runs++;
+    t->lateness_sum_ns += lateness;
+    if (lateness > t->lateness_max_ns) t->lateness_max_ns = lateness;
+
+    if (t->repeating && g_running) {
+        sched_rearm(t);
+        if (sched_enqueue(t) == 0) return;
+    }
+
+    slot_release(t->id);
+    free(t);
+}
+
+// Runs the callback under the crash guard, g_mtx not held
 __attribute__((noinline))
-static void *sched_thread(void *arg)
+static void sched_run(scheduler_timer_t *t)
+{
+    error_context_t local_ctx = scheduler_error_ctx;
+    asm volatile("" : : "r"(&local_ctx) : "memory");
+
+    t->started_ns = now_ns();
+
+    if (CRASH_GUARD_SETJMP(scheduler_thread_jmp_env) != 0) {
+        // Get Error
+        add_scheduler_critical_error(t->plugin_id, t->id,
+        CRITICAL_ERROR_QUEUE_SOURCE_SCHEDULER, scheduler_error_ctx);
+    } else if (t->overrun == SCHED_OVERRUN_COALESCE && t->repeating) {
+        const uint64_t missed = t->missed;
+        t->cb(&missed, sizeof(missed), t->user);
+    } else {
+        t->cb(NULL, 0, t->user);
+    }
+}
+
+static void *sched_worker(void *arg)
 {
     (void)arg;
 
+    crash_guard_save_mask();
+    bus_mark_core_thread();
+
     pthread_mutex_lock(&g_mtx);
 
-    error_context_t local_ctx = scheduler_error_ctx;
-    asm volatile("" : : "r"(&local_ctx) : "memory");
-    
     while (g_running) {
-
-        uint64_t now = now_ms();
-        
-        if (!g_timers) {
-            // wait indefinitely
-            pthread_cond_wait(&g_cv, &g_mtx);
+        scheduler_timer_t *t = g_run_head;
+        if (!t) {
+            pthread_cond_wait(&g_run_cv, &g_mtx);
             continue;
         }
-        // compute wait time until next timer
-        uint64_t due = g_timers->due_ms;
-        if (due <= now)
-        {
-            // pop the head
-            scheduler_timer_t *t = g_timers;
-            g_timers = t->next;
-
-            sched_cb_t cb = t->cb;
-            void *user = t->user;
-            int repeating = t->repeating;
-            uint64_t interval = t->interval_ms;
+
+        g_run_head = t->run_next;
+        if (!g_run_head) g_run_tail = NULL;
+
+        if (!t->cancelled) {
             pthread_mutex_unlock(&g_mtx);
+            sched_run(t);
+            pthread_mutex_lock(&g_mtx);
+        }
+        sched_finish(t);
+    }
 
-            if (sigsetjmp(scheduler_thread_jmp_env, 1) != 0) {
-                // Get Error
-                add_scheduler_critical_error(t->plugin_id, t->id,
-                CRITICAL_ERROR_QUEUE_SOURCE_SCHEDULER, scheduler_error_ctx);
-            } else {
-                cb(NULL, 0, user);
-            }
+    pthread_mutex_unlock(&g_mtx);
+    return NULL;
+}
 
+// g_mtx held
+static void sched_dispatch(scheduler_timer_t *t)
+{
+    t->run_next = NULL;
+    if (g_run_tail) g_run_tail->run_next = t;
+    else g_run_head = t;
+    g_run_tail = t;
 
-            pthread_mutex_lock(&g_mtx);
-            if (repeating && g_running) {
-                t->due_ms = now_ms() + interval;
-                t->next = NULL;
-                insert_timer(t);
+    pthread_cond_signal(&g_run_cv);
+}
+
+// Only detects expiry when there are workers, callbacks run here just without them or when asked to
+static void *sched_thread(void *arg)
+{
+    (void)arg;
+
+    crash_guard_save_mask();
+    bus_mark_core_thread();
+
+    pthread_mutex_lock(&g_mtx);
+
+    while (g_running) {
+
+        uint64_t now = now_ns();
+        scheduler_timer_t *t = sched_queue_pop(&g_queue, now);
+
+        if (t) {
+            if (g_worker_count > 0 && !t->run_inline) {
+                sched_dispatch(t);
+                continue;
             }
-            else
-                free(t);
+
+            pthread_mutex_unlock(&g_mtx);
+            sched_run(t);
+            pthread_mutex_lock(&g_mtx);
+            sched_finish(t);
 
             continue;
         }
-        else {
-            // timed wait
-            struct timespec ts;
-            uint64_t wait_ms = due - now;
-            clock_gettime(CLOCK_REALTIME, &ts);
-            ts.tv_sec += (wait_ms / 1000);
-            ts.tv_nsec += (long)(wait_ms % 1000) * 1000000L;
-            if (ts.tv_nsec >= 1000000000L) {
-                ts.tv_sec += 1;
-                ts.tv_nsec -= 1000000000L;
-            }
-            pthread_cond_timedwait(&g_cv, &g_mtx, &ts);
-        }
+
+        sched_wait(sched_queue_next_due(&g_queue));
     }
 
     pthread_mutex_unlock(&g_mtx);
     return NULL;
 }
 
+// Stops the scheduler thread and the started workers, both with g_mtx not held
+static void sched_stop_threads(int scheduler_started)
+{
+    pthread_mutex_lock(&g_mtx);
+    g_running = 0;
+    sched_wake(0);
+    pthread_cond_broadcast(&g_run_cv);
+    pthread_mutex_unlock(&g_mtx);
+
+    if (scheduler_started) pthread_join(g_thr, NULL);
+    for (uint32_t i = 0; i < g_worker_count; i++) {
+        pthread_join(g_workers[i], NULL);
+    }
+
+    free(g_workers);
+    g_workers = NULL;
+    g_worker_count = 0;
+}
+
+// Timers popped but never run, g_mtx held
+static void sched_drop_dispatched(void)
+{
+    while (g_run_head) {
+        scheduler_timer_t *t = g_run_head;
+        g_run_head = t->run_next;
+        free(t);
+    }
+    g_run_tail = NULL;
+}
+
 int scheduler_init(void)
 {
+    const scheduler_config_t config = SCHEDULER_CONFIG_DEFAULT;
+    return scheduler_init_config(&config);
+}
+
+int scheduler_init_config(const scheduler_config_t *config)
+{
+    if (!config || config->workers > SCHEDULER_MAX_WORKERS) return -1;
+
+    if (sched_wait_init() != 0) return -1;
+    if (sched_queue_init(&g_queue, config->backend, now_ns()) != 0) {
+        sched_wait_destroy();
+        return -1;
+    }
+
+    if (config->workers > 0) {
+        g_workers = calloc(config->workers, sizeof(pthread_t));
+        if (!g_workers) {
+            sched_queue_destroy(&g_queue);
+            sched_wait_destroy();
+            return -1;
+        }
+    }
+
     g_running = 1;
+    for (uint32_t i = 0; i < config->workers; i++) {
+        if (pthread_create(&g_workers[i], NULL, sched_worker, NULL) != 0) {
+            sched_stop_threads(0);
+            sched_queue_destroy(&g_queue);
+            sched_wait_destroy();
+            return -1;
+        }
+        g_worker_count++;
+    }
+
     if (pthread_create(&g_thr, NULL, sched_thread, NULL) != 0) {
-        g_running = 0;
+        sched_stop_threads(0);
+        sched_queue_destroy(&g_queue);
+        sched_wait_destroy();
         return -1;
     }
 
@@ -153,62 +489,89 @@ int scheduler_init(void)
 
 void scheduler_shutdown(void)
 {
-    pthread_mutex_lock(&g_mtx);
-    
-    g_running = 0;
-
-    pthread_cond_broadcast(&g_cv);
-    pthread_mutex_unlock(&g_mtx);
-    
-    pthread_join(g_thr, NULL);
+    sched_stop_threads(1);
     
     // cleanup timers
     pthread_mutex_lock(&g_mtx);
-    scheduler_timer_t *it = g_timers;
+    sched_drop_dispatched();
+    sched_queue_destroy(&g_queue);
+    slot_destroy();
+    sched_wait_destroy();
+    pthread_mutex_unlock(&g_mtx);
+}
+
+// Returns the new id, t may already have fired and been freed once the mutex is released
+static int scheduler_add(scheduler_timer_t *t)
+{
+    pthread_mutex_lock(&g_mtx);
 
-    while (it) {
-        scheduler_timer_t *n = it->next;
-        free(it);
-        it = n;
+    t->cancelled = 0;
+    const int id = slot_alloc(t);
+    if (id < 0) {
+        pthread_mutex_unlock(&g_mtx);
+        return -1;
+    }
+
+    if (sched_enqueue(t) != 0) {
+        slot_release(id);
+        pthread_mutex_unlock(&g_mtx);
+        return -1;
     }
 
-    g_timers = NULL;
     pthread_mutex_unlock(&g_mtx);
+    return id;
 }
 
-int scheduler_after_ms(plugin_id_t plugin_id, uint64_t ms, sched_cb_t cb, void *user)
+// Arms a timer first_ns from now, repeating every interval_ns unless 0
+static int scheduler_start(plugin_id_t plugin_id, uint64_t first_ns, uint64_t interval_ns, sched_cb_t cb, void *user,
+                           const sched_timer_opts_t *opts)
 {
-    if (!cb)
-        return -1;
-
     scheduler_timer_t *t = (scheduler_timer_t *)malloc(sizeof(scheduler_timer_t));
 
     if (!t)
         return -1;
 
-    t->id = g_next_id++;
-    t->interval_ms = 0;
-    t->due_ms = now_ms() + ms;
+    t->interval_ns = interval_ns;
+    t->due_ns = sched_add_sat(now_ns(), first_ns);
     t->cb = cb;
     t->user = user;
-    t->repeating = 0;
-    t->next = NULL;
+    t->repeating = interval_ns != 0;
+    t->run_inline = opts ? opts->run_inline : 0;
+    t->overrun = opts ? opts->overrun : SCHED_OVERRUN_SKIP;
+    t->missed = 0;
+    t->started_ns = 0;
+    t->runs = 0;
+    t->overruns = 0;
+    t->lateness_sum_ns = 0;
+    t->lateness_max_ns = 0;
     t->plugin_id = plugin_id;
 
-    pthread_mutex_lock(&g_mtx);
-    
-    insert_timer(t);
-    
-    pthread_cond_broadcast(&g_cv);
-    pthread_mutex_unlock(&g_mtx);
-
-    if (g_gateway_connected_flag) {
-        char msg[GATEWAY_DTLS_MSG_LEN];
-        snprintf(msg, GATEWAY_DTLS_MSG_LEN, "[subs_after] %d %d %lld [ms]", plugin_id, t->id, ms);
-        gateway_msg_send(self_api_type, msg);
+    const int id = scheduler_add(t);
+    if (id < 0) {
+        free(t);
+        return -1;
     }
-    
-    return t->id;
+
+    return id;
+}
+
+static void scheduler_notify(const char *kind, plugin_id_t plugin_id, int id, uint64_t value, const char *unit)
+{
+    if (!g_gateway_connected_flag) return;
+
+    char msg[GATEWAY_DTLS_MSG_LEN];
+    snprintf(msg, GATEWAY_DTLS_MSG_LEN, "[%s] %d %d %llu [%s]", kind, plugin_id, id, (unsigned long long)value, unit);
+    gateway_msg_send(self_api_type, msg);
+}
+
+int scheduler_after_ms(plugin_id_t plugin_id, uint64_t ms, sched_cb_t cb, void *user)
+{
+    if (!cb)
+        return -1;
+
+    const int id = scheduler_start(plugin_id, sched_mul_sat(ms, 1000000ULL), 0, cb, user, NULL);
+    if (id >= 0) scheduler_notify("subs_after", plugin_id, id, ms, "ms");
+    return id;
 }
 
 int scheduler_every_ms(plugin_id_t plugin_id, uint64_t ms, sched_cb_t cb, void *user)
@@ -216,34 +579,42 @@ int scheduler_every_ms(plugin_id_t plugin_id, uint64_t ms, sched_cb_t cb, void *
     if (!cb || ms == 0)
         return -1;
 
-    scheduler_timer_t *t = (scheduler_timer_t *)malloc(sizeof(scheduler_timer_t));
+    const uint64_t interval_ns = sched_mul_sat(ms, 1000000ULL);
+    const int id = scheduler_start(plugin_id, interval_ns, interval_ns, cb, user, NULL);
+    if (id >= 0) scheduler_notify("subs_every", plugin_id, id, ms, "ms");
+    return id;
+}
 
-    if (!t)
+int scheduler_after_us(plugin_id_t plugin_id, uint64_t us, sched_cb_t cb, void *user)
+{
+    if (!cb)
         return -1;
 
-    t->id = g_next_id++;
-    t->interval_ms = ms;
-    t->due_ms = now_ms() + ms;
-    t->cb = cb;
-    t->user = user;
-    t->repeating = 1;
-    t->next = NULL;
-    t->plugin_id = plugin_id;
+    const int id = scheduler_start(plugin_id, sched_mul_sat(us, 1000ULL), 0, cb, user, NULL);
+    if (id >= 0) scheduler_notify("subs_after", plugin_id, id, us, "us");
+    return id;
+}
 
-    pthread_mutex_lock(&g_mtx);
-    
-    insert_timer(t);
-    
-    pthread_cond_broadcast(&g_cv);
-    pthread_mutex_unlock(&g_mtx);
+int scheduler_every_ns(plugin_id_t plugin_id, uint64_t ns, sched_cb_t cb, void *user)
+{
+    if (!cb || ns == 0)
+        return -1;
 
-    if (g_gateway_connected_flag) {
-        char msg[GATEWAY_DTLS_MSG_LEN];
-        snprintf(msg, GATEWAY_DTLS_MSG_LEN, "[subs_every] %d %d %lld [ms]", plugin_id, t->id, ms);
-        gateway_msg_send(self_api_type, msg);
-    }
+    const int id = scheduler_start(plugin_id, ns, ns, cb, user, NULL);
+    if (id >= 0) scheduler_notify("subs_every", plugin_id, id, ns, "ns");
+    return id;
+}
 
-    return t->id;
+int scheduler_timer_ex(plugin_id_t plugin_id, uint64_t delay_ns, uint64_t interval_ns, sched_cb_t cb, void *user,
+                       const sched_timer_opts_t *opts)
+{
+    if (!cb || (opts && opts->overrun > SCHED_OVERRUN_COALESCE))
+        return -1;
+
+    const int id = scheduler_start(plugin_id, delay_ns, interval_ns, cb, user, opts);
+    if (id >= 0) scheduler_notify(interval_ns ? "subs_every" : "subs_after", plugin_id, id,
+                                  interval_ns ? interval_ns : delay_ns, "ns");
+    return id;
 }
 
 int scheduler_cancel(plugin_id_t plugin_id, int id)
@@ -252,23 +623,20 @@ int scheduler_cancel(plugin_id_t plugin_id, int id)
         return -1;
 
     pthread_mutex_lock(&g_mtx);
-    
-    scheduler_timer_t *it = g_timers;
-    scheduler_timer_t *prev = NULL;
-
-    while (it) {
-        if (it->id == id && it->plugin_id == plugin_id)
-        {
-            if (prev)
-                prev->next = it->next;
-            else
-                g_timers = it->next;
-            free(it);
-            pthread_mutex_unlock(&g_mtx);
-            return 0;
+
+    scheduler_timer_t *t = slot_lookup(id);
+    if (t && t->plugin_id == plugin_id) {
+        slot_release(id);
+
+        // Popped timers are running or waiting for a worker, whoever runs them frees them afterwards
+        if (t->pos == SCHED_QUEUE_POS_NONE) {
+            t->cancelled = 1;
+        } else {
+            sched_queue_remove(&g_queue, t);
+            free(t);
         }
-        prev = it;
-        it = it->next;
+        pthread_mutex_unlock(&g_mtx);
+        return 0;
     }
     pthread_mutex_unlock(&g_mtx);
 
@@ -281,32 +649,65 @@ int scheduler_cancel(plugin_id_t plugin_id, int id)
     return -1;
 }
 
-int scheduler_get_list(char *out_buf, size_t buf_len)
+int scheduler_get_timer_stats(plugin_id_t plugin_id, int id, scheduler_timer_stats_t *out)
 {
-    scheduler_timer_t *it = g_timers;
+    if (id <= 0 || !out)
+        return -1;
 
-    snprintf(out_buf, buf_len, "[on_data] [scheduler]\n[getall]\n");
+    pthread_mutex_lock(&g_mtx);
 
-    while (it) {
-        char temp[128];
-        if (it->repeating) {
-            snprintf(temp, sizeof(temp), "[every] %d %d %lld\n",
-                     it->id, it->plugin_id, it->interval_ms);
-        } else {
-            snprintf(temp, sizeof(temp), "[after] %d %d %lld\n",
-                     it->id, it->plugin_id, it->interval_ms);
-        }
+    const scheduler_timer_t *t = slot_lookup(id);
+    if (!t || t->plugin_id != plugin_id) {
+        pthread_mutex_unlock(&g_mtx);
+        return -1;
+    }
 
-        size_t current_len = strlen(out_buf);
-        size_t remaining = buf_len - current_len - 1;
+    out->runs = t->runs;
+    out->overruns = t->overruns;
+    out->lateness_avg_ns = t->runs ? t->lateness_sum_ns / t->runs : 0;
+    out->lateness_max_ns = t->lateness_max_ns;
 
-        if (remaining > 0) {
-            strncat(out_buf, temp, remaining);
-        }
+    pthread_mutex_unlock(&g_mtx);
+    return 0;
+}
 
-        it = it->next;
+typedef struct {
+    char *out_buf;
+    size_t buf_len;
+} scheduler_list_t;
+
+static int scheduler_list_append(scheduler_timer_t *it, void *ctx)
+{
+    scheduler_list_t *list = ctx;
+    char temp[128];
+
+    if (it->repeating) {
+        snprintf(temp, sizeof(temp), "[every] %d %d %llu\n",
+                 it->id, it->plugin_id, (unsigned long long)(it->interval_ns / 1000000ULL));
+    } else {
+        snprintf(temp, sizeof(temp), "[after] %d %d %llu\n",
+                 it->id, it->plugin_id, (unsigned long long)(it->interval_ns / 1000000ULL));
+    }
+
+    size_t current_len = strlen(list->out_buf);
+    size_t remaining = list->buf_len - current_len - 1;
+
+    if (remaining > 0) {
+        strncat(list->out_buf, temp, remaining);
     }
 
     return 0;
 }
 
+int scheduler_get_list(char *out_buf, size_t buf_len)
+{
+    scheduler_list_t list = { .out_buf = out_buf, .buf_len = buf_len };
+
+    snprintf(out_buf, buf_len, "[on_data] [scheduler]\n[getall]\n");
+
+    pthread_mutex_lock(&g_mtx);
+    sched_queue_find(&g_queue, scheduler_list_append, &list);
+    pthread_mutex_unlock(&g_mtx);
+
+    return 0;
+}
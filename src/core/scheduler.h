@@ -12,18 +12,55 @@ extern __thread sigjmp_buf scheduler_thread_jmp_env;
 
 typedef void (*sched_cb_t)(const void* data, size_t len, void* user);
 
+typedef enum {
+    SCHEDULER_BACKEND_WHEEL,    /**< Hierarchical timing wheel, O(1) insert / cancel */
+    SCHEDULER_BACKEND_HEAP      /**< 4-ary min-heap, O(log n) but no cascading */
+} scheduler_backend_t;
+
+#define SCHEDULER_DEFAULT_WORKERS   2
+#define SCHEDULER_MAX_WORKERS       64
+
+typedef struct {
+    scheduler_backend_t backend;
+    uint32_t workers;           /**< Callback pool, 0 = every callback runs on the scheduler thread */
+} scheduler_config_t;
+
+#define SCHEDULER_CONFIG_DEFAULT { \
+        .backend = SCHEDULER_BACKEND_WHEEL, \
+        .workers = SCHEDULER_DEFAULT_WORKERS \
+    }
+
 int scheduler_init(void);
+int scheduler_init_config(const scheduler_config_t *config);
 void scheduler_shutdown(void);
 
 // returns timer id >= 1 on success
 int scheduler_after_ms(plugin_id_t plugin_id, uint64_t ms, sched_cb_t cb, void* user);
 int scheduler_every_ms(plugin_id_t plugin_id, uint64_t ms, sched_cb_t cb, void* user);
+// Same on finer units, deadlines are CLOCK_MONOTONIC
+int scheduler_after_us(plugin_id_t plugin_id, uint64_t us, sched_cb_t cb, void* user);
+int scheduler_every_ns(plugin_id_t plugin_id, uint64_t ns, sched_cb_t cb, void* user);
+// delay_ns to the first run, then every interval_ns unless 0, opts may be NULL
+int scheduler_timer_ex(plugin_id_t plugin_id, uint64_t delay_ns, uint64_t interval_ns, sched_cb_t cb, void* user,
+                       const sched_timer_opts_t *opts);
 int scheduler_cancel(plugin_id_t plugin_id, int id);
 
+typedef struct {
+    uint64_t runs;
+    uint64_t overruns;          /**< Periods skipped, folded, or run late to catch up */
+    uint64_t lateness_avg_ns;   /**< Deadline to callback start */
+    uint64_t lateness_max_ns;
+} scheduler_timer_stats_t;
+
+// returns -1 for a stale id or another plugin's timer
+int scheduler_get_timer_stats(plugin_id_t plugin_id, int id, scheduler_timer_stats_t *out);
+
 int scheduler_get_list(char *out_buf, size_t buf_len);
 
 typedef int (*api_scheduler_after_ms_fn)(uint64_t, sched_cb_t, void *);
 typedef int (*api_scheduler_every_ms_fn)(uint64_t, sched_cb_t, void *);
+typedef int (*api_scheduler_after_us_fn)(uint64_t, sched_cb_t, void *);
+typedef int (*api_scheduler_every_ns_fn)(uint64_t, sched_cb_t, void *);
 typedef int (*api_scheduler_cancel_fn)(int id);
 
 #endif // CORE_SCHEDULER_H
@@ -0,0 +1,371 @@
+#include "scheduler_queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+
+#define WHEEL_MASK (SCHED_WHEEL_SLOTS - 1)
+
+/*
+ *
+ * @brief Timing wheel backend
+ */
+static inline unsigned int wheel_shift(unsigned int level)
+{
+    return SCHED_WHEEL_SLOT_BITS * level;
+}
+
+static void wheel_link(scheduler_timer_t **head, scheduler_timer_t *t, uint32_t pos)
+{
+    t->next = *head;
+    if (t->next) t->next->pprev = &t->next;
+    t->pprev = head;
+    t->pos = pos;
+    *head = t;
+}
+
+static void wheel_unlink(sched_wheel_t *w, scheduler_timer_t *t)
+{
+    *t->pprev = t->next;
+    if (t->next) t->next->pprev = t->pprev;
+    t->next = NULL;
+    t->pprev = NULL;
+
+    if (t->pos != SCHED_WHEEL_READY && !w->slots[t->pos]) {
+        const uint32_t level = t->pos / SCHED_WHEEL_SLOTS;
+        const uint32_t idx = t->pos & WHEEL_MASK;
+        w->occupied[level][idx / 64] &= ~(1ULL << (idx % 64));
+    }
+}
+
+static void wheel_place(sched_wheel_t *w, scheduler_timer_t *t)
+{
+    uint64_t due = t->due_ns >> SCHED_WHEEL_TICK_SHIFT;
+    if (due < w->tick) {
+        wheel_link(&w->ready, t, SCHED_WHEEL_READY);
+        return;
+    }
+
+    unsigned int level = 0;
+    while (level < SCHED_WHEEL_LEVELS - 1 && due - w->tick >= (1ULL << wheel_shift(level + 1))) level++;
+
+    // Beyond the top level's reach: park in its furthest slot, the cascade from there places it again
+    const unsigned int top = wheel_shift(SCHED_WHEEL_LEVELS - 1);
+    if (level == SCHED_WHEEL_LEVELS - 1 && (due >> top) - (w->tick >> top) >= SCHED_WHEEL_SLOTS)
+        due = ((w->tick >> top) + SCHED_WHEEL_SLOTS - 1) << top;
+
+    const uint32_t idx = (uint32_t)(due >> wheel_shift(level)) & WHEEL_MASK;
+    const uint32_t pos = level * SCHED_WHEEL_SLOTS + idx;
+    wheel_link(&w->slots[pos], t, pos);
+    w->occupied[level][idx / 64] |= 1ULL << (idx % 64);
+}
+
+// First occupied slot at or after from, -1 when there is none
+static int wheel_bitmap_next(const uint64_t *bits, unsigned int from)
+{
+    for (unsigned int word = from / 64; word < SCHED_WHEEL_SLOTS / 64; word++) {
+        uint64_t w = bits[word];
+        if (word == from / 64) w &= ~0ULL << (from % 64);
+        if (w) return (int)(word * 64 + (unsigned int)__builtin_ctzll(w));
+    }
+    return -1;
+}
+
+// Start tick of the next occupied slot of level after the current one, wrapping into the next round
+static uint64_t wheel_level_next(const sched_wheel_t *w, unsigned int level)
+{
+    const unsigned int shift = wheel_shift(level);
+    const uint64_t slot = w->tick >> shift;
+    const unsigned int start = (unsigned int)((slot + 1) & WHEEL_MASK);
+
+    uint64_t distance;
+    int idx = wheel_bitmap_next(w->occupied[level], start);
+    if (idx >= 0) {
+        distance = (uint64_t)(idx - (int)start) + 1;
+    } else {
+        idx = wheel_bitmap_next(w->occupied[level], 0);
+        if (idx < 0) return UINT64_MAX;
+        distance = SCHED_WHEEL_SLOTS - start + (uint64_t)idx + 1;
+    }
+    return (slot + distance) << shift;
+}
+
+static void wheel_cascade(sched_wheel_t *w, unsigned int level)
+{
+    const uint32_t idx = (uint32_t)(w->tick >> wheel_shift(level)) & WHEEL_MASK;
+    scheduler_timer_t *t = w->slots[level * SCHED_WHEEL_SLOTS + idx];
+
+    w->slots[level * SCHED_WHEEL_SLOTS + idx] = NULL;
+    w->occupied[level][idx / 64] &= ~(1ULL << (idx % 64));
+
+    while (t) {
+        scheduler_timer_t *next = t->next;
+        wheel_place(w, t);
+        t = next;
+    }
+}
+
+// Moves the due timers of the current tick's slot to ready, later ones in the same tick stay
+static void wheel_collect(sched_wheel_t *w, uint64_t now_ns)
+{
+    scheduler_timer_t *t = w->slots[w->tick & WHEEL_MASK];
+
+    while (t) {
+        scheduler_timer_t *next = t->next;
+        if (t->due_ns <= now_ns) {
+            wheel_unlink(w, t);
+            wheel_link(&w->ready, t, SCHED_WHEEL_READY);
+        }
+        t = next;
+    }
+}
+
+static void wheel_advance(sched_wheel_t *w, uint64_t now_ns)
+{
+    const uint64_t target = now_ns >> SCHED_WHEEL_TICK_SHIFT;
+
+    // Once time leaves the current tick every entry of its slot is due, hand those out first
+    wheel_collect(w, now_ns);
+    if (w->ready) return;
+
+    while (w->tick < target) {
+        uint64_t next = UINT64_MAX;
+        for (unsigned int level = 0; level < SCHED_WHEEL_LEVELS; level++) {
+            const uint64_t at = wheel_level_next(w, level);
+            if (at < next) next = at;
+        }
+
+        // Nothing in between, jump straight there
+        if (next > target) {
+            w->tick = target;
+            break;
+        }
+
+        w->tick = next;
+        for (unsigned int level = SCHED_WHEEL_LEVELS - 1; level > 0; level--) {
+            if ((next & ((1ULL << wheel_shift(level)) - 1)) == 0) wheel_cascade(w, level);
+        }
+        wheel_collect(w, now_ns);
+
+        // Hand out one tick at a time, a late pop still sees deadline order
+        if (w->ready) break;
+    }
+}
+
+static uint64_t wheel_slot_min(const scheduler_timer_t *t)
+{
+    uint64_t min = UINT64_MAX;
+    for (; t; t = t->next) {
+        if (t->due_ns < min) min = t->due_ns;
+    }
+    return min;
+}
+
+static uint64_t wheel_next_due(const sched_wheel_t *w)
+{
+    if (w->ready) return 0;
+
+    uint64_t due = wheel_slot_min(w->slots[w->tick & WHEEL_MASK]);
+
+    const uint64_t tick = wheel_level_next(w, 0);
+    if (tick != UINT64_MAX) {
+        const uint64_t at = wheel_slot_min(w->slots[tick & WHEEL_MASK]);
+        if (at < due) due = at;
+    }
+
+    for (unsigned int level = 1; level < SCHED_WHEEL_LEVELS; level++) {
+        const uint64_t at = wheel_level_next(w, level);
+        if (at != UINT64_MAX && (at << SCHED_WHEEL_TICK_SHIFT) < due) due = at << SCHED_WHEEL_TICK_SHIFT;
+    }
+    return due;
+}
+
+static scheduler_timer_t *wheel_find(const sched_wheel_t *w, sched_queue_visit_fn fn, void *ctx)
+{
+    for (scheduler_timer_t *t = w->ready; t; t = t->next) {
+        if (fn(t, ctx)) return t;
+    }
+
+    for (size_t pos = 0; pos < SCHED_WHEEL_LEVELS * SCHED_WHEEL_SLOTS; pos++) {
+        for (scheduler_timer_t *t = w->slots[pos]; t; t = t->next) {
+            if (fn(t, ctx)) return t;
+        }
+    }
+    return NULL;
+}
+
+/*
+ *
+ * @brief 4-ary heap backend
+ */
+static inline void heap_set(sched_heap_t *h, size_t i, scheduler_timer_t *t)
+{
+    h->nodes[i] = t;
+    t->pos = (uint32_t)i;
+}
+
+static void heap_sift_up(sched_heap_t *h, size_t i)
+{
+    scheduler_timer_t *t = h->nodes[i];
+
+    while (i > 0) {
+        const size_t parent = (i - 1) / SCHED_HEAP_ARITY;
+        if (h->nodes[parent]->due_ns <= t->due_ns) break;
+        heap_set(h, i, h->nodes[parent]);
+        i = parent;
+    }
+    heap_set(h, i, t);
+}
+
+static void heap_sift_down(sched_heap_t *h, size_t count, size_t i)
+{
+    scheduler_timer_t *t = h->nodes[i];
+
+    for (;;) {
+        const size_t first = i * SCHED_HEAP_ARITY + 1;
+        if (first >= count) break;
+
+        const size_t last = first + SCHED_HEAP_ARITY < count ? first + SCHED_HEAP_ARITY : count;
+        size_t min = first;
+        for (size_t c = first + 1; c < last; c++) {
+            if (h->nodes[c]->due_ns < h->nodes[min]->due_ns) min = c;
+        }
+
+        if (h->nodes[min]->due_ns >= t->due_ns) break;
+        heap_set(h, i, h->nodes[min]);
+        i = min;
+    }
+    heap_set(h, i, t);
+}
+
+static void heap_remove_at(sched_queue_t *q, size_t i)
+{
+    sched_heap_t *h = &q->heap;
+    const size_t last = q->count - 1;
+
+    if (i != last) {
+        scheduler_timer_t *moved = h->nodes[last];
+        heap_set(h, i, moved);
+        if (i > 0 && h->nodes[(i - 1) / SCHED_HEAP_ARITY]->due_ns > moved->due_ns) heap_sift_up(h, i);
+        else heap_sift_down(h, last, i);
+    }
+    h->nodes[last] = NULL;
+}
+
+/*
+ *
+ * @brief Queue
+ */
+int sched_queue_init(sched_queue_t *q, scheduler_backend_t backend, uint64_t now_ns)
+{
+    memset(q, 0, sizeof(*q));
+    q->backend = backend;
+
+    if (backend == SCHEDULER_BACKEND_WHEEL) {
+        q->wheel.tick = now_ns >> SCHED_WHEEL_TICK_SHIFT;
+        return 0;
+    }
+
+    q->heap.nodes = malloc(SCHED_HEAP_INITIAL * sizeof(scheduler_timer_t *));
+    if (!q->heap.nodes) return -1;
+    q->heap.capacity = SCHED_HEAP_INITIAL;
+    return 0;
+}
+
+static void queue_free_list(scheduler_timer_t *t)
+{
+    while (t) {
+        scheduler_timer_t *next = t->next;
+        free(t);
+        t = next;
+    }
+}
+
+void sched_queue_destroy(sched_queue_t *q)
+{
+    if (q->backend == SCHEDULER_BACKEND_WHEEL) {
+        queue_free_list(q->wheel.ready);
+        for (size_t pos = 0; pos < SCHED_WHEEL_LEVELS * SCHED_WHEEL_SLOTS; pos++) {
+            queue_free_list(q->wheel.slots[pos]);
+        }
+    } else {
+        for (size_t i = 0; i < q->count; i++) {
+            free(q->heap.nodes[i]);
+        }
+        free(q->heap.nodes);
+    }
+
+    memset(q, 0, sizeof(*q));
+}
+
+int sched_queue_insert(sched_queue_t *q, scheduler_timer_t *t)
+{
+    if (LIKELY(q->backend == SCHEDULER_BACKEND_WHEEL)) {
+        wheel_place(&q->wheel, t);
+        q->count++;
+        return 0;
+    }
+
+    sched_heap_t *h = &q->heap;
+    if (UNLIKELY(q->count == h->capacity)) {
+        scheduler_timer_t **nodes = realloc(h->nodes, h->capacity * 2 * sizeof(scheduler_timer_t *));
+        if (!nodes) return -1;
+        h->nodes = nodes;
+        h->capacity *= 2;
+    }
+
+    h->nodes[q->count] = t;
+    heap_sift_up(h, q->count);
+    q->count++;
+    return 0;
+}
+
+void sched_queue_remove(sched_queue_t *q, scheduler_timer_t *t)
+{
+    if (LIKELY(q->backend == SCHEDULER_BACKEND_WHEEL)) wheel_unlink(&q->wheel, t);
+    else heap_remove_at(q, t->pos);
+
+    t->pos = SCHED_QUEUE_POS_NONE;
+    q->count--;
+}
+
+scheduler_timer_t *sched_queue_pop(sched_queue_t *q, uint64_t now_ns)
+{
+    if (q->count == 0) return NULL;
+
+    scheduler_timer_t *t;
+    if (LIKELY(q->backend == SCHEDULER_BACKEND_WHEEL)) {
+        if (!q->wheel.ready) wheel_advance(&q->wheel, now_ns);
+
+        t = q->wheel.ready;
+        if (!t) return NULL;
+        wheel_unlink(&q->wheel, t);
+    } else {
+        t = q->heap.nodes[0];
+        if (t->due_ns > now_ns) return NULL;
+        heap_remove_at(q, 0);
+    }
+
+    t->pos = SCHED_QUEUE_POS_NONE;
+    q->count--;
+    return t;
+}
+
+uint64_t sched_queue_next_due(const sched_queue_t *q)
+{
+    if (q->count == 0) return UINT64_MAX;
+
+    if (LIKELY(q->backend == SCHEDULER_BACKEND_WHEEL)) return wheel_next_due(&q->wheel);
+    return q->heap.nodes[0]->due_ns;
+}
+
+scheduler_timer_t *sched_queue_find(const sched_queue_t *q, sched_queue_visit_fn fn, void *ctx)
+{
+    if (q->backend == SCHEDULER_BACKEND_WHEEL) return wheel_find(&q->wheel, fn, ctx);
+
+    for (size_t i = 0; i < q->count; i++) {
+        if (fn(q->heap.nodes[i], ctx)) return q->heap.nodes[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,96 @@
+#ifndef CORECDTL_SCHEDULER_QUEUE_H
+#define CORECDTL_SCHEDULER_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scheduler.h"
+
+/*
+ * Pending timers of the scheduler thread, ordered by absolute deadline (ns).
+ *
+ * The wheel hashes a timer into one slot of the level its distance falls
+ * in: level 0 slots are one tick wide, every level above is
+ * SCHED_WHEEL_SLOTS times coarser. Insert and remove are O(1); advancing
+ * jumps between occupied slots using per-level bitmaps and cascades a
+ * coarse slot down once time reaches it, so a timer moves at most
+ * SCHED_WHEEL_LEVELS times before it expires.
+ * The 4-ary heap is O(log n) throughout but never cascades.
+ * Not thread safe, the scheduler serializes access with its mutex.
+ */
+#define SCHED_WHEEL_LEVELS      4
+#define SCHED_WHEEL_SLOT_BITS   8
+#define SCHED_WHEEL_SLOTS       (1U << SCHED_WHEEL_SLOT_BITS)
+#define SCHED_WHEEL_TICK_SHIFT  16      // ~65.5 us ticks, level 3 reaches ~78 h ahead, later deadlines wait there
+#define SCHED_WHEEL_READY       (SCHED_WHEEL_LEVELS * SCHED_WHEEL_SLOTS)
+#define SCHED_HEAP_ARITY        4
+#define SCHED_HEAP_INITIAL      64
+#define SCHED_QUEUE_POS_NONE    UINT32_MAX  // pos of a timer removed or popped
+
+typedef struct scheduler_timer_s {
+    int id;
+    int repeating;
+    int cancelled;              /**< Set by a cancel racing the running callback, it is freed instead of re-armed */
+    int run_inline;             /**< Runs on the scheduler thread even with a worker pool */
+    sched_overrun_t overrun;
+    uint64_t missed;            /**< SCHED_OVERRUN_COALESCE: periods folded into the next run */
+    uint64_t started_ns;        /**< When the current run began */
+    // Stats, written under the scheduler mutex
+    uint64_t runs;
+    uint64_t overruns;
+    uint64_t lateness_sum_ns;
+    uint64_t lateness_max_ns;
+    uint64_t due_ns;
+    uint64_t interval_ns;
+    sched_cb_t cb;
+    plugin_id_t plugin_id;
+    void *user;
+    // Owned by the queue
+    struct scheduler_timer_s *next;
+    struct scheduler_timer_s **pprev;
+    uint32_t pos;               /**< Wheel slot / SCHED_WHEEL_READY, or heap index */
+    struct scheduler_timer_s *run_next;    /**< Owned by the scheduler while waiting for a worker */
+} scheduler_timer_t;
+
+typedef struct {
+    scheduler_timer_t *slots[SCHED_WHEEL_LEVELS * SCHED_WHEEL_SLOTS];
+    uint64_t occupied[SCHED_WHEEL_LEVELS][SCHED_WHEEL_SLOTS / 64];
+    scheduler_timer_t *ready;   /**< Due, handed out by pop */
+    uint64_t tick;              /**< Every tick before it is collected */
+} sched_wheel_t;
+
+typedef struct {
+    scheduler_timer_t **nodes;
+    size_t capacity;
+} sched_heap_t;
+
+typedef struct {
+    scheduler_backend_t backend;
+    size_t count;
+    union {
+        sched_wheel_t wheel;
+        sched_heap_t heap;
+    };
+} sched_queue_t;
+
+// Return non-zero to stop, sched_queue_find then returns that timer
+typedef int (*sched_queue_visit_fn)(scheduler_timer_t *t, void *ctx);
+
+int sched_queue_init(sched_queue_t *q, scheduler_backend_t backend, uint64_t now_ns);
+// Frees every timer still queued
+void sched_queue_destroy(sched_queue_t *q);
+
+// returns -1 when the heap cannot grow
+int sched_queue_insert(sched_queue_t *q, scheduler_timer_t *t);
+void sched_queue_remove(sched_queue_t *q, scheduler_timer_t *t);
+// Removes one timer due at now_ns, NULL when none is
+scheduler_timer_t *sched_queue_pop(sched_queue_t *q, uint64_t now_ns);
+/*
+ * Deadline to sleep until, UINT64_MAX when empty. The wheel answers the
+ * start of a coarse slot for timers above level 0, waking there only
+ * cascades them.
+ */
+uint64_t sched_queue_next_due(const sched_queue_t *q);
+scheduler_timer_t *sched_queue_find(const sched_queue_t *q, sched_queue_visit_fn fn, void *ctx);
+
+#endif //CORECDTL_SCHEDULER_QUEUE_H
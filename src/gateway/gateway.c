@@ -27,6 +27,8 @@ gateway_entry_t gateway_entry = {
 
     .eb_get_list = gateway_eb_get_list,
     .sc_get_list = gateway_sc_get_list,
+
+    .eb_get_stats = gateway_eb_get_stats,
 };
 
 gateway_init_fn init_fn;
@@ -64,6 +66,12 @@ int gateway_eb_get_list(char *out_buf, size_t buf_len)
     return 0;
 }
 
+int gateway_eb_get_stats(char *out_buf, size_t buf_len)
+{
+    event_bus_get_stats(out_buf, buf_len);
+    return 0;
+}
+
 int gateway_sc_get_list(char *out_buf, size_t buf_len)
 {
     scheduler_get_list(out_buf, buf_len);
@@ -44,13 +44,21 @@ return; \
 }
 
     LLVM_JIT_LOAD_SYMBOL(create_api_subscribe_stub);
+    LLVM_JIT_LOAD_SYMBOL(create_api_subscribe_ex_stub);
+    LLVM_JIT_LOAD_SYMBOL(create_api_publish_ex_stub);
+    LLVM_JIT_LOAD_SYMBOL(create_api_topic_backpressure_stub);
+    LLVM_JIT_LOAD_SYMBOL(create_api_topic_flag_stub);
+    LLVM_JIT_LOAD_SYMBOL(create_api_replay_stub);
     LLVM_JIT_LOAD_SYMBOL(create_api_scheduler_after_stub);
     LLVM_JIT_LOAD_SYMBOL(create_api_scheduler_every_ms_stub);
     LLVM_JIT_LOAD_SYMBOL(create_api_scheduler_cancel_stub);
+    LLVM_JIT_LOAD_SYMBOL(create_api_scheduler_timer_ex_stub);
     LLVM_JIT_LOAD_SYMBOL(create_api_hk_getter_stub);
     LLVM_JIT_LOAD_SYMBOL(create_api_hk_setter_stub);
+    LLVM_JIT_LOAD_SYMBOL(create_bus_filter_stub);
 
     LLVM_JIT_LOAD_SYMBOL(get_stub_function);
+    LLVM_JIT_LOAD_SYMBOL(destroy_stub_function);
 
 #undef LOAD_SYMBOL
 }
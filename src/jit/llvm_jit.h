@@ -9,32 +9,75 @@ typedef struct JITStub JITStub;
 typedef void (*bus_cb_t)(const void* data, size_t len, void* user);
 typedef int (*bus_subscribe_t)(uint32_t plugin_id, const char* event, bus_cb_t cb, void* user);
 
+struct bus_sub_opts_s;
+struct bus_pub_opts_s;
+typedef int (*bus_subscribe_ex_t)(uint32_t plugin_id, const char* event, bus_cb_t cb, void* user,
+                                  const struct bus_sub_opts_s* opts);
+typedef int (*bus_publish_ex_t)(uint32_t plugin_id, const char* event, const void* data, size_t len,
+                                const struct bus_pub_opts_s* opts);
+typedef int (*bus_topic_backpressure_t)(uint32_t plugin_id, const char* event, uint32_t policy,
+                                        uint32_t block_timeout_ms);
+typedef int (*bus_topic_flag_t)(uint32_t plugin_id, const char* event, int enabled);
+typedef int (*jit_replay_cb_t)(uint64_t seq, const void* data, size_t len, void* user);
+typedef int64_t (*bus_replay_t)(uint32_t plugin_id, const char* event, uint64_t from_seq, jit_replay_cb_t cb,
+                                void* user);
+
 typedef void (*sched_cb_t)(const void* data, size_t len, void* user);
 typedef int (*scheduler_after_ms_t)(uint32_t plugin_id, uint64_t ms, sched_cb_t cb, void* user);
 typedef int (*scheduler_every_ms_t)(uint32_t plugin_id, uint64_t ms, sched_cb_t cb, void* user);
 typedef int (*scheduler_cancel_t)(uint32_t plugin_id, int id);
+struct sched_timer_opts_s;
+typedef int (*scheduler_timer_ex_t)(uint32_t plugin_id, uint64_t delay_ns, uint64_t interval_ns, sched_cb_t cb,
+                                    void* user, const struct sched_timer_opts_s* opts);
 
 typedef int (*hk_get_field_t)(uint32_t plugin_id, const char* type_name, const char* field_name, void* out_value);
 typedef int (*hk_set_field_t)(uint32_t plugin_id, const char* type_name, const char* field_name, void* value);
 
+// Same layout as bus_filter_clause_t, see libs/jit/jit_stub_generator.h
+typedef struct {
+    uint32_t offset;
+    uint8_t width;
+    uint8_t cmp;
+    uint64_t mask;
+    uint64_t value;
+} jit_filter_clause_t;
+
+typedef int (*bus_filter_fn_t)(const void* data, size_t len);
+
 typedef JITStub* (*create_api_subscribe_stub_t)(uint32_t plugin_id, bus_subscribe_t real_fn);
+typedef JITStub* (*create_api_subscribe_ex_stub_t)(uint32_t plugin_id, bus_subscribe_ex_t real_fn);
+typedef JITStub* (*create_api_publish_ex_stub_t)(uint32_t plugin_id, bus_publish_ex_t real_fn);
+typedef JITStub* (*create_api_topic_backpressure_stub_t)(uint32_t plugin_id, bus_topic_backpressure_t real_fn);
+typedef JITStub* (*create_api_topic_flag_stub_t)(uint32_t plugin_id, bus_topic_flag_t real_fn);
+typedef JITStub* (*create_api_replay_stub_t)(uint32_t plugin_id, bus_replay_t real_fn);
 typedef JITStub* (*create_api_scheduler_after_stub_t)(uint32_t plugin_id, scheduler_after_ms_t real_fn);
 typedef JITStub* (*create_api_scheduler_every_ms_stub_t)(uint32_t plugin_id, scheduler_every_ms_t real_fn);
 typedef JITStub* (*create_api_scheduler_cancel_stub_t)(uint32_t plugin_id, scheduler_cancel_t real_fn);
+typedef JITStub* (*create_api_scheduler_timer_ex_stub_t)(uint32_t plugin_id, scheduler_timer_ex_t real_fn);
 typedef JITStub* (*create_api_hk_getter_stub_t)(uint32_t plugin_id, hk_get_field_t real_fn);
 typedef JITStub* (*create_api_hk_setter_stub_t)(uint32_t plugin_id, hk_set_field_t real_fn);
+typedef JITStub* (*create_bus_filter_stub_t)(const jit_filter_clause_t* clauses, size_t count);
 
 typedef void* (*get_stub_function_t)(JITStub* stub);
+typedef void (*destroy_stub_function_t)(JITStub* stub);
 
 typedef struct {
     create_api_subscribe_stub_t             create_api_subscribe_stub;
+    create_api_subscribe_ex_stub_t          create_api_subscribe_ex_stub;
+    create_api_publish_ex_stub_t            create_api_publish_ex_stub;
+    create_api_topic_backpressure_stub_t    create_api_topic_backpressure_stub;
+    create_api_topic_flag_stub_t            create_api_topic_flag_stub;
+    create_api_replay_stub_t                create_api_replay_stub;
     create_api_scheduler_after_stub_t       create_api_scheduler_after_stub;
     create_api_scheduler_every_ms_stub_t    create_api_scheduler_every_ms_stub;
     create_api_scheduler_cancel_stub_t      create_api_scheduler_cancel_stub;
+    create_api_scheduler_timer_ex_stub_t    create_api_scheduler_timer_ex_stub;
     create_api_hk_getter_stub_t             create_api_hk_getter_stub;
     create_api_hk_setter_stub_t             create_api_hk_setter_stub;
+    create_bus_filter_stub_t                create_bus_filter_stub;
 
     get_stub_function_t                     get_stub_function;
+    destroy_stub_function_t                 destroy_stub_function;
 } LLVMJITSymbols;
 
 void llvm_jit_init(void);
@@ -11,6 +11,7 @@
 #include <unistd.h>
 
 #include "heapkit.h"
+#include "event_bus.h"
 #include "plugin_api.h"
 #include "utils_id.h"
 #include "./plugin_stub.h"
@@ -32,6 +33,12 @@ static int plugin_api_obj_fns_set(plugin_handle_t *h);
 
 static plugin_id_t current_id = 1;
 
+// One "TopicQuota = <event> <rate> [burst] [reject|drop|delay]" line of the manifest
+typedef struct {
+    char event[128];
+    bus_quota_t quota;
+} plugin_topic_quota_t;
+
 typedef void (*plugin_log_fn)(plugin_handle_t* h, const char* msg);
 
 plugin_handle_t *plugin_load(const char *plugin_name, const char *path, const char *manifest_path, const char *data_path)
@@ -99,6 +106,34 @@ plugin_handle_t *plugin_load(const char *plugin_name, const char *path, const ch
     return h;
 }
 
+static int plugin_quota_action(const char *value, bus_quota_action_t *action)
+{
+    if (strncasecmp(value, "reject", 6) == 0) *action = BUS_QUOTA_REJECT;
+    else if (strncasecmp(value, "drop", 4) == 0) *action = BUS_QUOTA_DROP;
+    else if (strncasecmp(value, "delay", 5) == 0) *action = BUS_QUOTA_DELAY;
+    else return -1;
+
+    return 0;
+}
+
+static void plugin_quotas_apply(plugin_handle_t *h, const bus_quota_t *quota,
+    const plugin_topic_quota_t *topic_quotas, size_t topic_quota_count)
+{
+    // Set even without PublishRate (rate 0 = unlimited), a reused plugin id must not keep an old limit
+    if (bus_set_quota(h->info.id, NULL, quota) != 0)
+        core_log_warn("Plugin loader: Cannot set publish quota of %s", h->info.name);
+
+    for (size_t i = 0; i < topic_quota_count; i++) {
+        bus_quota_t topic_quota = topic_quotas[i].quota;
+        topic_quota.max_delay_ms = quota->max_delay_ms;
+
+        // The manifest names the topics up front, they may not have a subscriber yet
+        if (bus_topic_id(topic_quotas[i].event) == EVENT_ID_INVALID
+            || bus_set_quota(h->info.id, topic_quotas[i].event, &topic_quota) != 0)
+            core_log_warn("Plugin loader: Cannot set publish quota of %s on %s", h->info.name, topic_quotas[i].event);
+    }
+}
+
 static int plugin_manifest_set(const char *plugin_name, const char *manifest_path, plugin_handle_t *h)
 {
     FILE *file = fopen(manifest_path, "r");
@@ -107,6 +142,10 @@ static int plugin_manifest_set(const char *plugin_name, const char *manifest_pat
         return -1;
     }
 
+    bus_quota_t quota = { 0 };
+    plugin_topic_quota_t topic_quotas[PLUGIN_MAX_TOPIC_QUOTAS];
+    size_t topic_quota_count = 0;
+
     char line[256];
     while (fgets(line, sizeof(line), file)) {
         line[strcspn(line, "\r\n")] = 0;
@@ -168,6 +207,33 @@ static int plugin_manifest_set(const char *plugin_name, const char *manifest_pat
                     } else {
                         h->info.code = (int)val;
                     }
+                } else if (strcasecmp(trimmed_key, "PublishRate") == 0) {
+                    quota.rate = (uint32_t)strtoul(trimmed_value, NULL, 10);
+                } else if (strcasecmp(trimmed_key, "PublishBurst") == 0) {
+                    quota.burst = (uint32_t)strtoul(trimmed_value, NULL, 10);
+                } else if (strcasecmp(trimmed_key, "PublishMaxDelayMs") == 0) {
+                    quota.max_delay_ms = (uint32_t)strtoul(trimmed_value, NULL, 10);
+                } else if (strcasecmp(trimmed_key, "PublishExceed") == 0) {
+                    if (plugin_quota_action(trimmed_value, &quota.action) != 0)
+                        core_log_warn("Plugin loader: %s unknown PublishExceed '%s'", plugin_name, trimmed_value);
+                } else if (strcasecmp(trimmed_key, "TopicQuota") == 0) {
+                    plugin_topic_quota_t *tq = &topic_quotas[topic_quota_count];
+                    char action[16] = "reject";
+                    unsigned int rate = 0;
+                    unsigned int burst = 0;
+
+                    if (topic_quota_count == PLUGIN_MAX_TOPIC_QUOTAS ||
+                        sscanf(trimmed_value, "%127s %u %u %15s", tq->event, &rate, &burst, action) < 2) {
+                        core_log_warn("Plugin loader: %s ignored TopicQuota '%s'", plugin_name, trimmed_value);
+                        continue;
+                    }
+
+                    memset(&tq->quota, 0, sizeof(tq->quota));
+                    tq->quota.rate = rate;
+                    tq->quota.burst = burst;
+                    if (plugin_quota_action(action, &tq->quota.action) != 0)
+                        core_log_warn("Plugin loader: %s unknown TopicQuota action '%s'", plugin_name, action);
+                    topic_quota_count++;
                 }
             }
         }
@@ -176,6 +242,7 @@ static int plugin_manifest_set(const char *plugin_name, const char *manifest_pat
     fclose(file);
 
     h->info.id = current_id++;
+    plugin_quotas_apply(h, &quota, topic_quotas, topic_quota_count);
 
     return 0;
 }
@@ -304,6 +371,9 @@ void plugin_unload(plugin_handle_t *h)
     if (h->funcs.stop) h->funcs.stop();
     if (h->funcs.shutdown) h->funcs.shutdown();
 
+    // Callbacks point into the library, nothing may call them past dlclose
+    bus_unsubscribe_plugin(h->info.id);
+
 #ifdef OS_LINUX
     if (h->cold_data.so) dlclose(h->cold_data.so);
 #elif defined(__APPLE__)
@@ -7,6 +7,7 @@
 #include "platform.h"
 #include "plugin_api.h"
 #include "log.h"
+#include "event_bus.h"
 #include "utils_string.h"
 #include "plugin_manager.h"
 #include "plugin_loader.h"
@@ -151,6 +152,9 @@ plugin_op_result_t plugin_shutdown(plugin_id_t plugin_id)
         plugin->funcs.shutdown();
     }
 
+    // A dead plugin's callbacks must not run anymore
+    bus_unsubscribe_plugin(plugin_id);
+
     plugin->hot_meta.state = PLUGIN_STATE_KILLED;
     return PLUGIN_OP_SUCCESS;
 }
@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "event_bus.h"
 #include "heapkit.h"
 #include "../jit/llvm_jit.h"
@@ -9,10 +11,26 @@
 static int plugin_stub_scheduler_every(plugin_handle_t *h);
 static int plugin_stub_scheduler_after(plugin_handle_t *h);
 static int plugin_stub_scheduler_cancel(plugin_handle_t *h);
+static int plugin_stub_scheduler_after_us(plugin_handle_t *h);
+static int plugin_stub_scheduler_every_ns(plugin_handle_t *h);
 static int plugin_stub_event_bus_subscribe(plugin_handle_t *h);
+static int plugin_stub_event_bus_subscribe_ex(plugin_handle_t *h);
+static int plugin_stub_event_bus_publish_ex(plugin_handle_t *h);
+static int plugin_stub_event_bus_topic_backpressure(plugin_handle_t *h);
+static int plugin_stub_event_bus_topic_conflate(plugin_handle_t *h);
+static int plugin_stub_event_bus_topic_journal(plugin_handle_t *h);
+static int plugin_stub_event_bus_replay(plugin_handle_t *h);
+static int plugin_stub_event_bus_unsubscribe(plugin_handle_t *h);
+static int plugin_stub_scheduler_timer_ex(plugin_handle_t *h);
 static int plugin_stub_hk_get_field(plugin_handle_t *h);
 static int plugin_stub_hk_set_field(plugin_handle_t *h);
 
+// get_stub_function returns a void *, copied into the api slot since C has no object to function pointer cast
+static void plugin_stub_store(void *slot, LLVMJITSymbols *jit, JITStub *stub) {
+    void *fn = jit->get_stub_function(stub);
+    memcpy(slot, &fn, sizeof(fn));
+}
+
 int plugin_stub_setup(plugin_handle_t *h)
 {
 
@@ -22,9 +40,25 @@ int plugin_stub_setup(plugin_handle_t *h)
     if (plugin_stub_scheduler_cancel(h) != 0) return 4;
     if (plugin_stub_hk_get_field(h) != 0) return 5;
     if (plugin_stub_hk_set_field(h) != 0) return 6;
+    if (plugin_stub_scheduler_after_us(h) != 0) return 7;
+    if (plugin_stub_scheduler_every_ns(h) != 0) return 8;
+    if (plugin_stub_event_bus_subscribe_ex(h) != 0) return 9;
+    if (plugin_stub_event_bus_publish_ex(h) != 0) return 10;
+    if (plugin_stub_event_bus_topic_backpressure(h) != 0) return 11;
+    if (plugin_stub_event_bus_topic_conflate(h) != 0) return 12;
+    if (plugin_stub_event_bus_topic_journal(h) != 0) return 13;
+    if (plugin_stub_event_bus_replay(h) != 0) return 14;
+    if (plugin_stub_event_bus_unsubscribe(h) != 0) return 15;
+    if (plugin_stub_scheduler_timer_ex(h) != 0) return 16;
 
     h->core_api.publish = bus_publish;
     h->core_api.get_plugin_id = plugin_get_p_id;
+    h->core_api.topic_id = bus_topic_id;
+    h->core_api.publish_id = bus_publish_id;
+    h->core_api.publish_batch = bus_publish_batch;
+    h->core_api.loan = bus_loan;
+    h->core_api.publish_loaned = bus_publish_loaned;
+    h->core_api.loan_discard = bus_loan_discard;
 
     return 0;
 }
@@ -80,6 +114,37 @@ static int plugin_stub_scheduler_cancel(plugin_handle_t *h) {
     return 0;
 }
 
+// Same signature as after_ms / every_ms, their stub generators bind the plugin id just the same
+static int plugin_stub_scheduler_after_us(plugin_handle_t *h) {
+    LLVMJITSymbols* jit = llvm_jit_get();
+    if (!jit) return 1;
+
+    JITStub* stub = jit->create_api_scheduler_after_stub(h->info.id, scheduler_after_us);
+    if (!stub) {
+        core_log_error("Plugin_Stub: Can't create scheduler_after_us stub");
+        return 1;
+    }
+
+    plugin_stub_store(&h->core_api.timer_after_us, jit, stub);
+
+    return 0;
+}
+
+static int plugin_stub_scheduler_every_ns(plugin_handle_t *h) {
+    LLVMJITSymbols* jit = llvm_jit_get();
+    if (!jit) return 1;
+
+    JITStub* stub = jit->create_api_scheduler_every_ms_stub(h->info.id, scheduler_every_ns);
+    if (!stub) {
+        core_log_error("Plugin_Stub: Can't create scheduler_every_ns stub");
+        return 1;
+    }
+
+    plugin_stub_store(&h->core_api.timer_every_ns, jit, stub);
+
+    return 0;
+}
+
 static int plugin_stub_event_bus_subscribe(plugin_handle_t *h) {
     LLVMJITSymbols* jit = llvm_jit_get();
     if (!jit) return 1;
@@ -96,6 +161,36 @@ static int plugin_stub_event_bus_subscribe(plugin_handle_t *h) {
     return 0;
 }
 
+static int plugin_stub_event_bus_subscribe_ex(plugin_handle_t *h) {
+    LLVMJITSymbols* jit = llvm_jit_get();
+    if (!jit) return 1;
+
+    JITStub* stub = jit->create_api_subscribe_ex_stub(h->info.id, bus_subscribe_ex);
+    if (!stub) {
+        core_log_error("Plugin_Stub: Can't create event_bus subscribe_ex stub");
+        return 1;
+    }
+
+    plugin_stub_store(&h->core_api.subscribe_ex, jit, stub);
+
+    return 0;
+}
+
+static int plugin_stub_event_bus_publish_ex(plugin_handle_t *h) {
+    LLVMJITSymbols* jit = llvm_jit_get();
+    if (!jit) return 1;
+
+    JITStub* stub = jit->create_api_publish_ex_stub(h->info.id, bus_publish_ex);
+    if (!stub) {
+        core_log_error("Plugin_Stub: Can't create event_bus publish_ex stub");
+        return 1;
+    }
+
+    plugin_stub_store(&h->core_api.publish_ex, jit, stub);
+
+    return 0;
+}
+
 static int plugin_stub_hk_get_field(plugin_handle_t *h) {
     LLVMJITSymbols* jit = llvm_jit_get();
     if (!jit) return 1;
@@ -127,3 +222,94 @@ static int plugin_stub_hk_set_field(plugin_handle_t *h) {
 
     return 0;
 }
+
+static int plugin_stub_event_bus_topic_backpressure(plugin_handle_t *h) {
+    LLVMJITSymbols* jit = llvm_jit_get();
+    if (!jit) return 1;
+
+    JITStub* stub = jit->create_api_topic_backpressure_stub(h->info.id, bus_topic_set_backpressure);
+    if (!stub) {
+        core_log_error("Plugin_Stub: Can't create event_bus topic_backpressure stub");
+        return 1;
+    }
+
+    plugin_stub_store(&h->core_api.topic_backpressure, jit, stub);
+
+    return 0;
+}
+
+static int plugin_stub_event_bus_topic_conflate(plugin_handle_t *h) {
+    LLVMJITSymbols* jit = llvm_jit_get();
+    if (!jit) return 1;
+
+    JITStub* stub = jit->create_api_topic_flag_stub(h->info.id, bus_topic_set_conflated);
+    if (!stub) {
+        core_log_error("Plugin_Stub: Can't create event_bus topic_conflate stub");
+        return 1;
+    }
+
+    plugin_stub_store(&h->core_api.topic_conflate, jit, stub);
+
+    return 0;
+}
+
+static int plugin_stub_event_bus_topic_journal(plugin_handle_t *h) {
+    LLVMJITSymbols* jit = llvm_jit_get();
+    if (!jit) return 1;
+
+    JITStub* stub = jit->create_api_topic_flag_stub(h->info.id, bus_topic_set_journal);
+    if (!stub) {
+        core_log_error("Plugin_Stub: Can't create event_bus topic_journal stub");
+        return 1;
+    }
+
+    plugin_stub_store(&h->core_api.topic_journal, jit, stub);
+
+    return 0;
+}
+
+static int plugin_stub_event_bus_replay(plugin_handle_t *h) {
+    LLVMJITSymbols* jit = llvm_jit_get();
+    if (!jit) return 1;
+
+    JITStub* stub = jit->create_api_replay_stub(h->info.id, bus_replay);
+    if (!stub) {
+        core_log_error("Plugin_Stub: Can't create event_bus replay stub");
+        return 1;
+    }
+
+    plugin_stub_store(&h->core_api.replay, jit, stub);
+
+    return 0;
+}
+
+// Same signature as subscribe, so its stub generator binds the plugin id
+static int plugin_stub_event_bus_unsubscribe(plugin_handle_t *h) {
+    LLVMJITSymbols* jit = llvm_jit_get();
+    if (!jit) return 1;
+
+    JITStub* stub = jit->create_api_subscribe_stub(h->info.id, bus_unsubscribe);
+    if (!stub) {
+        core_log_error("Plugin_Stub: Can't create event_bus unsubscribe stub");
+        return 1;
+    }
+
+    plugin_stub_store(&h->core_api.unsubscribe, jit, stub);
+
+    return 0;
+}
+
+static int plugin_stub_scheduler_timer_ex(plugin_handle_t *h) {
+    LLVMJITSymbols* jit = llvm_jit_get();
+    if (!jit) return 1;
+
+    JITStub* stub = jit->create_api_scheduler_timer_ex_stub(h->info.id, scheduler_timer_ex);
+    if (!stub) {
+        core_log_error("Plugin_Stub: Can't create scheduler_timer_ex stub");
+        return 1;
+    }
+
+    plugin_stub_store(&h->core_api.timer_ex, jit, stub);
+
+    return 0;
+}
@@ -1,5 +1,7 @@
 #include "test_helpers.h"
 
+#include <time.h>
+
 void tearDown(void)
 {
 
@@ -8,4 +10,26 @@ void tearDown(void)
 void setUp(void)
 {
 
-}
\ No newline at end of file
+}
+
+int test_wait_for_int(atomic_int *value, int expected, int timeout_ms)
+{
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = 1000000L };
+
+    for (int i = 0; i < timeout_ms; i++) {
+        if (atomic_load(value) == expected) return 1;
+        nanosleep(&ts, NULL);
+    }
+    return atomic_load(value) == expected;
+}
+
+int test_wait_for_at_least(atomic_int *value, int min, int timeout_ms)
+{
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = 1000000L };
+
+    for (int i = 0; i < timeout_ms; i++) {
+        if (atomic_load(value) >= min) return 1;
+        nanosleep(&ts, NULL);
+    }
+    return atomic_load(value) >= min;
+}
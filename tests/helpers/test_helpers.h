@@ -1,4 +1,11 @@
 #ifndef CORECDTL_TEST_HELPERS_H
 #define CORECDTL_TEST_HELPERS_H
 
-#endif //CORECDTL_TEST_HELPERS_H
\ No newline at end of file
+#include <stdatomic.h>
+
+// Polls until *value == expected, returns 1 on match, 0 on timeout
+int test_wait_for_int(atomic_int *value, int expected, int timeout_ms);
+// Same, until *value >= min
+int test_wait_for_at_least(atomic_int *value, int min, int timeout_ms);
+
+#endif //CORECDTL_TEST_HELPERS_H
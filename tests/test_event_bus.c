@@ -1,6 +1,22 @@
 #include "unity.h"
+#include "crash_recovery.h"
 #include "event_bus.h"
+#include "event_bus_index.h"
+#include "event_bus_journal.h"
+#include "event_bus_pool.h"
+#include "event_bus_shm.h"
+#include "event_bus_queue.h"
+#include "event_bus_slab.h"
+#include "test_helpers.h"
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 
 static plugin_id_t plugin = 1;
 static int callback_called = 0;
@@ -31,8 +47,1044 @@ void test_bus_subscribe_and_publish(void) {
     // TEST_ASSERT_EQUAL_INT(123, callback_called);
 }
 
+static atomic_int delivered_value = 0;
+
+static void delivery_callback(const void *data, size_t len, void *user) {
+    (void)user;
+    if (data && len == sizeof(int)) atomic_store(&delivered_value, *((const int*)data));
+}
+
+void test_bus_publish_delivered(void) {
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "DELIVERY_EVENT", delivery_callback, NULL));
+
+    int val = 123;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "DELIVERY_EVENT", &val, sizeof(val)));
+
+    // Delivery is asynchronous, wait for a worker
+    TEST_ASSERT_TRUE(test_wait_for_int(&delivered_value, 123, 1000));
+}
+
 void test_event_bus_get_list(void) {
     char buf[256];
     event_bus_get_list(buf, sizeof(buf));
     TEST_ASSERT_TRUE(strstr(buf, "TEST_EVENT") != NULL);
 }
+
+static void check_queue_backend(bus_queue_backend_t backend, size_t capacity, size_t expected_capacity) {
+    bus_queue_t q;
+    bus_task_t task = {0};
+    sub_t subs[8];
+
+    TEST_ASSERT_EQUAL_INT(0, bus_queue_init(&q, backend, capacity));
+    TEST_ASSERT_EQUAL_size_t(expected_capacity, bus_queue_capacity(&q));
+
+    for (size_t i = 0; i < expected_capacity; i++) {
+        task.sub_ptr = &subs[i];
+        TEST_ASSERT_EQUAL_INT(0, bus_queue_try_push(&q, &task));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, bus_queue_try_push(&q, &task));
+    TEST_ASSERT_EQUAL_size_t(expected_capacity, bus_queue_depth(&q));
+
+    for (size_t i = 0; i < expected_capacity; i++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_queue_try_pop(&q, &task));
+        TEST_ASSERT_EQUAL_PTR(&subs[i], task.sub_ptr);
+    }
+    TEST_ASSERT_EQUAL_INT(-1, bus_queue_try_pop(&q, &task));
+
+    bus_queue_destroy(&q);
+}
+
+void test_bus_queue_backends(void) {
+    check_queue_backend(BUS_QUEUE_BACKEND_RING, 5, 8);
+    check_queue_backend(BUS_QUEUE_BACKEND_MUTEX, 5, 5);
+}
+
+void test_bus_topic_intern(void) {
+    event_id_t a = bus_topic_id("TOPIC_A");
+    event_id_t b = bus_topic_id("TOPIC_B");
+
+    TEST_ASSERT_NOT_EQUAL(EVENT_ID_INVALID, a);
+    TEST_ASSERT_NOT_EQUAL(a, b);
+    TEST_ASSERT_EQUAL_UINT16(a, bus_topic_id("TOPIC_A"));
+    TEST_ASSERT_EQUAL_UINT16(a, bus_topic_lookup("TOPIC_A"));
+    TEST_ASSERT_EQUAL_UINT16(EVENT_ID_INVALID, bus_topic_lookup("NEVER_INTERNED"));
+    TEST_ASSERT_EQUAL_STRING("TOPIC_B", bus_topic_name(b));
+}
+
+void test_bus_publish_id(void) {
+    event_id_t topic = bus_topic_id("DELIVERY_EVENT");
+    int val = 456;
+
+    TEST_ASSERT_EQUAL_INT(0, bus_publish_id(plugin, topic, &val, sizeof(val)));
+    TEST_ASSERT_TRUE(test_wait_for_int(&delivered_value, 456, 1000));
+
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_EVENT_NOT_FOUND,
+        bus_publish_id(plugin + 1, topic, &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_EVENT_NOT_FOUND,
+        bus_publish(plugin, "NEVER_INTERNED", &val, sizeof(val)));
+}
+
+static atomic_int fanout_hits = 0;
+
+static void fanout_callback(const void *data, size_t len, void *user) {
+    (void)user;
+    if (data && len == sizeof(int) && *((const int*)data) == 789) {
+        atomic_fetch_add(&fanout_hits, 1);
+    }
+}
+
+void test_bus_publish_fanout(void) {
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "FANOUT_EVENT", fanout_callback, NULL));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "FANOUT_EVENT", fanout_callback, NULL));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "FANOUT_EVENT", fanout_callback, NULL));
+
+    int val = 789;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "FANOUT_EVENT", &val, sizeof(val)));
+    TEST_ASSERT_TRUE(test_wait_for_int(&fanout_hits, 3, 1000));
+}
+
+void test_bus_publish_loaned(void) {
+    atomic_store(&fanout_hits, 0);
+
+    int *frame = bus_loan(64);
+    TEST_ASSERT_NOT_NULL(frame);
+    *frame = 789;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish_loaned(plugin, "FANOUT_EVENT", frame, sizeof(int)));
+    TEST_ASSERT_TRUE(test_wait_for_int(&fanout_hits, 3, 1000));
+
+    frame = bus_loan(sizeof(int));
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_INVALID_LENGTH,
+        bus_publish_loaned(plugin, "FANOUT_EVENT", frame, 2 * sizeof(int)));
+
+    frame = bus_loan(sizeof(int));
+    TEST_ASSERT_NOT_NULL(frame);
+    bus_loan_discard(frame);
+}
+
+void test_bus_publish_batch(void) {
+    atomic_store(&fanout_hits, 0);
+
+    int val = 789;
+    bus_msg_t msgs[] = {
+        { .event = "FANOUT_EVENT", .data = &val, .len = sizeof(val) },
+        { .topic = bus_topic_id("FANOUT_EVENT"), .data = &val, .len = sizeof(val) },
+        { .event = "NEVER_INTERNED", .data = &val, .len = sizeof(val) },
+    };
+
+    // The unknown topic is skipped, the other two still fan out
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_EVENT_NOT_FOUND, bus_publish_batch(plugin, msgs, 3));
+    TEST_ASSERT_TRUE(test_wait_for_int(&fanout_hits, 6, 1000));
+
+    TEST_ASSERT_EQUAL_INT(0, bus_publish_batch(plugin, msgs, 2));
+    TEST_ASSERT_TRUE(test_wait_for_int(&fanout_hits, 12, 1000));
+
+    // Interleaved topics each keep their own subscribers
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "BATCH_OTHER", fanout_callback, NULL));
+    bus_msg_t interleaved[] = {
+        { .event = "FANOUT_EVENT", .data = &val, .len = sizeof(val) },
+        { .event = "BATCH_OTHER", .data = &val, .len = sizeof(val) },
+        { .event = "FANOUT_EVENT", .data = &val, .len = sizeof(val) },
+        { .topic = bus_topic_id("BATCH_OTHER"), .data = &val, .len = sizeof(val) },
+    };
+    TEST_ASSERT_EQUAL_INT(0, bus_publish_batch(plugin, interleaved, 4));
+    TEST_ASSERT_TRUE(test_wait_for_int(&fanout_hits, 20, 1000));
+}
+
+static void *slab_remote_free(void *arg) {
+    bus_slab_free(arg);
+    return NULL;
+}
+
+void test_bus_slab_alloc_free(void) {
+    bus_slab_stats_t before, after;
+    bus_slab_get_stats(&before);
+
+    void *a = bus_slab_alloc(3000);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)a % 16);
+    bus_slab_free(a);
+
+    // Same class again comes from the thread cache
+    void *b = bus_slab_alloc(3000);
+    TEST_ASSERT_EQUAL_PTR(a, b);
+
+    pthread_t thr;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&thr, NULL, slab_remote_free, b));
+    pthread_join(thr, NULL);
+
+    bus_slab_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT64(before.remote_frees + 1, after.remote_frees);
+    TEST_ASSERT_EQUAL_UINT64(before.bytes_in_use, after.bytes_in_use);
+    TEST_ASSERT_TRUE(after.hits > before.hits);
+
+    // Once the local list runs dry the remotely freed block comes back
+    void *blocks[2 * BUS_SLAB_CHUNK_SIZE / 4096];
+    size_t count = 0;
+    int reclaimed = 0;
+
+    while (count < sizeof(blocks) / sizeof(blocks[0]) && !reclaimed) {
+        blocks[count] = bus_slab_alloc(3000);
+        reclaimed = blocks[count] == b;
+        count++;
+    }
+    TEST_ASSERT_TRUE(reclaimed);
+
+    for (size_t i = 0; i < count; i++) bus_slab_free(blocks[i]);
+}
+
+#define POOL_PUBLISHERS 4
+#define POOL_EVENTS_PER_PUBLISHER 2000
+
+static atomic_int pool_hits = 0;
+
+static void pool_callback(const void *data, size_t len, void *user) {
+    (void)data;
+    (void)len;
+    (void)user;
+    atomic_fetch_add(&pool_hits, 1);
+}
+
+static void *pool_publisher(void *arg) {
+    event_id_t topic = *(event_id_t*)arg;
+    for (int i = 0; i < POOL_EVENTS_PER_PUBLISHER; i++) {
+        bus_publish_id(plugin, topic, &i, sizeof(i));
+    }
+    return NULL;
+}
+
+void test_bus_pool_concurrent_publish(void) {
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "POOL_EVENT", pool_callback, NULL));
+    event_id_t topic = bus_topic_id("POOL_EVENT");
+
+    pthread_t publishers[POOL_PUBLISHERS];
+    for (int i = 0; i < POOL_PUBLISHERS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&publishers[i], NULL, pool_publisher, &topic));
+    }
+    for (int i = 0; i < POOL_PUBLISHERS; i++) {
+        pthread_join(publishers[i], NULL);
+    }
+
+    TEST_ASSERT_TRUE(test_wait_for_int(&pool_hits, POOL_PUBLISHERS * POOL_EVENTS_PER_PUBLISHER, 5000));
+
+    size_t workers = bus_pool_worker_count();
+    TEST_ASSERT_TRUE(workers >= MAX_INIT_EVENT_BUS_THREADS);
+    TEST_ASSERT_TRUE(workers <= BUS_POOL_MAX_WORKERS);
+}
+
+#define LANE_FLOOD 50
+
+static atomic_int lane_gate_open = 0;
+static atomic_int lane_gate_entered = 0;
+static atomic_int lane_order = 0;
+static atomic_int lane_realtime_pos = -1;
+
+static void lane_gate_callback(const void *data, size_t len, void *user) {
+    (void)data;
+    (void)len;
+    (void)user;
+    atomic_fetch_add(&lane_gate_entered, 1);
+    while (!atomic_load(&lane_gate_open)) sched_yield();
+}
+
+static void lane_order_callback(const void *data, size_t len, void *user) {
+    (void)len;
+    (void)user;
+    int pos = atomic_fetch_add(&lane_order, 1);
+    if (*(const int*)data == -1) atomic_store(&lane_realtime_pos, pos);
+}
+
+void test_bus_priority_lanes(void) {
+    bus_sub_opts_t bulk = { .priority = BUS_PRIORITY_BULK };
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(plugin, "LANE_GATE", lane_gate_callback, NULL, &bulk));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "LANE_EVENT", lane_order_callback, NULL));
+
+    // Park every worker inside a bulk callback
+    int workers = (int)bus_pool_worker_count();
+    for (int i = 0; i < workers; i++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "LANE_GATE", &i, sizeof(i)));
+    }
+    TEST_ASSERT_TRUE(test_wait_for_int(&lane_gate_entered, workers, 1000));
+
+    for (int i = 0; i < LANE_FLOOD; i++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "LANE_EVENT", &i, sizeof(i)));
+    }
+    int urgent = -1;
+    bus_pub_opts_t realtime = { .priority = BUS_PRIORITY_REALTIME };
+    TEST_ASSERT_EQUAL_INT(0, bus_publish_ex(plugin, "LANE_EVENT", &urgent, sizeof(urgent), &realtime));
+
+    atomic_store(&lane_gate_open, 1);
+    TEST_ASSERT_TRUE(test_wait_for_int(&lane_order, LANE_FLOOD + 1, 1000));
+
+    // Published last, still among the first pops once the workers are free
+    TEST_ASSERT_TRUE(atomic_load(&lane_realtime_pos) >= 0);
+    TEST_ASSERT_TRUE(atomic_load(&lane_realtime_pos) < (int)bus_pool_worker_count());
+
+    bus_lane_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, bus_get_lane_stats(BUS_PRIORITY_REALTIME, &stats));
+    TEST_ASSERT_EQUAL_UINT64(1, stats.delivered);
+    TEST_ASSERT_TRUE(stats.wait_max_ns >= stats.wait_avg_ns);
+    TEST_ASSERT_EQUAL_INT(0, bus_get_lane_stats(BUS_PRIORITY_BULK, &stats));
+    TEST_ASSERT_TRUE(stats.delivered >= (uint64_t)workers);
+    TEST_ASSERT_EQUAL_INT(-1, bus_get_lane_stats(BUS_PRIORITY_INHERIT, &stats));
+}
+
+static atomic_int bp_gate_open = 0;
+static atomic_int bp_delivered = 0;
+static atomic_int bp_coalesced_hits = 0;
+static atomic_int bp_coalesced_sum = 0;
+
+static void bp_gate_callback(const void *data, size_t len, void *user) {
+    (void)data;
+    (void)len;
+    (void)user;
+    while (!atomic_load(&bp_gate_open)) sched_yield();
+    atomic_fetch_add(&bp_delivered, 1);
+}
+
+static void bp_coalesce_callback(const void *data, size_t len, void *user) {
+    (void)len;
+    (void)user;
+    atomic_fetch_add(&bp_coalesced_hits, 1);
+    atomic_fetch_add(&bp_coalesced_sum, *(const int*)data);
+}
+
+void test_bus_backpressure_policies(void) {
+    bus_sub_opts_t realtime = { .priority = BUS_PRIORITY_REALTIME };
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "BP_EVENT", bp_gate_callback, NULL));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(plugin, "BP_COALESCE", bp_coalesce_callback, NULL, &realtime));
+
+    // Every worker ends up stuck in the gate, then the normal lane fills up.
+    // A full lane also spawns workers, keep going until the pool stops growing
+    int val = 1;
+    int accepted = 0;
+    int extra;
+    size_t workers;
+    struct timespec settle = { .tv_sec = 0, .tv_nsec = 20000000L };
+    bus_pub_opts_t opts = { .backpressure = BUS_BACKPRESSURE_FAIL };
+    do {
+        workers = bus_pool_worker_count();
+        nanosleep(&settle, NULL);
+        extra = 0;
+        while (extra < 1000000 && bus_publish_ex(plugin, "BP_EVENT", &val, sizeof(val), &opts) == 0) extra++;
+        accepted += extra;
+    } while (extra > 0 || bus_pool_worker_count() != workers);
+
+    bus_backpressure_stats_t before, after;
+    bus_get_backpressure_stats(&before);
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_QUEUE_FULL, bus_publish_ex(plugin, "BP_EVENT", &val, sizeof(val), &opts));
+
+    opts.backpressure = BUS_BACKPRESSURE_DROP_NEWEST;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish_ex(plugin, "BP_EVENT", &val, sizeof(val), &opts));
+
+    TEST_ASSERT_EQUAL_INT(0, bus_topic_set_backpressure(plugin, "BP_EVENT", BUS_BACKPRESSURE_BLOCK, 10));
+    // Only the owner and the core may change it afterwards
+    TEST_ASSERT_EQUAL_INT(BUS_SUB_ERR_NOT_OWNER,
+                          bus_topic_set_backpressure(plugin + 1, "BP_EVENT", BUS_BACKPRESSURE_FAIL, 0));
+    TEST_ASSERT_EQUAL_INT(0, bus_topic_set_backpressure(PLUGIN_ID_INVALID, "BP_EVENT", BUS_BACKPRESSURE_BLOCK, 10));
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_QUEUE_FULL, bus_publish(plugin, "BP_EVENT", &val, sizeof(val)));
+
+    opts.backpressure = BUS_BACKPRESSURE_DROP_OLDEST;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish_ex(plugin, "BP_EVENT", &val, sizeof(val), &opts));
+
+    // The realtime lane still has room, only the latest value per key survives
+    opts.backpressure = BUS_BACKPRESSURE_COALESCE;
+    for (int v = 1; v <= 3; v++) {
+        opts.key = 7;
+        TEST_ASSERT_EQUAL_INT(0, bus_publish_ex(plugin, "BP_COALESCE", &v, sizeof(v), &opts));
+    }
+    int other = 10;
+    opts.key = 8;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish_ex(plugin, "BP_COALESCE", &other, sizeof(other), &opts));
+
+    bus_get_backpressure_stats(&after);
+    TEST_ASSERT_EQUAL_UINT64(before.failed + 1, after.failed);
+    TEST_ASSERT_EQUAL_UINT64(before.dropped_newest + 1, after.dropped_newest);
+    TEST_ASSERT_EQUAL_UINT64(before.block_timeouts + 1, after.block_timeouts);
+    TEST_ASSERT_EQUAL_UINT64(before.dropped_oldest + 1, after.dropped_oldest);
+    TEST_ASSERT_EQUAL_UINT64(before.coalesced + 2, after.coalesced);
+
+    atomic_store(&bp_gate_open, 1);
+    TEST_ASSERT_TRUE(test_wait_for_int(&bp_delivered, accepted, 5000));
+    TEST_ASSERT_TRUE(test_wait_for_int(&bp_coalesced_hits, 2, 1000));
+    TEST_ASSERT_EQUAL_INT(13, atomic_load(&bp_coalesced_sum));
+
+    TEST_ASSERT_EQUAL_INT(0, bus_topic_set_backpressure(plugin, "BP_EVENT", BUS_BACKPRESSURE_BLOCK, 0));
+}
+
+#define ORDER_KEYS 4
+#define ORDER_EVENTS 2000
+
+static atomic_int order_last[ORDER_KEYS];
+static atomic_int order_in_flight[ORDER_KEYS];
+static atomic_int order_violations = 0;
+static atomic_int order_hits = 0;
+
+static void order_callback(const void *data, size_t len, void *user) {
+    (void)len;
+    (void)user;
+    int seq = *(const int*)data;
+    int key = seq % ORDER_KEYS;
+
+    // No two workers inside the same key, and sequence numbers only grow
+    if (atomic_fetch_add(&order_in_flight[key], 1) != 0) atomic_fetch_add(&order_violations, 1);
+    if (atomic_exchange(&order_last[key], seq) >= seq) atomic_fetch_add(&order_violations, 1);
+    atomic_fetch_sub(&order_in_flight[key], 1);
+
+    atomic_fetch_add(&order_hits, 1);
+}
+
+void test_bus_ordered_delivery(void) {
+    bus_sub_opts_t ordered = { .ordered = 1 };
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(plugin, "ORDER_EVENT", order_callback, NULL, &ordered));
+
+    for (int k = 0; k < ORDER_KEYS; k++) atomic_store(&order_last[k], -1);
+
+    bus_pub_opts_t opts = { 0 };
+    for (int seq = 0; seq < ORDER_EVENTS; seq++) {
+        opts.key = (uint64_t)(seq % ORDER_KEYS);
+        TEST_ASSERT_EQUAL_INT(0, bus_publish_ex(plugin, "ORDER_EVENT", &seq, sizeof(seq), &opts));
+    }
+
+    TEST_ASSERT_TRUE(test_wait_for_int(&order_hits, ORDER_EVENTS, 5000));
+    TEST_ASSERT_EQUAL_INT(0, atomic_load(&order_violations));
+}
+
+static atomic_int wild_one_hits = 0;
+static atomic_int wild_all_hits = 0;
+static atomic_int wild_exact_hits = 0;
+static atomic_int wild_late_hits = 0;
+
+static void wild_callback(const void *data, size_t len, void *user) {
+    (void)data;
+    (void)len;
+    atomic_fetch_add((atomic_int *)user, 1);
+}
+
+void test_bus_wildcard_topics(void) {
+    TEST_ASSERT_EQUAL_INT(BUS_SUB_ERR_INVALID_EVENT, bus_subscribe(plugin, "wild.#.temp", wild_callback, &wild_all_hits));
+    TEST_ASSERT_EQUAL_INT(BUS_SUB_ERR_INVALID_EVENT, bus_subscribe(plugin, "wild.te*", wild_callback, &wild_all_hits));
+
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "wild.*.temp", wild_callback, &wild_one_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "wild.#", wild_callback, &wild_all_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "wild.room1.temp", wild_callback, &wild_exact_hits));
+
+    int val = 1;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "wild.room1.temp", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "wild.room2.temp", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "wild.room2.humidity", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "wild", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_EVENT_NOT_FOUND, bus_publish(plugin, "other.room1.temp", &val, sizeof(val)));
+    // Names only wildcards want are matched without taking a topic id
+    TEST_ASSERT_EQUAL_UINT16(EVENT_ID_INVALID, bus_topic_lookup("wild.room2.temp"));
+    TEST_ASSERT_EQUAL_UINT16(EVENT_ID_INVALID, bus_topic_lookup("other.room1.temp"));
+
+    TEST_ASSERT_TRUE(test_wait_for_int(&wild_all_hits, 4, 1000));
+    TEST_ASSERT_TRUE(test_wait_for_int(&wild_one_hits, 2, 1000));
+    TEST_ASSERT_TRUE(test_wait_for_int(&wild_exact_hits, 1, 1000));
+
+    // A later pattern invalidates the route cached for an already published topic
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "wild.*.humidity", wild_callback, &wild_late_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "wild.room2.humidity", &val, sizeof(val)));
+
+    TEST_ASSERT_TRUE(test_wait_for_int(&wild_late_hits, 1, 1000));
+    TEST_ASSERT_TRUE(test_wait_for_int(&wild_all_hits, 5, 1000));
+    TEST_ASSERT_EQUAL_INT(2, atomic_load(&wild_one_hits));
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&wild_exact_hits));
+
+    // Repeats of an uninterned name reuse its cached match, dropping the pattern clears it
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "wild.room3.humidity", &val, sizeof(val)));
+    }
+    TEST_ASSERT_TRUE(test_wait_for_int(&wild_late_hits, 4, 1000));
+    TEST_ASSERT_EQUAL_INT(0, bus_unsubscribe(plugin, "wild.*.humidity", wild_callback, &wild_late_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "wild.room3.humidity", &val, sizeof(val)));
+    TEST_ASSERT_TRUE(test_wait_for_int(&wild_all_hits, 9, 1000));
+    TEST_ASSERT_EQUAL_INT(4, atomic_load(&wild_late_hits));
+    TEST_ASSERT_EQUAL_UINT16(EVENT_ID_INVALID, bus_topic_lookup("wild.room3.humidity"));
+}
+
+static atomic_int inline_hits = 0;
+static pthread_t inline_thread;
+
+static void inline_callback(const void *data, size_t len, void *user) {
+    (void)data;
+    (void)len;
+    (void)user;
+    inline_thread = pthread_self();
+    atomic_fetch_add(&inline_hits, 1);
+}
+
+void test_bus_inline_delivery(void) {
+    bus_sub_opts_t direct = { .direct = 1 };
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(plugin, "INLINE_EVENT", inline_callback, NULL, &direct));
+
+    // Delivered before publish returns, on this thread
+    int val = 1;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "INLINE_EVENT", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&inline_hits));
+    TEST_ASSERT_TRUE(pthread_equal(inline_thread, pthread_self()));
+
+    // A queued subscriber with a fast callback gets promoted after enough samples
+    bus_set_inline_promotion(1000000);
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "PROMOTE_EVENT", inline_callback, NULL));
+
+    int promoted = 0;
+    for (int i = 0; i < BUS_INLINE_PROMOTE_SAMPLES * 4 && !promoted; i++) {
+        int expected = atomic_load(&inline_hits) + 1;
+        TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "PROMOTE_EVENT", &val, sizeof(val)));
+        TEST_ASSERT_TRUE(test_wait_for_int(&inline_hits, expected, 1000));
+        promoted = pthread_equal(inline_thread, pthread_self());
+    }
+    bus_set_inline_promotion(0);
+
+    TEST_ASSERT_TRUE(promoted);
+}
+
+#define STATS_EVENTS 20
+
+static atomic_int stats_hits = 0;
+
+static void stats_callback(const void *data, size_t len, void *user) {
+    (void)data;
+    (void)len;
+    (void)user;
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = 200000L };
+    nanosleep(&ts, NULL);
+    atomic_fetch_add(&stats_hits, 1);
+}
+
+void test_bus_latency_stats(void) {
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "STATS_EVENT", stats_callback, NULL));
+    event_id_t topic = bus_topic_id("STATS_EVENT");
+
+    int val = 1;
+    for (int i = 0; i < STATS_EVENTS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_publish_id(plugin, topic, &val, sizeof(val)));
+    }
+    TEST_ASSERT_TRUE(test_wait_for_int(&stats_hits, STATS_EVENTS, 5000));
+
+    // The histogram is recorded right after the callback returns
+    bus_latency_stats_t stats;
+    for (int i = 0; i < 1000; i++) {
+        if (bus_get_latency_stats(BUS_STATS_TOPIC, topic, &stats) == 0 && stats.exec.count == STATS_EVENTS) break;
+        sched_yield();
+    }
+    TEST_ASSERT_EQUAL_UINT64(STATS_EVENTS, stats.exec.count);
+    TEST_ASSERT_TRUE(stats.exec.p50_ns >= 200000);
+    TEST_ASSERT_TRUE(stats.exec.p50_ns <= stats.exec.p99_ns);
+    TEST_ASSERT_TRUE(stats.exec.p99_ns <= stats.exec.max_ns);
+
+    TEST_ASSERT_EQUAL_INT(0, bus_get_latency_stats(BUS_STATS_PLUGIN, plugin, &stats));
+    TEST_ASSERT_TRUE(stats.wait.count >= STATS_EVENTS);
+    TEST_ASSERT_EQUAL_INT(0, bus_get_latency_stats(BUS_STATS_ALL, 0, &stats));
+    TEST_ASSERT_TRUE(stats.wait.count >= STATS_EVENTS);
+    TEST_ASSERT_EQUAL_INT(-1, bus_get_latency_stats(BUS_STATS_TOPIC, bus_topic_id("STATS_UNUSED"), &stats));
+
+    bus_lane_stats_t lane;
+    TEST_ASSERT_EQUAL_INT(0, bus_get_lane_stats(BUS_PRIORITY_NORMAL, &lane));
+    TEST_ASSERT_TRUE(lane.depth_hwm >= 1);
+
+    char buf[8192];
+    event_bus_get_stats(buf, sizeof(buf));
+    TEST_ASSERT_TRUE(strstr(buf, "[topic] STATS_EVENT") != NULL);
+    TEST_ASSERT_TRUE(strstr(buf, "[lane] normal") != NULL);
+}
+
+#define LVC_UPDATES 1000
+
+static atomic_int lvc_replay_hits = 0;
+static atomic_int lvc_replay_sum = 0;
+static atomic_int lvc_hits = 0;
+static atomic_int lvc_last = 0;
+
+static void lvc_replay_callback(const void *data, size_t len, void *user) {
+    (void)len;
+    (void)user;
+    atomic_fetch_add(&lvc_replay_sum, *(const int*)data);
+    atomic_fetch_add(&lvc_replay_hits, 1);
+}
+
+static void lvc_callback(const void *data, size_t len, void *user) {
+    (void)len;
+    (void)user;
+    atomic_store(&lvc_last, *(const int*)data);
+    atomic_fetch_add(&lvc_hits, 1);
+}
+
+void test_bus_conflated_topics(void) {
+    // Setters never intern, the topic has to exist first
+    TEST_ASSERT_EQUAL_INT(BUS_SUB_ERR_NOT_FOUND, bus_topic_set_conflated(plugin, "LVC_EVENT", 1));
+    TEST_ASSERT_NOT_EQUAL(EVENT_ID_INVALID, bus_topic_id("LVC_EVENT"));
+    TEST_ASSERT_EQUAL_INT(0, bus_topic_set_conflated(plugin, "LVC_EVENT", 1));
+    TEST_ASSERT_EQUAL_INT(BUS_SUB_ERR_NOT_OWNER, bus_topic_set_conflated(plugin + 1, "LVC_EVENT", 0));
+
+    // Retained even though nobody listens yet, only the newest value per key
+    bus_pub_opts_t opts = { 0 };
+    int val;
+    for (val = 1; val <= 10; val++) {
+        opts.key = 1;
+        TEST_ASSERT_EQUAL_INT(0, bus_publish_ex(plugin, "LVC_EVENT", &val, sizeof(val), &opts));
+    }
+    val = 20;
+    opts.key = 2;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish_ex(plugin, "LVC_EVENT", &val, sizeof(val), &opts));
+
+    bus_sub_opts_t last_value = { .last_value = 1 };
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(plugin, "LVC_EVENT", lvc_replay_callback, NULL, &last_value));
+    TEST_ASSERT_TRUE(test_wait_for_int(&lvc_replay_hits, 2, 1000));
+    TEST_ASSERT_EQUAL_INT(30, atomic_load(&lvc_replay_sum));
+
+    // A burst on one key never queues more than one delivery per subscriber
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "LVC_EVENT", lvc_callback, NULL));
+    opts.key = 3;
+    for (val = 1; val <= LVC_UPDATES; val++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_publish_ex(plugin, "LVC_EVENT", &val, sizeof(val), &opts));
+    }
+
+    TEST_ASSERT_TRUE(test_wait_for_int(&lvc_last, LVC_UPDATES, 1000));
+    TEST_ASSERT_TRUE(atomic_load(&lvc_hits) <= LVC_UPDATES);
+
+    TEST_ASSERT_EQUAL_INT(0, bus_topic_set_conflated(plugin, "LVC_EVENT", 0));
+}
+
+#define JOURNAL_RECORDS 3000
+
+typedef struct {
+    uint64_t first_seq;
+    uint64_t last_seq;
+    int count;
+    int sum;
+    int stop_after;
+} journal_replay_t;
+
+static int journal_replay_callback(uint64_t seq, const void *data, size_t len, void *user) {
+    journal_replay_t *r = user;
+    TEST_ASSERT_EQUAL_size_t(sizeof(int), len);
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)data % BUS_JOURNAL_ALIGN);
+
+    if (r->count == 0) r->first_seq = seq;
+    TEST_ASSERT_TRUE(seq > r->last_seq);
+    r->last_seq = seq;
+    r->count++;
+    r->sum += *(const int *)data;
+    return r->stop_after && r->count == r->stop_after;
+}
+
+static void journal_remove_dir(const char *path) {
+    DIR *dir = opendir(path);
+    if (!dir) return;
+
+    struct dirent *entry;
+    char file[512];
+    while ((entry = readdir(dir))) {
+        if (entry->d_name[0] == '.') continue;
+        snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+        unlink(file);
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+void test_bus_journal_replay(void) {
+    char dir[] = "/tmp/corecdtl_journal_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+
+    bus_config_t config = BUS_CONFIG_DEFAULT;
+    config.journal_dir = dir;
+    config.journal_segment_bytes = BUS_JOURNAL_MIN_SEGMENT;
+    config.journal_retain_bytes = 0;
+    TEST_ASSERT_EQUAL_INT(-1, bus_topic_set_journal(plugin, "JRNL_EVENT", 1));
+    TEST_ASSERT_EQUAL_INT(0, bus_journal_init(&config));
+    TEST_ASSERT_NOT_EQUAL(EVENT_ID_INVALID, bus_topic_id("JRNL_EVENT"));
+    TEST_ASSERT_EQUAL_INT(0, bus_topic_set_journal(plugin, "JRNL_EVENT", 1));
+
+    // Nobody subscribed, the publishes still land in the journal, across several segments
+    int val;
+    for (val = 1; val <= JOURNAL_RECORDS; val++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "JRNL_EVENT", &val, sizeof(val)));
+    }
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin + 1, "JRNL_EVENT", &val, sizeof(val)));
+
+    journal_replay_t r = { 0 };
+    TEST_ASSERT_EQUAL_INT64(JOURNAL_RECORDS, bus_replay(plugin, "JRNL_EVENT", 0, journal_replay_callback, &r));
+    TEST_ASSERT_EQUAL_INT(JOURNAL_RECORDS * (JOURNAL_RECORDS + 1) / 2, r.sum);
+
+    const uint64_t from = r.first_seq + 100;
+    memset(&r, 0, sizeof(r));
+    r.stop_after = 10;
+    TEST_ASSERT_EQUAL_INT64(10, bus_replay(plugin, "JRNL_EVENT", from, journal_replay_callback, &r));
+    TEST_ASSERT_EQUAL_UINT64(from, r.first_seq);
+    TEST_ASSERT_EQUAL_INT(101 * 10 + 45, r.sum);
+
+    // A restart picks the segments up again and keeps counting
+    const uint64_t next_seq = bus_journal_next_seq();
+    bus_journal_destroy();
+    TEST_ASSERT_EQUAL_INT(0, bus_journal_init(&config));
+    TEST_ASSERT_EQUAL_UINT64(next_seq, bus_journal_next_seq());
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_EQUAL_INT64(JOURNAL_RECORDS, bus_replay(plugin, "JRNL_EVENT", 0, journal_replay_callback, &r));
+
+    // A segment rolled just before a crash holds no record, recovery drops it instead of reopening it
+    bus_journal_destroy();
+    char empty_path[PATH_MAX];
+    snprintf(empty_path, sizeof(empty_path), "%s/bus-%020llu.journal", dir, (unsigned long long)next_seq);
+    FILE *empty = fopen(empty_path, "wb");
+    TEST_ASSERT_NOT_NULL(empty);
+    bus_journal_header_t header = { 0 };
+    memcpy(header.magic, BUS_JOURNAL_MAGIC, sizeof(header.magic));
+    header.first_seq = next_seq;
+    TEST_ASSERT_EQUAL_INT(1, fwrite(&header, sizeof(header), 1, empty));
+    TEST_ASSERT_EQUAL_INT(0, ftruncate(fileno(empty), BUS_JOURNAL_MIN_SEGMENT));
+    fclose(empty);
+
+    TEST_ASSERT_EQUAL_INT(0, bus_journal_init(&config));
+    TEST_ASSERT_EQUAL_UINT64(next_seq, bus_journal_next_seq());
+    TEST_ASSERT_EQUAL_INT(-1, access(empty_path, F_OK));
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_EQUAL_INT64(JOURNAL_RECORDS, bus_replay(plugin, "JRNL_EVENT", 0, journal_replay_callback, &r));
+
+    // Size retention only ever keeps the active segment plus whatever fits
+    bus_journal_destroy();
+    config.journal_retain_bytes = 2 * BUS_JOURNAL_MIN_SEGMENT;
+    TEST_ASSERT_EQUAL_INT(0, bus_journal_init(&config));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "JRNL_EVENT", &val, sizeof(val)));
+
+    memset(&r, 0, sizeof(r));
+    TEST_ASSERT_TRUE(bus_replay(plugin, "JRNL_EVENT", 0, journal_replay_callback, &r) < JOURNAL_RECORDS);
+    TEST_ASSERT_EQUAL_UINT64(next_seq, r.last_seq);
+
+    TEST_ASSERT_EQUAL_INT(0, bus_topic_set_journal(plugin, "JRNL_EVENT", 0));
+    bus_journal_destroy();
+    TEST_ASSERT_EQUAL_INT64(-1, bus_replay(plugin, "JRNL_EVENT", 0, journal_replay_callback, &r));
+    journal_remove_dir(dir);
+}
+
+#define SHM_EVENTS 32
+
+static atomic_int shm_up_hits = 0;
+static atomic_int shm_up_last = 0;
+
+static void shm_up_callback(const void *data, size_t len, void *user) {
+    (void)user;
+    if (len == sizeof(int)) atomic_store(&shm_up_last, *(const int *)data);
+    atomic_fetch_add(&shm_up_hits, 1);
+}
+
+static void shm_down_callback(const void *data, size_t len, void *user) {
+    int *sum = user;
+    if (len == sizeof(int)) *sum += *(const int *)data;
+}
+
+// Runs in the forked child, reports through the exit code and one publish
+static int shm_remote_main(int fd) {
+    bus_shm_client_t *client = bus_shm_attach(fd);
+    if (!client) return 1;
+
+    int sum = 0;
+    const int sub_id = bus_shm_client_subscribe(client, "SHM.DOWN.*", shm_down_callback, &sum);
+    if (sub_id < 0) return 2;
+
+    for (int i = 0; i < 100 && bus_shm_client_sub_status(client, sub_id) == 0; i++) {
+        bus_shm_client_poll(client, 10);
+    }
+    if (bus_shm_client_sub_status(client, sub_id) != 1) return 3;
+
+    int ready = -1;
+    if (bus_shm_client_publish(client, "SHM_UP", &ready, sizeof(ready)) != 0) return 4;
+
+    const int expected = SHM_EVENTS * (SHM_EVENTS + 1) / 2;
+    for (int i = 0; i < 500 && sum < expected; i++) {
+        if (bus_shm_client_poll(client, 10) < 0) return 5;
+    }
+    if (sum != expected) return 6;
+
+    if (bus_shm_client_publish(client, "SHM_UP", &sum, sizeof(sum)) != 0) return 7;
+    bus_shm_detach(client);
+    return 0;
+}
+
+void test_bus_shm_transport(void) {
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "SHM_UP", shm_up_callback, NULL));
+
+    const int fd = bus_shm_open(plugin, 64, 64);
+    TEST_ASSERT_TRUE(fd >= 0);
+
+    const pid_t pid = fork();
+    TEST_ASSERT_TRUE(pid >= 0);
+    if (pid == 0) _exit(shm_remote_main(fd));
+
+    // The remote's wildcard subscription is live once it says so
+    TEST_ASSERT_TRUE(test_wait_for_int(&shm_up_last, -1, 5000));
+
+    for (int val = 1; val <= SHM_EVENTS; val++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "SHM.DOWN.temp", &val, sizeof(val)));
+    }
+    // Other plugins' topics never cross over
+    int other = 1000;
+    bus_publish(plugin + 1, "SHM.DOWN.temp", &other, sizeof(other));
+
+    TEST_ASSERT_TRUE(test_wait_for_int(&shm_up_last, SHM_EVENTS * (SHM_EVENTS + 1) / 2, 5000));
+    TEST_ASSERT_EQUAL_INT(2, atomic_load(&shm_up_hits));
+
+    int status = 0;
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+
+    TEST_ASSERT_EQUAL_INT(0, bus_shm_close(fd));
+    TEST_ASSERT_EQUAL_INT(-1, bus_shm_close(fd));
+
+    // Closing removed the remote's subscription
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_EVENT_NOT_FOUND, bus_publish(plugin, "SHM.DOWN.temp", &other, sizeof(other)));
+}
+
+#define UNSUB_EVENTS 200
+
+static atomic_int unsub_hits = 0;
+static atomic_int unsub_slow_hits = 0;
+static atomic_int unsub_self_hits = 0;
+
+static void unsub_callback(const void *data, size_t len, void *user) {
+    (void)data;
+    (void)len;
+    atomic_fetch_add((atomic_int *)user, 1);
+}
+
+static void unsub_slow_callback(const void *data, size_t len, void *user) {
+    (void)data;
+    (void)len;
+    (void)user;
+    const struct timespec pause = { .tv_sec = 0, .tv_nsec = 200000L };
+    nanosleep(&pause, NULL);
+    atomic_fetch_add(&unsub_slow_hits, 1);
+}
+
+static void unsub_self_callback(const void *data, size_t len, void *user) {
+    (void)data;
+    (void)len;
+    (void)user;
+    atomic_fetch_add(&unsub_self_hits, 1);
+    bus_unsubscribe(plugin, "UNSUB_SELF", unsub_self_callback, NULL);
+}
+
+void test_bus_unsubscribe(void) {
+    int val = 1;
+
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "UNSUB_EVENT", unsub_callback, &unsub_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "UNSUB_EVENT", &val, sizeof(val)));
+    TEST_ASSERT_TRUE(test_wait_for_int(&unsub_hits, 1, 1000));
+
+    // user is part of the match
+    TEST_ASSERT_EQUAL_INT(BUS_SUB_ERR_NOT_FOUND, bus_unsubscribe(plugin, "UNSUB_EVENT", unsub_callback, NULL));
+    TEST_ASSERT_EQUAL_INT(0, bus_unsubscribe(plugin, "UNSUB_EVENT", unsub_callback, &unsub_hits));
+    TEST_ASSERT_EQUAL_INT(BUS_SUB_ERR_NOT_FOUND, bus_unsubscribe(plugin, "UNSUB_EVENT", unsub_callback, &unsub_hits));
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_EVENT_NOT_FOUND, bus_publish(plugin, "UNSUB_EVENT", &val, sizeof(val)));
+
+    // Deliveries still queued when it returns never reach the callback
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "UNSUB_SLOW", unsub_slow_callback, NULL));
+    for (int i = 0; i < UNSUB_EVENTS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "UNSUB_SLOW", &val, sizeof(val)));
+    }
+    TEST_ASSERT_EQUAL_INT(0, bus_unsubscribe(plugin, "UNSUB_SLOW", unsub_slow_callback, NULL));
+    const int slow_hits = atomic_load(&unsub_slow_hits);
+    usleep(20000);
+    TEST_ASSERT_EQUAL_INT(slow_hits, atomic_load(&unsub_slow_hits));
+
+    // A callback may remove its own subscription
+    bus_sub_opts_t direct = { .direct = 1 };
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(plugin, "UNSUB_SELF", unsub_self_callback, NULL, &direct));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "UNSUB_SELF", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_EVENT_NOT_FOUND, bus_publish(plugin, "UNSUB_SELF", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&unsub_self_hits));
+
+    // Plugin unload drops exact, wildcard and ordered subscriptions alike
+    const plugin_id_t unloaded = 42;
+    bus_sub_opts_t ordered = { .ordered = 1 };
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(unloaded, "unsub.room1", unsub_callback, &unsub_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(unloaded, "unsub.*", unsub_callback, &unsub_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(unloaded, "UNSUB_ORDERED", unsub_callback, &unsub_hits, &ordered));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(unloaded, "unsub.room1", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(unloaded, "UNSUB_ORDERED", &val, sizeof(val)));
+    TEST_ASSERT_TRUE(test_wait_for_int(&unsub_hits, 4, 1000));
+
+    TEST_ASSERT_EQUAL_INT(3, bus_unsubscribe_plugin(unloaded));
+    TEST_ASSERT_EQUAL_INT(0, bus_unsubscribe_plugin(unloaded));
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_EVENT_NOT_FOUND, bus_publish(unloaded, "unsub.room1", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_EVENT_NOT_FOUND, bus_publish(unloaded, "unsub.room2", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_EVENT_NOT_FOUND, bus_publish(unloaded, "UNSUB_ORDERED", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(4, atomic_load(&unsub_hits));
+}
+
+typedef struct {
+    uint32_t kind;
+    uint32_t flags;
+} filter_msg_t;
+
+static atomic_int filter_hits = 0;
+static atomic_int filter_all_hits = 0;
+
+static void filter_callback(const void *data, size_t len, void *user) {
+    (void)data;
+    (void)len;
+    atomic_fetch_add((atomic_int *)user, 1);
+}
+
+void test_bus_publish_filters(void) {
+    // kind == 7 && (flags & 0xF0) > 0x20
+    const bus_filter_clause_t clauses[] = {
+        { .offset = offsetof(filter_msg_t, kind), .width = 4, .cmp = BUS_FILTER_EQ, .value = 7 },
+        { .offset = offsetof(filter_msg_t, flags), .width = 4, .cmp = BUS_FILTER_GT, .mask = 0xF0, .value = 0x20 },
+    };
+    bus_sub_opts_t opts = { .direct = 1, .filter = clauses, .filter_len = 2 };
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(plugin, "FILTER_EVENT", filter_callback, &filter_hits, &opts));
+
+    filter_msg_t msg = { .kind = 7, .flags = 0x31 };
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "FILTER_EVENT", &msg, sizeof(msg)));
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&filter_hits));
+
+    // Rejected everywhere: nothing is copied or queued, yet the publish succeeds
+    msg.kind = 8;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "FILTER_EVENT", &msg, sizeof(msg)));
+    msg.kind = 7;
+    msg.flags = 0x2F;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "FILTER_EVENT", &msg, sizeof(msg)));
+    // Too short to hold every field
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "FILTER_EVENT", &msg, sizeof(msg.kind)));
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&filter_hits));
+
+    // An unfiltered subscriber on the same topic still sees everything
+    bus_sub_opts_t direct = { .direct = 1 };
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(plugin, "FILTER_EVENT", filter_callback, &filter_all_hits, &direct));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "FILTER_EVENT", &msg, sizeof(msg)));
+    msg.flags = 0x40;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "FILTER_EVENT", &msg, sizeof(msg)));
+    TEST_ASSERT_EQUAL_INT(2, atomic_load(&filter_hits));
+    TEST_ASSERT_EQUAL_INT(2, atomic_load(&filter_all_hits));
+
+    // NE on a single byte
+    const bus_filter_clause_t ne = { .offset = 0, .width = 1, .cmp = BUS_FILTER_NE, .value = 7 };
+    bus_sub_opts_t ne_opts = { .direct = 1, .filter = &ne, .filter_len = 1 };
+    atomic_store(&filter_hits, 0);
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(plugin, "FILTER_NE", filter_callback, &filter_hits, &ne_opts));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "FILTER_NE", &msg, sizeof(msg)));
+    msg.kind = 9;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "FILTER_NE", &msg, sizeof(msg)));
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&filter_hits));
+
+    const bus_filter_clause_t bad = { .offset = 0, .width = 3, .cmp = BUS_FILTER_EQ };
+    bus_sub_opts_t bad_opts = { .filter = &bad, .filter_len = 1 };
+    TEST_ASSERT_EQUAL_INT(BUS_SUB_ERR_INVALID_FILTER, bus_subscribe_ex(plugin, "FILTER_BAD", filter_callback, &filter_hits, &bad_opts));
+
+    TEST_ASSERT_EQUAL_INT(0, bus_unsubscribe(plugin, "FILTER_EVENT", filter_callback, &filter_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_unsubscribe(plugin, "FILTER_EVENT", filter_callback, &filter_all_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_unsubscribe(plugin, "FILTER_NE", filter_callback, &filter_hits));
+}
+
+static atomic_int quota_hits = 0;
+
+static void *quota_core_thread(void *arg) {
+    int *ret = arg;
+    int val = 1;
+
+    bus_mark_core_thread();
+    for (int i = 0; i < 3 && *ret == 0; i++) {
+        *ret = bus_publish(77, "QUOTA_EVENT", &val, sizeof(val));
+    }
+    return NULL;
+}
+
+void test_bus_publish_quota(void) {
+    const plugin_id_t noisy = 77;
+    int val = 1;
+
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(noisy, "QUOTA_EVENT", unsub_callback, &quota_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(noisy, "QUOTA_OTHER", unsub_callback, &quota_hits));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "QUOTA_EVENT", unsub_callback, &quota_hits));
+
+    // Burst of 2 then one per second
+    bus_quota_t reject = { .rate = 1, .burst = 2, .action = BUS_QUOTA_REJECT };
+    TEST_ASSERT_EQUAL_INT(0, bus_set_quota(noisy, NULL, &reject));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(noisy, "QUOTA_EVENT", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(noisy, "QUOTA_OTHER", &val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_RATE_LIMITED, bus_publish(noisy, "QUOTA_EVENT", &val, sizeof(val)));
+
+    const bus_msg_t msgs[] = {
+        { .event = "QUOTA_EVENT", .data = &val, .len = sizeof(val) },
+    };
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_RATE_LIMITED, bus_publish_batch(noisy, msgs, 1));
+
+    // Other plugins are not affected
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "QUOTA_EVENT", &val, sizeof(val)));
+    TEST_ASSERT_TRUE(test_wait_for_int(&quota_hits, 3, 1000));
+
+    // Drop succeeds without delivering
+    bus_quota_t drop = { .rate = 1, .burst = 1, .action = BUS_QUOTA_DROP };
+    TEST_ASSERT_EQUAL_INT(0, bus_set_quota(noisy, NULL, &drop));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(noisy, "QUOTA_EVENT", &val, sizeof(val)));
+
+    bus_quota_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, bus_get_quota_stats(noisy, &stats));
+    TEST_ASSERT_EQUAL_UINT64(2, stats.rejected);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.dropped);
+
+    // A topic quota applies on top of the lifted plugin-wide one
+    bus_quota_t unlimited = { 0 };
+    bus_quota_t delay = { .rate = 50, .burst = 1, .action = BUS_QUOTA_DELAY, .max_delay_ms = 200 };
+    TEST_ASSERT_EQUAL_INT(0, bus_set_quota(noisy, NULL, &unlimited));
+    TEST_ASSERT_EQUAL_INT(0, bus_set_quota(noisy, "QUOTA_EVENT", &delay));
+
+    const uint64_t start = bus_now_ns();
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_publish(noisy, "QUOTA_EVENT", &val, sizeof(val)));
+    }
+    TEST_ASSERT_TRUE(bus_now_ns() - start >= 30000000ULL);
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(noisy, "QUOTA_OTHER", &val, sizeof(val)));
+    TEST_ASSERT_TRUE(test_wait_for_int(&quota_hits, 7, 1000));
+
+    TEST_ASSERT_EQUAL_INT(0, bus_get_quota_stats(noisy, &stats));
+    TEST_ASSERT_TRUE(stats.delayed >= 2);
+
+    // Scheduler threads and other core callback threads reject instead of sleeping
+    pthread_t core;
+    int core_ret = 0;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&core, NULL, quota_core_thread, &core_ret));
+    pthread_join(core, NULL);
+    TEST_ASSERT_EQUAL_INT(BUS_PUBLISH_ERR_RATE_LIMITED, core_ret);
+    TEST_ASSERT_EQUAL_INT(-1, bus_get_quota_stats(plugin, &stats));
+
+    bus_quota_t bad = { .rate = 1, .action = 9 };
+    TEST_ASSERT_EQUAL_INT(-1, bus_set_quota(noisy, NULL, &bad));
+}
+
+static atomic_int crash_hits = 0;
+
+static void crash_callback(const void *data, size_t len, void *user) {
+    (void)len;
+    (void)user;
+    atomic_fetch_add(&crash_hits, 1);
+    if (*(const int *)data == 0) *(volatile int *)NULL = 1;
+}
+
+void test_bus_callback_crash(void) {
+    crash_recovery_init();
+
+    bus_sub_opts_t direct = { .direct = 1 };
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe(plugin, "CRASH_QUEUED", crash_callback, NULL));
+    TEST_ASSERT_EQUAL_INT(0, bus_subscribe_ex(plugin, "CRASH_DIRECT", crash_callback, NULL, &direct));
+
+    // Crashing twice on the same thread proves the handler unblocked the signal again
+    int crash = 0;
+    int ok = 1;
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "CRASH_DIRECT", &crash, sizeof(crash)));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "CRASH_DIRECT", &crash, sizeof(crash)));
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "CRASH_DIRECT", &ok, sizeof(ok)));
+    TEST_ASSERT_EQUAL_INT(3, atomic_load(&crash_hits));
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "CRASH_QUEUED", &crash, sizeof(crash)));
+    }
+    TEST_ASSERT_EQUAL_INT(0, bus_publish(plugin, "CRASH_QUEUED", &ok, sizeof(ok)));
+    TEST_ASSERT_TRUE(test_wait_for_int(&crash_hits, 8, 1000));
+}
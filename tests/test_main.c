@@ -11,13 +11,40 @@ void test_hk_field_exists(void);
 
 void test_bus_init(void);
 void test_bus_subscribe_and_publish(void);
+void test_bus_publish_delivered(void);
 void test_event_bus_get_list(void);
+void test_bus_queue_backends(void);
+void test_bus_topic_intern(void);
+void test_bus_publish_id(void);
+void test_bus_publish_fanout(void);
+void test_bus_publish_loaned(void);
+void test_bus_publish_batch(void);
+void test_bus_slab_alloc_free(void);
+void test_bus_pool_concurrent_publish(void);
+void test_bus_priority_lanes(void);
+void test_bus_backpressure_policies(void);
+void test_bus_ordered_delivery(void);
+void test_bus_wildcard_topics(void);
+void test_bus_inline_delivery(void);
+void test_bus_latency_stats(void);
+void test_bus_conflated_topics(void);
+void test_bus_journal_replay(void);
+void test_bus_shm_transport(void);
+void test_bus_unsubscribe(void);
+void test_bus_publish_filters(void);
+void test_bus_publish_quota(void);
+void test_bus_callback_crash(void);
 
 void test_scheduler_init(void);
 void test_scheduler_every_ms(void);
 void test_scheduler_after_ms(void);
 void test_scheduler_cancel(void);
 void test_scheduler_get_list(void);
+void test_scheduler_queue_backends(void);
+void test_scheduler_cancel_in_flight(void);
+void test_scheduler_fine_grained(void);
+void test_scheduler_worker_pool(void);
+void test_scheduler_periodic_phase_locked(void);
 
 int main(void) {
     UNITY_BEGIN();
@@ -35,7 +62,29 @@ int main(void) {
     // Event bus
     RUN_TEST(test_bus_init);
     RUN_TEST(test_bus_subscribe_and_publish);
+    RUN_TEST(test_bus_publish_delivered);
     RUN_TEST(test_event_bus_get_list);
+    RUN_TEST(test_bus_queue_backends);
+    RUN_TEST(test_bus_topic_intern);
+    RUN_TEST(test_bus_publish_id);
+    RUN_TEST(test_bus_publish_fanout);
+    RUN_TEST(test_bus_publish_loaned);
+    RUN_TEST(test_bus_publish_batch);
+    RUN_TEST(test_bus_slab_alloc_free);
+    RUN_TEST(test_bus_pool_concurrent_publish);
+    RUN_TEST(test_bus_priority_lanes);
+    RUN_TEST(test_bus_backpressure_policies);
+    RUN_TEST(test_bus_ordered_delivery);
+    RUN_TEST(test_bus_wildcard_topics);
+    RUN_TEST(test_bus_inline_delivery);
+    RUN_TEST(test_bus_latency_stats);
+    RUN_TEST(test_bus_conflated_topics);
+    RUN_TEST(test_bus_journal_replay);
+    RUN_TEST(test_bus_shm_transport);
+    RUN_TEST(test_bus_unsubscribe);
+    RUN_TEST(test_bus_publish_filters);
+    RUN_TEST(test_bus_publish_quota);
+    RUN_TEST(test_bus_callback_crash);
 
     // Scheduler
     RUN_TEST(test_scheduler_init);
@@ -43,6 +92,11 @@ int main(void) {
     RUN_TEST(test_scheduler_after_ms);
     RUN_TEST(test_scheduler_cancel);
     RUN_TEST(test_scheduler_get_list);
+    RUN_TEST(test_scheduler_queue_backends);
+    RUN_TEST(test_scheduler_cancel_in_flight);
+    RUN_TEST(test_scheduler_fine_grained);
+    RUN_TEST(test_scheduler_worker_pool);
+    RUN_TEST(test_scheduler_periodic_phase_locked);
 
     return UNITY_END();
 }
@@ -1,6 +1,12 @@
 #include "unity.h"
 #include "scheduler.h"
+#include "scheduler_queue.h"
+#include "test_helpers.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 static plugin_id_t plugin = 1;
 static int cb_called = 0;
@@ -41,3 +47,255 @@ void test_scheduler_get_list(void) {
     int res = scheduler_get_list(buf, sizeof(buf));
     TEST_ASSERT_EQUAL_INT(0, res);
 }
+
+static uint64_t queue_rand(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Both backends hand timers out in deadline order, across cascades and removals
+static void check_queue_backend(scheduler_backend_t backend) {
+    enum { TIMERS = 2000 };
+    const uint64_t start = 1000000000ULL;
+    sched_queue_t q;
+    scheduler_timer_t *timers[TIMERS];
+    uint64_t state = 88172645463325252ULL;
+
+    TEST_ASSERT_EQUAL_INT(0, sched_queue_init(&q, backend, start));
+
+    for (int i = 0; i < TIMERS; i++) {
+        timers[i] = calloc(1, sizeof(scheduler_timer_t));
+        TEST_ASSERT_NOT_NULL(timers[i]);
+        timers[i]->id = i;
+        // Spread from sub-tick to beyond the top wheel level
+        const unsigned int span = (unsigned int)(queue_rand(&state) % 52);
+        timers[i]->due_ns = start + queue_rand(&state) % (1ULL << span);
+        TEST_ASSERT_EQUAL_INT(0, sched_queue_insert(&q, timers[i]));
+    }
+
+    int removed = 0;
+    for (int i = 0; i < TIMERS; i += 3) {
+        sched_queue_remove(&q, timers[i]);
+        free(timers[i]);
+        removed++;
+    }
+    TEST_ASSERT_EQUAL_size_t(TIMERS - removed, q.count);
+
+    uint64_t now = start;
+    uint64_t last_due = 0;
+    int popped = 0;
+    while (q.count) {
+        const uint64_t due = sched_queue_next_due(&q);
+        TEST_ASSERT_TRUE(due != UINT64_MAX);
+        // Sometimes late, several ticks come due at once
+        if (due > now) now = due + queue_rand(&state) % 1000000ULL;
+
+        scheduler_timer_t *t;
+        while ((t = sched_queue_pop(&q, now)) != NULL) {
+            TEST_ASSERT_TRUE(t->due_ns <= now);
+            TEST_ASSERT_TRUE(t->due_ns >= last_due || t->due_ns >> SCHED_WHEEL_TICK_SHIFT == last_due >> SCHED_WHEEL_TICK_SHIFT);
+            last_due = t->due_ns;
+            popped++;
+            free(t);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(TIMERS - removed, popped);
+    TEST_ASSERT_TRUE(sched_queue_next_due(&q) == UINT64_MAX);
+
+    sched_queue_destroy(&q);
+}
+
+void test_scheduler_queue_backends(void) {
+    check_queue_backend(SCHEDULER_BACKEND_WHEEL);
+    check_queue_backend(SCHEDULER_BACKEND_HEAP);
+}
+
+static atomic_int self_cancel_runs = 0;
+static atomic_int self_cancel_id = 0;
+
+static void test_sched_self_cancel_cb(const void *data, size_t len, void *user) {
+    (void)data; (void)len; (void)user;
+    atomic_fetch_add(&self_cancel_runs, 1);
+    // The timer is in flight here, the cancel must still stick
+    scheduler_cancel(plugin, atomic_load(&self_cancel_id));
+}
+
+void test_scheduler_cancel_in_flight(void) {
+    int id = scheduler_every_ms(plugin, 1, test_sched_self_cancel_cb, NULL);
+    TEST_ASSERT(id > 0);
+    atomic_store(&self_cancel_id, id);
+
+    // A 1 ms period would have run again meanwhile if the cancel had not stuck
+    TEST_ASSERT_TRUE(test_wait_for_int(&self_cancel_runs, 1, 1000));
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = 10000000L };
+    nanosleep(&ts, NULL);
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&self_cancel_runs));
+
+    // Stale ids miss on the generation, also once their slot is reused
+    TEST_ASSERT_EQUAL_INT(-1, scheduler_cancel(plugin, id));
+    int next = scheduler_after_ms(plugin, 1000, test_sched_cb, NULL);
+    TEST_ASSERT(next > 0);
+    TEST_ASSERT_EQUAL_INT(-1, scheduler_cancel(plugin, id));
+    TEST_ASSERT_EQUAL_INT(-1, scheduler_cancel(plugin + 1, next));
+    TEST_ASSERT_EQUAL_INT(0, scheduler_cancel(plugin, next));
+}
+
+static atomic_int fine_after_runs = 0;
+static atomic_int fine_every_runs = 0;
+
+static void test_sched_fine_after_cb(const void *data, size_t len, void *user) {
+    (void)data; (void)len; (void)user;
+    atomic_fetch_add(&fine_after_runs, 1);
+}
+
+static void test_sched_fine_every_cb(const void *data, size_t len, void *user) {
+    (void)data; (void)len; (void)user;
+    atomic_fetch_add(&fine_every_runs, 1);
+}
+
+void test_scheduler_fine_grained(void) {
+    TEST_ASSERT_EQUAL_INT(-1, scheduler_every_ns(plugin, 0, test_sched_fine_every_cb, NULL));
+
+    // Far deadlines saturate instead of wrapping around into the past
+    int far_ms = scheduler_after_ms(plugin, UINT64_MAX, test_sched_fine_after_cb, NULL);
+    int far_ns = scheduler_timer_ex(plugin, UINT64_MAX, UINT64_MAX, test_sched_fine_after_cb, NULL, NULL);
+    TEST_ASSERT(far_ms > 0);
+    TEST_ASSERT(far_ns > 0);
+
+    int after = scheduler_after_us(plugin, 300, test_sched_fine_after_cb, NULL);
+    int every = scheduler_every_ns(plugin, 500000, test_sched_fine_every_cb, NULL);
+    TEST_ASSERT(after > 0);
+    TEST_ASSERT(every > 0);
+
+    // Well below the old 1 ms granularity, a 500 us period keeps firing
+    TEST_ASSERT_TRUE(test_wait_for_int(&fine_after_runs, 1, 1000));
+    TEST_ASSERT_TRUE(test_wait_for_at_least(&fine_every_runs, 5, 1000));
+    TEST_ASSERT_EQUAL_INT(0, scheduler_cancel(plugin, every));
+    TEST_ASSERT_EQUAL_INT(0, scheduler_cancel(plugin, far_ms));
+    TEST_ASSERT_EQUAL_INT(0, scheduler_cancel(plugin, far_ns));
+
+    // Neither far deadline wrapped into the past
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&fine_after_runs));
+}
+
+static atomic_int slow_active = 0;
+static atomic_int slow_overlapped = 0;
+static atomic_int slow_runs = 0;
+static atomic_int fast_runs = 0;
+static atomic_int inline_runs = 0;
+static pthread_t inline_thread;
+static pthread_t fast_thread;
+
+static void test_sched_slow_cb(const void *data, size_t len, void *user) {
+    (void)data; (void)len; (void)user;
+    if (atomic_fetch_add(&slow_active, 1) != 0) atomic_store(&slow_overlapped, 1);
+    atomic_fetch_add(&slow_runs, 1);
+
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = 15000000L };
+    nanosleep(&ts, NULL);
+    atomic_fetch_sub(&slow_active, 1);
+}
+
+static void test_sched_fast_cb(const void *data, size_t len, void *user) {
+    (void)data; (void)len; (void)user;
+    fast_thread = pthread_self();
+    atomic_fetch_add(&fast_runs, 1);
+}
+
+static void test_sched_inline_cb(const void *data, size_t len, void *user) {
+    (void)data; (void)len; (void)user;
+    inline_thread = pthread_self();
+    atomic_fetch_add(&inline_runs, 1);
+}
+
+void test_scheduler_worker_pool(void) {
+    // Period far below the callback's run time: it must queue up behind itself, never overlap
+    int slow = scheduler_every_ns(plugin, 1000000, test_sched_slow_cb, NULL);
+    TEST_ASSERT(slow > 0);
+    TEST_ASSERT_TRUE(test_wait_for_int(&slow_active, 1, 1000));
+
+    // The slow callback is busy on one worker, these still fire
+    int fast = scheduler_after_us(plugin, 1000, test_sched_fast_cb, NULL);
+    const sched_timer_opts_t opts = { .run_inline = 1 };
+    int inl = scheduler_timer_ex(plugin, 1000000, 0, test_sched_inline_cb, NULL, &opts);
+    TEST_ASSERT(fast > 0);
+    TEST_ASSERT(inl > 0);
+
+    TEST_ASSERT_TRUE(test_wait_for_int(&fast_runs, 1, 1000));
+    TEST_ASSERT_TRUE(test_wait_for_int(&inline_runs, 1, 1000));
+    TEST_ASSERT_FALSE(pthread_equal(inline_thread, fast_thread));
+
+    TEST_ASSERT_TRUE(test_wait_for_at_least(&slow_runs, 3, 1000));
+    TEST_ASSERT_EQUAL_INT(0, scheduler_cancel(plugin, slow));
+    TEST_ASSERT_EQUAL_INT(0, atomic_load(&slow_overlapped));
+
+    // Let an in-flight run finish before the next test
+    TEST_ASSERT_TRUE(test_wait_for_int(&slow_active, 0, 1000));
+}
+
+static _Atomic uint64_t coalesced_missed = 0;
+static atomic_int overrun_runs = 0;
+
+static void test_sched_sleep_ns(long ns) {
+    struct timespec ts = { .tv_sec = ns / 1000000000L, .tv_nsec = ns % 1000000000L };
+    nanosleep(&ts, NULL);
+}
+
+static void test_sched_phase_cb(const void *data, size_t len, void *user) {
+    (void)data; (void)len; (void)user;
+    // Half the period, re-arming from the callback's end would stretch every period by it
+    test_sched_sleep_ns(1000000L);
+}
+
+static void test_sched_overrun_cb(const void *data, size_t len, void *user) {
+    (void)user;
+    if (data && len == sizeof(uint64_t)) atomic_fetch_add(&coalesced_missed, *(const uint64_t *)data);
+    test_sched_sleep_ns(7000000L);
+    atomic_fetch_add(&overrun_runs, 1);
+}
+
+void test_scheduler_periodic_phase_locked(void) {
+    int id = scheduler_every_ns(plugin, 2000000, test_sched_phase_cb, NULL);
+    TEST_ASSERT(id > 0);
+
+    test_sched_sleep_ns(60000000L);
+
+    // Every period is accounted for, run or skipped under load; drifting by 1 ms per run would cover ~20
+    scheduler_timer_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, scheduler_get_timer_stats(plugin, id, &stats));
+    TEST_ASSERT_EQUAL_INT(0, scheduler_cancel(plugin, id));
+    TEST_ASSERT(stats.runs + stats.overruns >= 27);
+
+    // A 7 ms callback on a 2 ms period overruns under every policy
+    const sched_overrun_t policies[] = { SCHED_OVERRUN_SKIP, SCHED_OVERRUN_FIRE_ALL, SCHED_OVERRUN_COALESCE };
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        const sched_timer_opts_t opts = { .overrun = policies[i] };
+        atomic_store(&coalesced_missed, 0);
+        atomic_store(&overrun_runs, 0);
+
+        id = scheduler_timer_ex(plugin, 2000000, 2000000, test_sched_overrun_cb, NULL, &opts);
+        TEST_ASSERT(id > 0);
+        TEST_ASSERT_TRUE(test_wait_for_at_least(&overrun_runs, 4, 1000));
+
+        TEST_ASSERT_EQUAL_INT(0, scheduler_get_timer_stats(plugin, id, &stats));
+        TEST_ASSERT_EQUAL_INT(0, scheduler_cancel(plugin, id));
+        TEST_ASSERT_EQUAL_INT(-1, scheduler_get_timer_stats(plugin, id, &stats));
+
+        TEST_ASSERT(stats.runs >= 3);
+        TEST_ASSERT(stats.overruns > 0);
+        TEST_ASSERT(stats.lateness_max_ns >= stats.lateness_avg_ns);
+        if (policies[i] == SCHED_OVERRUN_COALESCE) {
+            TEST_ASSERT(atomic_load(&coalesced_missed) > 0);
+        } else {
+            TEST_ASSERT_EQUAL_UINT64(0, atomic_load(&coalesced_missed));
+        }
+        if (policies[i] == SCHED_OVERRUN_FIRE_ALL) {
+            // Catching up runs late, a skipped or folded schedule starts within a period
+            TEST_ASSERT(stats.lateness_max_ns > 2000000ULL);
+        }
+
+        test_sched_sleep_ns(10000000L);
+    }
+}